@@ -26,7 +26,7 @@ void loop() {
     Rect(circleX, 10, 20, 20).drawFrame(Palette::Black);
 
     
-    Circle(50, 50, 30).draw(Color::FromHSV(circleX, 1.0, 1.0));
+    Circle(50, 50, 30).draw(HueWheel::Default()[circleX]);
     Circle(50, 50, 30).drawFrame(Palette::Black);
 
     font.draw("日本語を描画したい!", 21, 101, Palette::Black);
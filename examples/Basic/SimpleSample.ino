@@ -17,6 +17,7 @@ Circle circle(160, 120, 30);
 Rect rect(50, 50, 80, 40);
 Font font;
 float hue = 0;
+const HueWheel rainbow(204); // 彩度 0.8 の色相環
 
 void Main()
 {
@@ -34,7 +35,7 @@ void Main()
 
         // 円を描画（虹色に変化）
         hue = Math::fmod(hue + 1.0f, 360.0f);
-        circle.draw(Color::FromHSV(hue, 0.8f, 1.0f));
+        circle.draw(rainbow.at(hue));
 
         // 四角形を描画（ボタンAが押されたら色が変わる）
         rect.draw(Input::ButtonA.pressed() ? Palette::Red : Palette::Blue);
@@ -24,9 +24,7 @@
 //
 //////////////////////////////////////////////////
 
-#include <M5Unified.h>
-#include <base64.hpp>
-#include <SPI.h>
+#include "M5Siv3D/Platform.h"
 #include <sstream>
 
 //////////////////////////////////////////////////
@@ -58,6 +56,8 @@
 #include "M5Siv3D/Shapes.h"
 #include "M5Siv3D/Font.h"
 #include "M5Siv3D/Image.h"
+#include "M5Siv3D/TextureAtlas.h"
+#include "M5Siv3D/Layer.h"
 
 //////////////////////////////////////////////////
 //
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Platform.h"
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+
+// base64 文字列を少しずつデコードしながら読み出すデータ供給源 (drawPng などのストリームデコーダに渡す)
+//
+// デコード結果は WindowSize バイトの窓にだけ置き、読み進めると次の区間を文字列からデコードし直す。
+// デコード後の全体を保持するバッファを確保しないので、必要なメモリは文字列とこのオブジェクトだけで済む。
+// 文字列は 4 文字で 3 バイトになるので、任意の位置へのシークも窓の先頭に対応する文字から再開するだけでよい。
+//
+//   Base64Stream stream(base64Text);
+//   canvas.drawPng(&stream, 0, 0);
+class Base64Stream : public lgfx::DataWrapper
+{
+public:
+    // 3 の倍数 (窓の境界を 4 文字の区切りに揃える)
+    static constexpr uint32_t WindowSize = 192;
+
+    // text は読み出しが終わるまで保持されている必要がある
+    // base64 で使わない文字 ('=' や終端) までをデータとみなす
+    explicit Base64Stream(const char *text)
+        : m_text(text)
+    {
+        uint32_t length = 0;
+        while (text && Value(text[length]) >= 0)
+        {
+            ++length;
+        }
+        m_size = (length / 4) * 3 + ((length % 4) ? (length % 4) - 1 : 0);
+    }
+
+    // デコード後のバイト数
+    uint32_t size() const { return m_size; }
+
+    int read(uint8_t *buf, uint32_t len) override
+    {
+        uint32_t copied = 0;
+        while (copied < len && m_position < m_size)
+        {
+            if (m_position < m_windowStart || m_windowStart + m_windowLength <= m_position)
+            {
+                fill(m_position - m_position % WindowSize);
+            }
+            const uint32_t offset = m_position - m_windowStart;
+            const uint32_t count = std::min(len - copied, m_windowLength - offset);
+            memcpy(buf + copied, m_window + offset, count);
+            copied += count;
+            m_position += count;
+        }
+        return int(copied);
+    }
+
+    void skip(int32_t offset) override
+    {
+        const int64_t position = int64_t(m_position) + offset;
+        seek(uint32_t(std::max<int64_t>(0, position)));
+    }
+
+    bool seek(uint32_t offset) override
+    {
+        m_position = std::min(offset, m_size);
+        return offset <= m_size;
+    }
+
+    void close() override {}
+
+    int32_t tell() override { return int32_t(m_position); }
+
+private:
+    const char *m_text;
+    uint32_t m_size = 0;
+    uint32_t m_position = 0;
+    uint32_t m_windowStart = 0;
+    uint32_t m_windowLength = 0;
+    uint8_t m_window[WindowSize];
+
+    static int Value(char c)
+    {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+' || c == '-') return 62;
+        if (c == '/' || c == '_') return 63;
+        return -1;
+    }
+
+    // start (WindowSize の倍数) からの区間を窓にデコードする
+    void fill(uint32_t start)
+    {
+        const uint32_t end = std::min(start + WindowSize, m_size);
+        const char *p = m_text + (start / 3) * 4;
+        uint32_t written = 0;
+        uint32_t buffer = 0;
+        int bits = 0;
+        while (written < end - start)
+        {
+            buffer = (buffer << 6) | uint32_t(Value(*p++));
+            bits += 6;
+            if (bits >= 8)
+            {
+                bits -= 8;
+                m_window[written++] = uint8_t(buffer >> bits);
+            }
+        }
+        m_windowStart = start;
+        m_windowLength = written;
+    }
+};
@@ -0,0 +1,339 @@
+#pragma once
+
+#include "Platform.h"
+#include "Color.h"
+#include "DirtyRegion.h"
+#include <stdint.h>
+#include <algorithm>
+
+// 合成方法
+enum class BlendMode : uint8_t
+{
+    Alpha,    // 不透明度に応じて重ねる
+    Additive, // 加算 (明るくなる)
+    Multiply, // 乗算 (暗くなる)
+};
+
+// RGB565 の画素の合成と、行ごとの区間での図形の塗りつぶし
+//
+// 描画先の画素を 1 行ずつ読み出して合成し、書き戻す。
+// 合成する画素は 1 回だけ処理するので、図形の内側を行ごとの区間に分けて塗る。
+//
+// FillRect などは区間の画素を Painter に渡して塗らせる。Painter は次を持つ型
+//   bool readsTarget() const  // 描画先の画素を読み出してから paint に渡すかどうか
+//   void paint(lgfx::swap565_t *pixels, int32_t x, int32_t y, int32_t count) const  // (x, y) から count 画素
+namespace Blend
+{
+    // 1 度に読み書きする画素数
+    constexpr int32_t ChunkPixels = 64;
+
+    // 8 ビットの不透明度を 0-32 に変換する
+    inline uint32_t ToAlpha32(uint8_t alpha)
+    {
+        return (uint32_t(alpha) * 32 + 127) / 255;
+    }
+
+    // 合成せずに塗りつぶしと同じ結果になる場合
+    inline bool IsOpaque(uint8_t alpha, BlendMode mode)
+    {
+        return mode == BlendMode::Alpha && alpha == 255;
+    }
+
+    // 描画しても画素が変化しない場合
+    inline bool IsInvisible(uint8_t alpha)
+    {
+        return ToAlpha32(alpha) == 0;
+    }
+
+    // RGB565 を 32 ビットに広げる
+    // G を上位 16 ビットに移し、各成分の上に桁あふれ用の隙間を作る (----GGGGGG-----RRRRR------BBBBB)
+    // 3 成分に同じ値を掛けたり足したりする計算を 1 回の演算で行える
+    constexpr uint32_t SpreadMask = 0x07E0F81Fu;
+
+    inline uint32_t Spread(uint16_t color)
+    {
+        return (color | (uint32_t(color) << 16)) & SpreadMask;
+    }
+
+    inline uint16_t Pack(uint32_t spread)
+    {
+        spread &= SpreadMask;
+        return uint16_t(spread | (spread >> 16));
+    }
+
+    inline uint16_t Swap(uint16_t value)
+    {
+        return uint16_t((value >> 8) | (value << 8));
+    }
+
+    // 1 回の描画で使う合成のパラメータ
+    class Blender
+    {
+    public:
+        Blender(uint16_t color, uint8_t alpha, BlendMode mode)
+            : m_mode(mode), m_alpha(ToAlpha32(alpha)), m_color(color)
+        {
+            const uint32_t spread = Spread(color);
+            m_alphaTerm = spread * m_alpha;
+            m_additiveTerm = ((spread * m_alpha) >> 5) & SpreadMask;
+            m_red = (color >> 11) + 1;
+            m_green = ((color >> 5) & 0x3F) + 1;
+            m_blue = (color & 0x1F) + 1;
+        }
+
+        // 描画しても変化しない場合
+        bool isNoop() const { return m_alpha == 0; }
+
+        bool readsTarget() const { return true; }
+
+        void paint(lgfx::swap565_t *pixels, int32_t, int32_t, int32_t count) const
+        {
+            apply(pixels, count);
+        }
+
+        // dst の 1 画素に合成する (alpha は 0-32 で、描画の不透明度にさらに掛ける)
+        uint16_t blend(uint16_t dst, uint32_t alpha) const
+        {
+            alpha = (alpha * m_alpha + 16) >> 5;
+            if (m_mode == BlendMode::Alpha)
+            {
+                return lerp(dst, Spread(m_color) * alpha, alpha);
+            }
+            if (m_mode == BlendMode::Additive)
+            {
+                return add(dst, ((Spread(m_color) * alpha) >> 5) & SpreadMask);
+            }
+            return lerp(dst, Spread(multiply(dst)) * alpha, alpha);
+        }
+
+        // キャンバスと同じバイト順の画素の並びに合成する
+        // 広げた形式で 3 成分をまとめて計算し、色と不透明度の積は m_alphaTerm として 1 度だけ求めておく
+        void apply(lgfx::swap565_t *pixels, int32_t count) const
+        {
+            switch (m_mode)
+            {
+            case BlendMode::Alpha:
+                for (int32_t i = 0; i < count; ++i)
+                {
+                    pixels[i].raw = Swap(lerp(Swap(pixels[i].raw), m_alphaTerm, m_alpha));
+                }
+                break;
+            case BlendMode::Additive:
+                for (int32_t i = 0; i < count; ++i)
+                {
+                    pixels[i].raw = Swap(add(Swap(pixels[i].raw), m_additiveTerm));
+                }
+                break;
+            case BlendMode::Multiply:
+                for (int32_t i = 0; i < count; ++i)
+                {
+                    const uint16_t dst = Swap(pixels[i].raw);
+                    const uint16_t product = multiply(dst);
+                    pixels[i].raw = Swap(m_alpha == 32 ? product : lerp(dst, Spread(product) * m_alpha, m_alpha));
+                }
+                break;
+            }
+        }
+
+    private:
+        BlendMode m_mode;
+        uint32_t m_alpha; // 0-32
+        uint16_t m_color;
+        uint32_t m_alphaTerm;    // 広げた色 × 不透明度
+        uint32_t m_additiveTerm; // 広げた色 × 不透明度 / 32
+        uint32_t m_red;          // 乗算用の各成分 + 1
+        uint32_t m_green;
+        uint32_t m_blue;
+
+        // (src × alpha + dst × (32 - alpha)) / 32
+        static uint16_t lerp(uint16_t dst, uint32_t srcTerm, uint32_t alpha)
+        {
+            return Pack((srcTerm + Spread(dst) * (32 - alpha)) >> 5);
+        }
+
+        // 成分ごとに足し、桁あふれした成分は最大値にする
+        static uint16_t add(uint16_t dst, uint32_t srcSpread)
+        {
+            uint32_t sum = Spread(dst) + srcSpread;
+            const uint32_t blueOver = sum & (1u << 5);
+            const uint32_t redOver = sum & (1u << 16);
+            const uint32_t greenOver = sum & (1u << 27);
+            sum |= (blueOver - (blueOver >> 5)) | (redOver - (redOver >> 5)) | (greenOver - (greenOver >> 6));
+            return Pack(sum);
+        }
+
+        uint16_t multiply(uint16_t dst) const
+        {
+            const uint32_t r = ((dst >> 11) * m_red) >> 5;
+            const uint32_t g = (((dst >> 5) & 0x3F) * m_green) >> 6;
+            const uint32_t b = ((dst & 0x1F) * m_blue) >> 5;
+            return uint16_t((r << 11) | (g << 5) | b);
+        }
+    };
+
+    // 描画先のクリップ領域 (描画先の範囲内)
+    inline DirtyRect ClipArea(lgfx::LovyanGFX &target)
+    {
+        int32_t x, y, w, h;
+        target.getClipRect(&x, &y, &w, &h);
+        return DirtyRect(x, y, w, h).intersected(DirtyRect(0, 0, target.width(), target.height()));
+    }
+
+    // y 行目の [left, right] (両端を含む) を塗る
+    template <class Painter>
+    inline void Span(lgfx::LovyanGFX &target, const DirtyRect &clip, int32_t left, int32_t right, int32_t y, const Painter &painter)
+    {
+        if (y < clip.y || y >= clip.y + clip.h)
+        {
+            return;
+        }
+        left = std::max(left, clip.x);
+        right = std::min(right, clip.x + clip.w - 1);
+
+        lgfx::swap565_t buffer[ChunkPixels];
+        for (int32_t x = left; x <= right; x += ChunkPixels)
+        {
+            const int32_t count = std::min(ChunkPixels, right - x + 1);
+            if (painter.readsTarget())
+            {
+                target.readRect(x, y, count, 1, buffer);
+            }
+            painter.paint(buffer, x, y, count);
+            target.pushImage(x, y, count, 1, buffer);
+        }
+    }
+
+    template <class Painter>
+    inline void FillRect(lgfx::LovyanGFX &target, int32_t x, int32_t y, int32_t w, int32_t h, const Painter &painter)
+    {
+        const DirtyRect clip = ClipArea(target);
+        const int32_t top = std::max(y, clip.y);
+        const int32_t bottom = std::min(y + h, clip.y + clip.h);
+        for (int32_t row = top; row < bottom; ++row)
+        {
+            Span(target, clip, x, x + w - 1, row, painter);
+        }
+    }
+
+    // x² + y² <= r² + r の画素を塗る (fillCircle とほぼ同じ形)
+    template <class Painter>
+    inline void FillCircle(lgfx::LovyanGFX &target, int32_t cx, int32_t cy, int32_t r, const Painter &painter)
+    {
+        if (r < 0)
+        {
+            return;
+        }
+        const DirtyRect clip = ClipArea(target);
+        const int32_t limit = r * r + r;
+        int32_t half = r;
+        for (int32_t dy = 0; dy <= r; ++dy)
+        {
+            // 行が中心から離れるほど幅は狭くなるので、前の行の幅から減らしていく
+            while (half > 0 && half * half + dy * dy > limit)
+            {
+                --half;
+            }
+            Span(target, clip, cx - half, cx + half, cy + dy, painter);
+            if (dy)
+            {
+                Span(target, clip, cx - half, cx + half, cy - dy, painter);
+            }
+        }
+    }
+
+    // 頂点を y で並べ替え、長い辺と短い辺の間を行ごとに塗る (fillTriangle と同じ手順)
+    template <class Painter>
+    inline void FillTriangle(lgfx::LovyanGFX &target, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2,
+                             const Painter &painter)
+    {
+        if (y0 > y1)
+        {
+            std::swap(y0, y1);
+            std::swap(x0, x1);
+        }
+        if (y1 > y2)
+        {
+            std::swap(y2, y1);
+            std::swap(x2, x1);
+        }
+        if (y0 > y1)
+        {
+            std::swap(y0, y1);
+            std::swap(x0, x1);
+        }
+
+        const DirtyRect clip = ClipArea(target);
+        if (y0 == y2)
+        {
+            const int32_t left = std::min(x0, std::min(x1, x2));
+            const int32_t right = std::max(x0, std::max(x1, x2));
+            Span(target, clip, left, right, y0, painter);
+            return;
+        }
+
+        const int32_t dx01 = x1 - x0, dy01 = y1 - y0;
+        const int32_t dx02 = x2 - x0, dy02 = y2 - y0;
+        const int32_t dx12 = x2 - x1, dy12 = y2 - y1;
+        int32_t sa = 0;
+        int32_t sb = 0;
+
+        // 上半分 (y1 の行は、上下の辺が平らでなければ下半分で塗る)
+        const int32_t last = (y1 == y2) ? y1 : y1 - 1;
+        int32_t y = y0;
+        for (; y <= last; ++y)
+        {
+            const int32_t a = x0 + sa / dy01;
+            const int32_t b = x0 + sb / dy02;
+            sa += dx01;
+            sb += dx02;
+            Span(target, clip, std::min(a, b), std::max(a, b), y, painter);
+        }
+
+        // 下半分
+        sa = dx12 * (y - y1);
+        sb = dx02 * (y - y0);
+        for (; y <= y2; ++y)
+        {
+            const int32_t a = x1 + sa / dy12;
+            const int32_t b = x0 + sb / dy02;
+            sa += dx12;
+            sb += dx02;
+            Span(target, clip, std::min(a, b), std::max(a, b), y, painter);
+        }
+    }
+
+    // 白で描いた文字の下書き (G の濃さを被覆率として使う) を合成する
+    // mask は area と同じ大きさで、area は描画先の座標
+    inline void FillMask(lgfx::LovyanGFX &target, const DirtyRect &area, const lgfx::swap565_t *mask, int32_t maskStride,
+                         const Blender &blender)
+    {
+        lgfx::swap565_t buffer[ChunkPixels];
+        for (int32_t row = 0; row < area.h; ++row)
+        {
+            const lgfx::swap565_t *coverage = mask + row * maskStride;
+            for (int32_t x = 0; x < area.w; x += ChunkPixels)
+            {
+                const int32_t count = std::min(ChunkPixels, area.w - x);
+                bool covered = false;
+                for (int32_t i = 0; i < count && !covered; ++i)
+                {
+                    covered = coverage[x + i].raw != 0;
+                }
+                if (!covered)
+                {
+                    continue;
+                }
+                target.readRect(area.x + x, area.y + row, count, 1, buffer);
+                for (int32_t i = 0; i < count; ++i)
+                {
+                    const uint32_t green = (Swap(coverage[x + i].raw) >> 5) & 0x3F;
+                    if (green)
+                    {
+                        buffer[i].raw = Swap(blender.blend(Swap(buffer[i].raw), (green * 32 + 31) / 63));
+                    }
+                }
+                target.pushImage(area.x + x, area.y + row, count, 1, buffer);
+            }
+        }
+    }
+}
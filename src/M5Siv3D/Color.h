@@ -1,6 +1,28 @@
 #pragma once
 
 #include "Math.h"
+#include <stddef.h>
+
+// RGB565 の各成分を 8 ビットに広げる表 (上位ビットを下位に繰り返す)
+// ヘッダーだけで定義できるようテンプレートの静的メンバーにしている
+template <class T = void>
+struct RGB565Tables
+{
+    static const uint8_t Expand5[32];
+    static const uint8_t Expand6[64];
+};
+
+template <class T>
+const uint8_t RGB565Tables<T>::Expand5[32] = {
+    0, 8, 16, 24, 33, 41, 49, 57, 66, 74, 82, 90, 99, 107, 115, 123,
+    132, 140, 148, 156, 165, 173, 181, 189, 198, 206, 214, 222, 231, 239, 247, 255};
+
+template <class T>
+const uint8_t RGB565Tables<T>::Expand6[64] = {
+    0, 4, 8, 12, 16, 20, 24, 28, 32, 36, 40, 44, 48, 52, 56, 60,
+    65, 69, 73, 77, 81, 85, 89, 93, 97, 101, 105, 109, 113, 117, 121, 125,
+    130, 134, 138, 142, 146, 150, 154, 158, 162, 166, 170, 174, 178, 182, 186, 190,
+    195, 199, 203, 207, 211, 215, 219, 223, 227, 231, 235, 239, 243, 247, 251, 255};
 
 // Color構造体の定義
 struct Color
@@ -9,18 +31,15 @@ struct Color
     uint8_t g;
     uint8_t b;
 
-    Color(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
+    constexpr Color(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
 
     // RGB565形式の整数からColorを生成するコンストラクタ
+    // 各成分を 5/6 ビットから 8 ビットに広げる (下位ビットは上位ビットの繰り返し)
     Color(uint16_t rgb565)
+        : r(RGB565Tables<>::Expand5[rgb565 >> 11]),
+          g(RGB565Tables<>::Expand6[(rgb565 >> 5) & 0x3F]),
+          b(RGB565Tables<>::Expand5[rgb565 & 0x1F])
     {
-        r = (rgb565 >> 8) & 0xF8; // 赤色成分を抽出し、5ビットから8ビットに拡張
-        g = (rgb565 >> 3) & 0xFC; // 緑色成分を抽出し、6ビットから8ビットに拡張
-        b = (rgb565 << 3) & 0xF8; // 青色成分を抽出し、5ビットから8ビットに拡張
-
-        r |= r >> 5; // 下位ビットを埋める
-        g |= g >> 6;
-        b |= b >> 5;
     }
 
     // RGB888形式の整数からColorを設定するメソッド
@@ -31,10 +50,73 @@ struct Color
         b = rgb888 & 0xFF;         // 青色成分
     }
 
-    // RGB565形式への変換
-    uint16_t toRGB565() const
+    // RGB565形式への変換 (定数の色ならコンパイル時に求まる)
+    constexpr uint16_t toRGB565() const
+    {
+        return uint16_t(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+    }
+
+    // 配列をまとめて RGB565 に変換する
+    static void ToRGB565(const Color *colors, uint16_t *out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            out[i] = colors[i].toRGB565();
+            out[i + 1] = colors[i + 1].toRGB565();
+            out[i + 2] = colors[i + 2].toRGB565();
+            out[i + 3] = colors[i + 3].toRGB565();
+        }
+        for (; i < count; ++i)
+        {
+            out[i] = colors[i].toRGB565();
+        }
+    }
+
+    // 配列をまとめてキャンバスのバッファと同じバイト順 (上位バイトが先) の RGB565 に変換する
+    // M5Canvas::getBuffer() や Image の画素に直接書き込む場合に使う
+    static void ToRGB565Swapped(const Color *colors, uint16_t *out, size_t count)
     {
-        return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            out[i] = SwapBytes(colors[i].toRGB565());
+            out[i + 1] = SwapBytes(colors[i + 1].toRGB565());
+            out[i + 2] = SwapBytes(colors[i + 2].toRGB565());
+            out[i + 3] = SwapBytes(colors[i + 3].toRGB565());
+        }
+        for (; i < count; ++i)
+        {
+            out[i] = SwapBytes(colors[i].toRGB565());
+        }
+    }
+
+    // RGB565 の配列をまとめて Color に変換する
+    static void FromRGB565(const uint16_t *pixels, Color *out, size_t count)
+    {
+        const uint8_t *expand5 = RGB565Tables<>::Expand5;
+        const uint8_t *expand6 = RGB565Tables<>::Expand6;
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            const uint16_t p0 = pixels[i];
+            const uint16_t p1 = pixels[i + 1];
+            out[i].r = expand5[p0 >> 11];
+            out[i].g = expand6[(p0 >> 5) & 0x3F];
+            out[i].b = expand5[p0 & 0x1F];
+            out[i + 1].r = expand5[p1 >> 11];
+            out[i + 1].g = expand6[(p1 >> 5) & 0x3F];
+            out[i + 1].b = expand5[p1 & 0x1F];
+        }
+        for (; i < count; ++i)
+        {
+            out[i] = Color(pixels[i]);
+        }
+    }
+
+    static uint16_t SwapBytes(uint16_t value)
+    {
+        return uint16_t((value >> 8) | (value << 8));
     }
 
     // OpenSiv3D風の色操作メソッドを追加
@@ -54,87 +136,211 @@ struct Color
             std::min(255, int(b) + int(other.b)));
     }
 
+    // 固定小数点の色相の 1 周 (60 度ごとに 256 段階)
+    static constexpr uint32_t HueSteps = 6 * 256;
+
     // HSVからRGBを生成する静的メソッド
+    // h は度 (範囲外は 360 で折り返す)、s と v は 0.0-1.0
     static Color FromHSV(float h, float s, float v)
     {
-        h = Math::fmod(h, 360.0f);
+        if (h < 0.0f || h >= 360.0f)
+        {
+            h = Math::fmod(h, 360.0f);
+            if (h < 0.0f)
+            {
+                h += 360.0f;
+            }
+        }
         s = std::min(1.0f, std::max(0.0f, s));
         v = std::min(1.0f, std::max(0.0f, v));
 
-        float c = v * s;
-        float x = c * (1 - std::abs(fmod(h / 60.0f, 2) - 1));
-        float m = v - c;
-
-        float r = 0, g = 0, b = 0;
-
-        if (h >= 0 && h < 60)
-        {
-            r = c;
-            g = x;
-            b = 0;
-        }
-        else if (h >= 60 && h < 120)
-        {
-            r = x;
-            g = c;
-            b = 0;
-        }
-        else if (h >= 120 && h < 180)
-        {
-            r = 0;
-            g = c;
-            b = x;
-        }
-        else if (h >= 180 && h < 240)
-        {
-            r = 0;
-            g = x;
-            b = c;
-        }
-        else if (h >= 240 && h < 300)
-        {
-            r = x;
-            g = 0;
-            b = c;
-        }
-        else
-        {
-            r = c;
-            g = 0;
-            b = x;
-        }
+        // 60 度ごとの区間と、区間内の位置 (16 ビット) に分ける
+        const uint32_t hue = std::min(uint32_t(h * (65536.0f / 60.0f)), 6 * 65536u - 1);
+        return FromHSV16(hue, uint32_t(s * 65535.0f + 0.5f), uint32_t(v * 65535.0f + 0.5f));
+    }
 
-        return Color(
-            uint8_t((r + m) * 255),
-            uint8_t((g + m) * 255),
-            uint8_t((b + m) * 255));
+    // 整数の HSV から RGB を生成する
+    // hue は 0 - (HueSteps - 1) (範囲外は折り返す)、saturation と value は 0-255
+    static Color FromHSVFixed(uint32_t hue, uint8_t saturation, uint8_t value)
+    {
+        hue %= HueSteps;
+        return FromHSV16(((hue >> 8) << 16) | ((hue & 0xFF) * 257), saturation * 257u, value * 257u);
     }
 
     // RGBからHSVに変換するメソッド
     void toHSV(float &h, float &s, float &v) const
     {
-        float r_norm = r / 255.0f;
-        float g_norm = g / 255.0f;
-        float b_norm = b / 255.0f;
-
-        float cmax = std::max({r_norm, g_norm, b_norm});
-        float cmin = std::min({r_norm, g_norm, b_norm});
-        float diff = cmax - cmin;
+        const int32_t cmax = std::max({r, g, b});
+        const int32_t cmin = std::min({r, g, b});
+        const int32_t diff = cmax - cmin;
 
         // Hue calculation
         if (diff == 0)
             h = 0;
-        else if (cmax == r_norm)
-            h = fmod(60 * ((g_norm - b_norm) / diff) + 360, 360);
-        else if (cmax == g_norm)
-            h = 60 * ((b_norm - r_norm) / diff) + 120;
-        else if (cmax == b_norm)
-            h = 60 * ((r_norm - g_norm) / diff) + 240;
+        else if (cmax == r)
+            h = 60.0f * (g - b) / diff + ((g < b) ? 360.0f : 0.0f);
+        else if (cmax == g)
+            h = 60.0f * (b - r) / diff + 120.0f;
+        else
+            h = 60.0f * (r - g) / diff + 240.0f;
 
         // Saturation calculation
-        s = (cmax == 0) ? 0 : (diff / cmax);
+        s = (cmax == 0) ? 0.0f : float(diff) / cmax;
 
         // Value calculation
-        v = cmax;
+        v = cmax / 255.0f;
+    }
+
+    // 整数の HSV に変換する (hue は 0 - (HueSteps - 1)、saturation と value は 0-255)
+    void toHSVFixed(uint16_t &hue, uint8_t &saturation, uint8_t &value) const
+    {
+        const int32_t cmax = std::max({r, g, b});
+        const int32_t cmin = std::min({r, g, b});
+        const int32_t diff = cmax - cmin;
+
+        int32_t h = 0;
+        if (diff != 0)
+        {
+            // 区間内の位置を四捨五入で 256 段階にする
+            if (cmax == r)
+                h = ((g - b) * 256 * 2 + ((g >= b) ? diff : -diff)) / (diff * 2);
+            else if (cmax == g)
+                h = 512 + ((b - r) * 256 * 2 + ((b >= r) ? diff : -diff)) / (diff * 2);
+            else
+                h = 1024 + ((r - g) * 256 * 2 + ((r >= g) ? diff : -diff)) / (diff * 2);
+            if (h < 0)
+                h += HueSteps;
+        }
+        hue = uint16_t(h);
+        saturation = (cmax == 0) ? 0 : uint8_t((diff * 255 * 2 + cmax) / (cmax * 2));
+        value = uint8_t(cmax);
+    }
+
+private:
+    // 固定小数点の HSV から RGB を生成する
+    // hue の上位は 60 度ごとの区間 (0-5)、下位 16 ビットは区間内の位置。saturation と value は 0-65535
+    static Color FromHSV16(uint32_t hue, uint32_t saturation, uint32_t value)
+    {
+        const uint32_t sector = hue >> 16;
+        const uint32_t fraction = hue & 0xFFFF;
+        const uint32_t chroma = (value * saturation) >> 16;
+        const uint32_t m = value - chroma;
+        // 偶数の区間では増え、奇数の区間では減る成分
+        const uint32_t rising = ((chroma * fraction) >> 16) + m;
+        const uint32_t falling = ((chroma * (65536 - fraction)) >> 16) + m;
+        const uint32_t top = value;
+
+        uint32_t red, green, blue;
+        switch (sector)
+        {
+        case 0: red = top; green = rising; blue = m; break;
+        case 1: red = falling; green = top; blue = m; break;
+        case 2: red = m; green = top; blue = rising; break;
+        case 3: red = m; green = falling; blue = top; break;
+        case 4: red = rising; green = m; blue = top; break;
+        default: red = top; green = m; blue = falling; break;
+        }
+        // 切り捨てると 65535 が 254 になるので四捨五入する
+        return Color(uint8_t((red * 255 + 32768) >> 16), uint8_t((green * 255 + 32768) >> 16), uint8_t((blue * 255 + 32768) >> 16));
     }
-}; 
\ No newline at end of file
+}; 
+
+// RGB565 に変換済みの色
+// 同じ色で何度も描画する場合 (パーティクルなど) に作っておくと、描画のたびの変換を省ける
+//
+//   constexpr Color565 spark = Palette::Orange;
+//   for (const auto &p : particles)
+//   {
+//       Circle(p.x, p.y, 1).draw(spark);
+//   }
+struct Color565
+{
+    uint16_t value;
+
+    constexpr Color565() : value(0) {}
+
+    // RGB565形式の整数 (変換しない)
+    constexpr Color565(uint16_t rgb565) : value(rgb565) {}
+
+    constexpr Color565(const Color &color) : value(color.toRGB565()) {}
+
+    constexpr uint16_t toRGB565() const { return value; }
+
+    Color toColor() const { return Color(value); }
+
+    constexpr bool operator==(const Color565 &other) const { return value == other.value; }
+    constexpr bool operator!=(const Color565 &other) const { return value != other.value; }
+};
+
+// 不透明度付きの色 (a = 255 で不透明、0 で透明)
+// 図形や文字の draw() に渡すと、BlendMode に従って描画先と合成する
+//
+//   Rect(10, 10, 100, 50).draw(ColorA(Palette::Black, 128));
+//   Circle(160, 120, 40).draw(ColorA(255, 128, 0), BlendMode::Additive);
+struct ColorA
+{
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t a;
+
+    constexpr ColorA(uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha = 255) : r(red), g(green), b(blue), a(alpha) {}
+
+    constexpr explicit ColorA(const Color &color, uint8_t alpha = 255) : r(color.r), g(color.g), b(color.b), a(alpha) {}
+
+    // 不透明度を除いた色
+    constexpr Color rgb() const { return Color(r, g, b); }
+
+    constexpr uint16_t toRGB565() const
+    {
+        return uint16_t(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+    }
+};
+
+// 彩度と明度を固定した色相環の RGB565 の表 (1 度ごとに 360 色)
+// 虹色に変化させる場合などに、描画のたびの HSV の計算を省ける
+//
+//   static const HueWheel wheel(204);   // 彩度 0.8
+//   Circle(160, 120, 30).draw(wheel[frame]);
+class HueWheel
+{
+public:
+    static constexpr int32_t Size = 360;
+
+    explicit HueWheel(uint8_t saturation = 255, uint8_t value = 255)
+    {
+        for (int32_t degree = 0; degree < Size; ++degree)
+        {
+            m_table[degree] = Color::FromHSVFixed(uint32_t(degree) * Color::HueSteps / Size, saturation, value).toRGB565();
+        }
+    }
+
+    // degree 度の色 (範囲外は 360 で折り返す)
+    Color565 operator[](int32_t degree) const
+    {
+        if (uint32_t(degree) >= uint32_t(Size))
+        {
+            degree %= Size;
+            if (degree < 0)
+            {
+                degree += Size;
+            }
+        }
+        return Color565(m_table[degree]);
+    }
+
+    Color565 at(float degree) const
+    {
+        return (*this)[int32_t(Math::floor(degree))];
+    }
+
+    // 彩度・明度が最大の色相環 (初めて使うときに作る)
+    static const HueWheel &Default()
+    {
+        static const HueWheel wheel;
+        return wheel;
+    }
+
+private:
+    uint16_t m_table[Size];
+};
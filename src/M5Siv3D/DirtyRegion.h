@@ -0,0 +1,234 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <algorithm>
+
+// 画面上の矩形領域 (差分転送で使う)
+struct DirtyRect
+{
+    int32_t x;
+    int32_t y;
+    int32_t w;
+    int32_t h;
+
+    DirtyRect() : x(0), y(0), w(0), h(0) {}
+    DirtyRect(int32_t _x, int32_t _y, int32_t _w, int32_t _h) : x(_x), y(_y), w(_w), h(_h) {}
+
+    // 負の幅・高さを fillRect と同じく (x, y) から反対側に広げた矩形
+    static DirtyRect Normalized(int32_t x, int32_t y, int32_t w, int32_t h)
+    {
+        if (w < 0)
+        {
+            x += w + 1;
+            w = -w;
+        }
+        if (h < 0)
+        {
+            y += h + 1;
+            h = -h;
+        }
+        return DirtyRect(x, y, w, h);
+    }
+
+    bool isEmpty() const { return w <= 0 || h <= 0; }
+    int32_t right() const { return x + w; }
+    int32_t bottom() const { return y + h; }
+    uint32_t area() const { return isEmpty() ? 0 : uint32_t(w) * uint32_t(h); }
+
+    bool contains(const DirtyRect &other) const
+    {
+        return other.x >= x && other.y >= y && other.right() <= right() && other.bottom() <= bottom();
+    }
+
+    bool intersects(const DirtyRect &other) const
+    {
+        return x < other.right() && other.x < right() && y < other.bottom() && other.y < bottom();
+    }
+
+    // 両方を含む最小の矩形
+    DirtyRect united(const DirtyRect &other) const
+    {
+        if (isEmpty()) return other;
+        if (other.isEmpty()) return *this;
+        const int32_t l = std::min(x, other.x);
+        const int32_t t = std::min(y, other.y);
+        return DirtyRect(l, t, std::max(right(), other.right()) - l, std::max(bottom(), other.bottom()) - t);
+    }
+
+    // 共通部分 (重ならなければ空)
+    DirtyRect intersected(const DirtyRect &other) const
+    {
+        const int32_t l = std::max(x, other.x);
+        const int32_t t = std::max(y, other.y);
+        const int32_t r = std::min(right(), other.right());
+        const int32_t b = std::min(bottom(), other.bottom());
+        return (l < r && t < b) ? DirtyRect(l, t, r - l, b - t) : DirtyRect();
+    }
+};
+
+// 1フレーム分の更新領域を、上限数以内の矩形の集合として保持する
+// 近い矩形は随時結合し、上限に達したら無駄の最も少ない組を結合する
+class DirtyRegion
+{
+public:
+    static constexpr size_t MaxRects = 16;
+
+    // 結合で増える面積がこの値以下なら、別々に転送するより結合した方が得とみなす
+    static constexpr uint32_t MergeSlack = 256;
+
+    // 画面サイズの設定 (範囲外の領域は切り捨てる)
+    void setBounds(int32_t width, int32_t height)
+    {
+        m_bounds = DirtyRect(0, 0, width, height);
+        clear();
+    }
+
+    const DirtyRect &bounds() const { return m_bounds; }
+
+    void add(int32_t x, int32_t y, int32_t w, int32_t h)
+    {
+        add(DirtyRect(x, y, w, h));
+    }
+
+    void add(DirtyRect rect)
+    {
+        if (m_full)
+        {
+            return;
+        }
+
+        rect = rect.intersected(m_bounds);
+        if (rect.isEmpty())
+        {
+            return;
+        }
+
+        // 既存の矩形と結合できる限り結合する
+        for (size_t i = 0; i < m_count;)
+        {
+            const DirtyRect &current = m_rects[i];
+            if (current.contains(rect))
+            {
+                return;
+            }
+            if (shouldMerge(current, rect))
+            {
+                rect = rect.united(current);
+                removeAt(i);
+                i = 0;
+                continue;
+            }
+            ++i;
+        }
+
+        // 上限に達していれば、増える面積が最小の矩形に吸収させる
+        while (m_count >= MaxRects)
+        {
+            size_t best = 0;
+            uint32_t bestCost = UINT32_MAX;
+            for (size_t i = 0; i < m_count; ++i)
+            {
+                const uint32_t cost = mergeCost(m_rects[i], rect);
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    best = i;
+                }
+            }
+            rect = rect.united(m_rects[best]);
+            removeAt(best);
+        }
+
+        m_rects[m_count++] = rect;
+
+        // 画面の大半を占めるなら全面として扱う
+        if (area() >= m_bounds.area() / 4 * 3)
+        {
+            addAll();
+        }
+    }
+
+    void add(const DirtyRegion &other)
+    {
+        if (other.m_full)
+        {
+            addAll();
+            return;
+        }
+        for (size_t i = 0; i < other.m_count; ++i)
+        {
+            add(other.m_rects[i]);
+        }
+    }
+
+    // 画面全体を更新対象にする
+    void addAll()
+    {
+        m_full = true;
+        m_count = m_bounds.isEmpty() ? 0 : 1;
+        m_rects[0] = m_bounds;
+    }
+
+    void clear()
+    {
+        m_count = 0;
+        m_full = false;
+    }
+
+    bool isEmpty() const { return m_count == 0; }
+    bool isFull() const { return m_full; }
+    size_t size() const { return m_count; }
+
+    const DirtyRect &operator[](size_t index) const { return m_rects[index]; }
+    const DirtyRect *begin() const { return m_rects; }
+    const DirtyRect *end() const { return m_rects + m_count; }
+
+    // 矩形の面積の合計 (重なりは重複して数える)
+    uint32_t area() const
+    {
+        uint32_t total = 0;
+        for (size_t i = 0; i < m_count; ++i)
+        {
+            total += m_rects[i].area();
+        }
+        return total;
+    }
+
+    // 指定した矩形と重なるかどうか
+    bool intersects(const DirtyRect &rect) const
+    {
+        for (size_t i = 0; i < m_count; ++i)
+        {
+            if (m_rects[i].intersects(rect))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    DirtyRect m_bounds;
+    DirtyRect m_rects[MaxRects];
+    size_t m_count = 0;
+    bool m_full = false;
+
+    // 別々に転送する場合と比べて、結合によって増える転送量
+    static uint32_t mergeCost(const DirtyRect &a, const DirtyRect &b)
+    {
+        const uint32_t separate = a.area() + b.area();
+        const uint32_t merged = a.united(b).area();
+        return merged > separate ? merged - separate : 0;
+    }
+
+    static bool shouldMerge(const DirtyRect &a, const DirtyRect &b)
+    {
+        return mergeCost(a, b) <= MergeSlack;
+    }
+
+    void removeAt(size_t index)
+    {
+        m_rects[index] = m_rects[--m_count];
+    }
+};
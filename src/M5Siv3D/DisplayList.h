@@ -0,0 +1,819 @@
+#pragma once
+
+#include "Platform.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <initializer_list>
+#include <vector>
+#include "DirtyRegion.h"
+#include "Blend.h"
+#include "Gradient.h"
+#include "ImageData.h"
+
+// 描画命令の種類
+enum class DrawOp : uint8_t
+{
+    FillRect,
+    DrawRect,
+    FillRoundRect,
+    DrawRoundRect,
+    FillCircle,
+    DrawCircle,
+    FillArc,
+    DrawArc,
+    DrawLine,
+    FillTriangle,
+    DrawTriangle,
+    DrawBezier3,
+    DrawBezier4,
+    Text,     // 1 行の文字列 (drawString)
+    Print,    // 折り返し付きの文字列 (print)
+    Sprite,   // スプライトの転送 (拡大縮小あり)
+    TransparentSprite, // 透過色を除いたスプライトの転送
+    Callback, // 任意の描画関数
+    BlendRect,     // 合成して塗る矩形 (最後の引数は合成方法 << 8 | 不透明度)
+    BlendCircle,
+    BlendTriangle,
+    BlendText,
+    GradientRect,  // グラデーションで塗る矩形 (最後の 3 つの引数は Gradient::encode の値)
+    GradientCircle,
+    GradientTriangle,
+    FlashImage,    // フラッシュの画像 (ImageData) の一部の転送 (拡大縮小あり)
+    SpriteRegion,  // スプライトの一部の転送
+    TransformedFlashImage, // 変換したフラッシュの画像 (引数は ImageTransform の逆変換)
+    TransformedSprite,     // 変換したスプライト
+};
+
+// 任意の描画処理 (dx, dy は記録時の座標に加える平行移動量)
+using DrawCallback = void (*)(lgfx::LovyanGFX &target, int32_t dx, int32_t dy, void *context);
+
+// 1 回分の描画命令
+// 図形の draw() はこの命令を作って System::submit() に渡す。
+// System はそのままキャンバスに描画するか、DisplayList に記録して後から再生する。
+struct DrawCommand
+{
+    static constexpr uint8_t MaxArgs = 9;
+
+    DrawOp op;
+    uint8_t argCount;
+    uint16_t color;        // RGB565
+    DirtyRect bounds;      // 描画される範囲 (更新領域・帯の選別に使う)
+    int32_t args[MaxArgs]; // 座標など (命令ごとに意味が異なる)
+
+    // Text / Print / BlendText / Sprite / FlashImage / SpriteRegion / Transformed* / Callback のみ
+    const void *object;    // フォント・スプライト・画像・コールバックの引数
+    DrawCallback callback;
+    float scaleX;          // 文字サイズ・拡大率
+    float scaleY;
+    const char *text;
+    uint16_t textLength;
+
+    //////////////////////////////////////////////////
+    // 生成
+    //////////////////////////////////////////////////
+
+    // 矩形の幅・高さが負の場合は LovyanGFX の fillRect と同じく反対側に広げ、更新範囲もそれに合わせる
+    static DrawCommand FillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color)
+    {
+        const DirtyRect r = DirtyRect::Normalized(x, y, w, h);
+        return Make(DrawOp::FillRect, color, r, {r.x, r.y, r.w, r.h});
+    }
+
+    static DrawCommand DrawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color)
+    {
+        const DirtyRect r = DirtyRect::Normalized(x, y, w, h);
+        return Make(DrawOp::DrawRect, color, r, {r.x, r.y, r.w, r.h});
+    }
+
+    static DrawCommand FillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint16_t color)
+    {
+        const DirtyRect rect = DirtyRect::Normalized(x, y, w, h);
+        return Make(DrawOp::FillRoundRect, color, rect, {rect.x, rect.y, rect.w, rect.h, r});
+    }
+
+    static DrawCommand DrawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint16_t color)
+    {
+        const DirtyRect rect = DirtyRect::Normalized(x, y, w, h);
+        return Make(DrawOp::DrawRoundRect, color, rect, {rect.x, rect.y, rect.w, rect.h, r});
+    }
+
+    static DrawCommand FillCircle(int32_t x, int32_t y, int32_t r, uint16_t color)
+    {
+        return Make(DrawOp::FillCircle, color, CircleBounds(x, y, r), {x, y, r});
+    }
+
+    static DrawCommand DrawCircle(int32_t x, int32_t y, int32_t r, uint16_t color)
+    {
+        return Make(DrawOp::DrawCircle, color, CircleBounds(x, y, r), {x, y, r});
+    }
+
+    static DrawCommand FillArc(int32_t x, int32_t y, int32_t r0, int32_t r1, int32_t startAngle, int32_t endAngle, uint16_t color)
+    {
+        return Make(DrawOp::FillArc, color, CircleBounds(x, y, std::max(r0, r1)), {x, y, r0, r1, startAngle, endAngle});
+    }
+
+    static DrawCommand DrawArc(int32_t x, int32_t y, int32_t r0, int32_t r1, int32_t startAngle, int32_t endAngle, uint16_t color)
+    {
+        return Make(DrawOp::DrawArc, color, CircleBounds(x, y, std::max(r0, r1)), {x, y, r0, r1, startAngle, endAngle});
+    }
+
+    static DrawCommand DrawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t color)
+    {
+        return Make(DrawOp::DrawLine, color, PointBounds(x0, y0, x1, y1, x0, y0), {x0, y0, x1, y1});
+    }
+
+    static DrawCommand FillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t color)
+    {
+        return Make(DrawOp::FillTriangle, color, PointBounds(x0, y0, x1, y1, x2, y2), {x0, y0, x1, y1, x2, y2});
+    }
+
+    static DrawCommand DrawTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t color)
+    {
+        return Make(DrawOp::DrawTriangle, color, PointBounds(x0, y0, x1, y1, x2, y2), {x0, y0, x1, y1, x2, y2});
+    }
+
+    // 曲線は制御点の凸包に含まれるので、制御点を囲む矩形を範囲とする
+    static DrawCommand DrawBezier(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t color)
+    {
+        return Make(DrawOp::DrawBezier3, color, PointBounds(x0, y0, x1, y1, x2, y2), {x0, y0, x1, y1, x2, y2});
+    }
+
+    static DrawCommand DrawBezier(int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                                  int32_t x2, int32_t y2, int32_t x3, int32_t y3, uint16_t color)
+    {
+        const DirtyRect bounds = PointBounds(x0, y0, x1, y1, x2, y2).united(PointBounds(x3, y3, x3, y3, x3, y3));
+        return Make(DrawOp::DrawBezier4, color, bounds, {x0, y0, x1, y1, x2, y2, x3, y3});
+    }
+
+    // 描画先の画素と合成して塗る (alpha は 0-255)
+    static DrawCommand BlendRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color, uint8_t alpha, BlendMode mode)
+    {
+        const DirtyRect r = DirtyRect::Normalized(x, y, w, h);
+        return Make(DrawOp::BlendRect, color, r, {r.x, r.y, r.w, r.h, BlendArg(alpha, mode)});
+    }
+
+    static DrawCommand BlendCircle(int32_t x, int32_t y, int32_t r, uint16_t color, uint8_t alpha, BlendMode mode)
+    {
+        return Make(DrawOp::BlendCircle, color, CircleBounds(x, y, r), {x, y, r, BlendArg(alpha, mode)});
+    }
+
+    static DrawCommand BlendTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2,
+                                     uint16_t color, uint8_t alpha, BlendMode mode)
+    {
+        return Make(DrawOp::BlendTriangle, color, PointBounds(x0, y0, x1, y1, x2, y2),
+                    {x0, y0, x1, y1, x2, y2, BlendArg(alpha, mode)});
+    }
+
+    // グラデーションで塗る (色は図形の外接矩形を基準に変化する)
+    static DrawCommand GradientRect(int32_t x, int32_t y, int32_t w, int32_t h, const Gradient &gradient)
+    {
+        int32_t g[3];
+        gradient.encode(g);
+        const DirtyRect r = DirtyRect::Normalized(x, y, w, h);
+        return Make(DrawOp::GradientRect, 0, r, {r.x, r.y, r.w, r.h, g[0], g[1], g[2]});
+    }
+
+    static DrawCommand GradientCircle(int32_t x, int32_t y, int32_t r, const Gradient &gradient)
+    {
+        int32_t g[3];
+        gradient.encode(g);
+        return Make(DrawOp::GradientCircle, 0, CircleBounds(x, y, r), {x, y, r, g[0], g[1], g[2]});
+    }
+
+    static DrawCommand GradientTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2,
+                                        const Gradient &gradient)
+    {
+        int32_t g[3];
+        gradient.encode(g);
+        return Make(DrawOp::GradientTriangle, 0, PointBounds(x0, y0, x1, y1, x2, y2),
+                    {x0, y0, x1, y1, x2, y2, g[0], g[1], g[2]});
+    }
+
+    // 文字列 (text は記録時にコピーされる)
+    static DrawCommand Text(const char *text, int32_t x, int32_t y, const lgfx::IFont *font, float size,
+                            uint16_t color, const DirtyRect &bounds)
+    {
+        DrawCommand command = Make(DrawOp::Text, color, bounds, {x, y});
+        command.object = font;
+        command.scaleX = size;
+        command.scaleY = size;
+        command.text = text;
+        // レコードの長さを 16bit に収めるため、極端に長い文字列は切り詰める
+        const size_t maxLength = 60000;
+        command.textLength = uint16_t(std::min(strlen(text), maxLength));
+        return command;
+    }
+
+    // 描画先の画素と合成する文字列 (bounds の外は描画されない)
+    static DrawCommand BlendText(const char *text, int32_t x, int32_t y, const lgfx::IFont *font, float size,
+                                 uint16_t color, uint8_t alpha, BlendMode mode, const DirtyRect &bounds)
+    {
+        DrawCommand command = Text(text, x, y, font, size, color, bounds);
+        command.op = DrawOp::BlendText;
+        command.argCount = 3;
+        command.args[2] = BlendArg(alpha, mode);
+        return command;
+    }
+
+    // 折り返し付きの文字列 (範囲は折り返し後の行まで含めて呼び出し側が求める)
+    static DrawCommand Print(const char *text, int32_t x, int32_t y, const lgfx::IFont *font, float size,
+                             uint16_t color, const DirtyRect &bounds)
+    {
+        DrawCommand command = Text(text, x, y, font, size, color, bounds);
+        command.op = DrawOp::Print;
+        return command;
+    }
+
+    // スプライトを (x, y) に拡大率 (scaleX, scaleY) で描画する (拡大縮小する場合は filter で画素を選ぶ)
+    // スプライトは再生が終わるまで解放しないこと
+    // revision はスプライトの内容を書き換えるたびに変える値 (差分の検出に使う)
+    static DrawCommand Sprite(M5Canvas *sprite, int32_t x, int32_t y, float scaleX = 1.0f, float scaleY = 1.0f, uint32_t revision = 0,
+                              ImageFilter filter = ImageFilter::Nearest)
+    {
+        const DirtyRect bounds(x, y, int32_t(sprite->width() * scaleX + 0.5f), int32_t(sprite->height() * scaleY + 0.5f));
+        DrawCommand command = Make(DrawOp::Sprite, 0, bounds, {x, y, int32_t(revision), int32_t(filter)});
+        command.object = sprite;
+        command.scaleX = scaleX;
+        command.scaleY = scaleY;
+        return command;
+    }
+
+    // スプライトを (x, y) に描画する (transparent と同じ色の画素は描画しない)
+    static DrawCommand TransparentSprite(M5Canvas *sprite, int32_t x, int32_t y, uint16_t transparent, uint32_t revision = 0)
+    {
+        const DirtyRect bounds(x, y, sprite->width(), sprite->height());
+        DrawCommand command = Make(DrawOp::TransparentSprite, transparent, bounds, {x, y, int32_t(revision)});
+        command.object = sprite;
+        return command;
+    }
+
+    // フラッシュの画像の region の部分を (x, y) に w x h の大きさで描画する
+    // 画像の内容は変わらないので、差分の検出はポインタと位置・大きさだけで行う
+    static DrawCommand FlashImage(const ImageData *data, const ImageRegion &region, int32_t x, int32_t y, int32_t w, int32_t h,
+                                  ImageFilter filter = ImageFilter::Nearest)
+    {
+        DrawCommand command = Make(DrawOp::FlashImage, 0, DirtyRect(x, y, w, h),
+                                   {x, y, w, h, region.x, region.y, region.w, region.h, int32_t(filter)});
+        command.object = data;
+        return command;
+    }
+
+    static DrawCommand FlashImage(const ImageData *data, int32_t x, int32_t y, int32_t w, int32_t h,
+                                  ImageFilter filter = ImageFilter::Nearest)
+    {
+        return FlashImage(data, ImageRegion(0, 0, data->width, data->height), x, y, w, h, filter);
+    }
+
+    // スプライトの region の部分を (x, y) に描画する (スプライトは 16 ビット色であること)
+    static DrawCommand SpriteRegion(M5Canvas *sprite, const ImageRegion &region, int32_t x, int32_t y, uint32_t revision = 0)
+    {
+        const ImageRegion source = region.clamped(sprite->width(), sprite->height());
+        const DirtyRect bounds(x + source.x - region.x, y + source.y - region.y, source.w, source.h);
+        DrawCommand command = Make(DrawOp::SpriteRegion, 0, bounds, {x, y, region.x, region.y, region.w, region.h, int32_t(revision)});
+        command.object = sprite;
+        return command;
+    }
+
+    // フラッシュの画像を transform で変換して描画する (bounds は変換した画像を囲む範囲)
+    static DrawCommand TransformedFlashImage(const ImageData *data, const ImageTransform &transform, const DirtyRect &bounds,
+                                             ImageFilter filter = ImageFilter::Nearest)
+    {
+        DrawCommand command = Make(DrawOp::TransformedFlashImage, 0, bounds,
+                                   {transform.ux, transform.uy, transform.u0, transform.vx, transform.vy, transform.v0, int32_t(filter)});
+        command.object = data;
+        return command;
+    }
+
+    // スプライトを transform で変換して描画する (スプライトは 16 ビット色であること)
+    static DrawCommand TransformedSprite(M5Canvas *sprite, const ImageTransform &transform, const DirtyRect &bounds, uint32_t revision = 0,
+                                         ImageFilter filter = ImageFilter::Nearest)
+    {
+        DrawCommand command = Make(DrawOp::TransformedSprite, 0, bounds,
+                                   {transform.ux, transform.uy, transform.u0, transform.vx, transform.vy, transform.v0, int32_t(filter),
+                                    int32_t(revision)});
+        command.object = sprite;
+        return command;
+    }
+
+    // bounds の範囲に callback で描画する
+    // 描画内容を比較できないので、差分の検出では毎回変化したものとして扱う
+    static DrawCommand Callback(const DirtyRect &bounds, DrawCallback callback, void *context)
+    {
+        DrawCommand command = Make(DrawOp::Callback, 0, bounds, {});
+        command.object = context;
+        command.callback = callback;
+        return command;
+    }
+
+    //////////////////////////////////////////////////
+    // 実行
+    //////////////////////////////////////////////////
+
+    // target に描画する (座標を dx, dy だけ平行移動する)
+    void execute(lgfx::LovyanGFX &target, int32_t dx = 0, int32_t dy = 0) const
+    {
+        const int32_t *a = args;
+        switch (op)
+        {
+        case DrawOp::FillRect:
+            target.fillRect(a[0] + dx, a[1] + dy, a[2], a[3], color);
+            break;
+        case DrawOp::DrawRect:
+            target.drawRect(a[0] + dx, a[1] + dy, a[2], a[3], color);
+            break;
+        case DrawOp::FillRoundRect:
+            target.fillRoundRect(a[0] + dx, a[1] + dy, a[2], a[3], a[4], color);
+            break;
+        case DrawOp::DrawRoundRect:
+            target.drawRoundRect(a[0] + dx, a[1] + dy, a[2], a[3], a[4], color);
+            break;
+        case DrawOp::FillCircle:
+            target.fillCircle(a[0] + dx, a[1] + dy, a[2], color);
+            break;
+        case DrawOp::DrawCircle:
+            target.drawCircle(a[0] + dx, a[1] + dy, a[2], color);
+            break;
+        case DrawOp::FillArc:
+            target.fillArc(a[0] + dx, a[1] + dy, a[2], a[3], a[4], a[5], color);
+            break;
+        case DrawOp::DrawArc:
+            target.drawArc(a[0] + dx, a[1] + dy, a[2], a[3], a[4], a[5], color);
+            break;
+        case DrawOp::DrawLine:
+            target.drawLine(a[0] + dx, a[1] + dy, a[2] + dx, a[3] + dy, color);
+            break;
+        case DrawOp::FillTriangle:
+            target.fillTriangle(a[0] + dx, a[1] + dy, a[2] + dx, a[3] + dy, a[4] + dx, a[5] + dy, color);
+            break;
+        case DrawOp::DrawTriangle:
+            target.drawTriangle(a[0] + dx, a[1] + dy, a[2] + dx, a[3] + dy, a[4] + dx, a[5] + dy, color);
+            break;
+        case DrawOp::DrawBezier3:
+            target.drawBezier(a[0] + dx, a[1] + dy, a[2] + dx, a[3] + dy, a[4] + dx, a[5] + dy, color);
+            break;
+        case DrawOp::DrawBezier4:
+            target.drawBezier(a[0] + dx, a[1] + dy, a[2] + dx, a[3] + dy, a[4] + dx, a[5] + dy, a[6] + dx, a[7] + dy, color);
+            break;
+        case DrawOp::Text:
+        case DrawOp::Print:
+            executeText(target, dx, dy);
+            break;
+        case DrawOp::Sprite:
+            executeSprite(target, dx, dy);
+            break;
+        case DrawOp::TransparentSprite:
+            static_cast<M5Canvas *>(const_cast<void *>(object))->pushSprite(&target, args[0] + dx, args[1] + dy, color);
+            break;
+        case DrawOp::Callback:
+            callback(target, dx, dy, const_cast<void *>(object));
+            break;
+        case DrawOp::BlendRect:
+            Blend::FillRect(target, a[0] + dx, a[1] + dy, a[2], a[3], blender(a[4]));
+            break;
+        case DrawOp::BlendCircle:
+            Blend::FillCircle(target, a[0] + dx, a[1] + dy, a[2], blender(a[3]));
+            break;
+        case DrawOp::BlendTriangle:
+            Blend::FillTriangle(target, a[0] + dx, a[1] + dy, a[2] + dx, a[3] + dy, a[4] + dx, a[5] + dy, blender(a[6]));
+            break;
+        case DrawOp::BlendText:
+            executeBlendText(target, dx, dy);
+            break;
+        case DrawOp::GradientRect:
+            Blend::FillRect(target, a[0] + dx, a[1] + dy, a[2], a[3], gradientPainter(a + 4, dx, dy));
+            break;
+        case DrawOp::GradientCircle:
+            Blend::FillCircle(target, a[0] + dx, a[1] + dy, a[2], gradientPainter(a + 3, dx, dy));
+            break;
+        case DrawOp::GradientTriangle:
+            Blend::FillTriangle(target, a[0] + dx, a[1] + dy, a[2] + dx, a[3] + dy, a[4] + dx, a[5] + dy,
+                                gradientPainter(a + 6, dx, dy));
+            break;
+        case DrawOp::FlashImage:
+            ImageBlit::DrawRegion(target, *static_cast<const ImageData *>(object), ImageRegion(a[4], a[5], a[6], a[7]),
+                                  a[0] + dx, a[1] + dy, a[2], a[3], ImageFilter(a[8]));
+            break;
+        case DrawOp::SpriteRegion:
+            executeSpriteRegion(target, dx, dy);
+            break;
+        case DrawOp::TransformedFlashImage:
+            ImageBlit::DrawTransformed(target, *static_cast<const ImageData *>(object), transformOf(dx, dy),
+                                       DirtyRect(bounds.x + dx, bounds.y + dy, bounds.w, bounds.h), ImageFilter(a[6]));
+            break;
+        case DrawOp::TransformedSprite:
+            executeTransformedSprite(target, dx, dy);
+            break;
+        }
+    }
+
+private:
+    static DrawCommand Make(DrawOp op, uint16_t color, const DirtyRect &bounds, std::initializer_list<int32_t> values)
+    {
+        DrawCommand command;
+        command.op = op;
+        command.argCount = uint8_t(values.size());
+        command.color = color;
+        command.bounds = bounds;
+        size_t i = 0;
+        for (int32_t value : values)
+        {
+            command.args[i++] = value;
+        }
+        command.object = nullptr;
+        command.callback = nullptr;
+        command.scaleX = 1.0f;
+        command.scaleY = 1.0f;
+        command.text = nullptr;
+        command.textLength = 0;
+        return command;
+    }
+
+    static int32_t BlendArg(uint8_t alpha, BlendMode mode)
+    {
+        return (int32_t(mode) << 8) | alpha;
+    }
+
+    Blend::Blender blender(int32_t arg) const
+    {
+        return Blend::Blender(color, uint8_t(arg), BlendMode(arg >> 8));
+    }
+
+    GradientPainter gradientPainter(const int32_t *encoded, int32_t dx, int32_t dy) const
+    {
+        return GradientPainter(Gradient::Decode(encoded), DirtyRect(bounds.x + dx, bounds.y + dy, bounds.w, bounds.h));
+    }
+
+    static DirtyRect CircleBounds(int32_t x, int32_t y, int32_t r)
+    {
+        return DirtyRect(x - r, y - r, r * 2 + 1, r * 2 + 1);
+    }
+
+    static DirtyRect PointBounds(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+    {
+        const int32_t left = std::min(x0, std::min(x1, x2));
+        const int32_t top = std::min(y0, std::min(y1, y2));
+        const int32_t right = std::max(x0, std::max(x1, x2));
+        const int32_t bottom = std::max(y0, std::max(y1, y2));
+        return DirtyRect(left, top, right - left + 1, bottom - top + 1);
+    }
+
+    void executeText(lgfx::LovyanGFX &target, int32_t dx, int32_t dy) const
+    {
+        // 記録された文字列は終端されていないので、一時バッファに写す
+        char stackBuffer[64];
+        std::vector<char> heapBuffer;
+        char *buffer = stackBuffer;
+        if (textLength >= sizeof(stackBuffer))
+        {
+            heapBuffer.resize(textLength + 1);
+            buffer = heapBuffer.data();
+        }
+        memcpy(buffer, text, textLength);
+        buffer[textLength] = '\0';
+
+        target.setTextColor(color);
+        target.setFont(static_cast<const lgfx::IFont *>(object));
+        target.setTextSize(scaleX, scaleY);
+        if (op == DrawOp::Print)
+        {
+            target.setCursor(args[0] + dx, args[1] + dy);
+            target.print(buffer);
+        }
+        else
+        {
+            target.drawString(buffer, args[0] + dx, args[1] + dy);
+        }
+    }
+
+    // 白い文字を作業用のキャンバスに描き、その濃さに応じて文字色を合成する
+    void executeBlendText(lgfx::LovyanGFX &target, int32_t dx, int32_t dy) const
+    {
+        const DirtyRect area = DirtyRect(bounds.x + dx, bounds.y + dy, bounds.w, bounds.h).intersected(Blend::ClipArea(target));
+        if (area.isEmpty())
+        {
+            return;
+        }
+
+        // 作業用のキャンバスは描く範囲の大きさで毎回確保し、描き終えたら解放する
+        // (使い回すと、一番大きな文字の分のメモリを持ち続けてしまう)
+        M5Canvas mask;
+        mask.setColorDepth(16);
+        if (!mask.createSprite(area.w, area.h))
+        {
+            Serial.println("BlendText: failed to allocate mask");
+            return;
+        }
+        mask.fillScreen(0);
+
+        DrawCommand white = *this;
+        white.op = DrawOp::Text;
+        white.color = 0xFFFF;
+        white.executeText(mask, dx - area.x, dy - area.y);
+
+        Blend::FillMask(target, area, static_cast<const lgfx::swap565_t *>(mask.getBuffer()), mask.width(), blender(args[2]));
+    }
+
+    // スプライトの画素をフラッシュの画像と同じ形式として扱い、必要な行だけ転送する
+    static ImageData SpriteData(const M5Canvas *sprite)
+    {
+        return ImageData::RGB565(sprite->width(), sprite->height(), static_cast<const uint16_t *>(sprite->getBuffer()));
+    }
+
+    void executeSpriteRegion(lgfx::LovyanGFX &target, int32_t dx, int32_t dy) const
+    {
+        const ImageData data = SpriteData(static_cast<const M5Canvas *>(object));
+        if (data.pixels)
+        {
+            ImageBlit::DrawRegion(target, data, ImageRegion(args[2], args[3], args[4], args[5]),
+                                  args[0] + dx, args[1] + dy, args[4], args[5]);
+        }
+    }
+
+    ImageTransform transformOf(int32_t dx, int32_t dy) const
+    {
+        const ImageTransform transform = {args[0], args[1], args[2], args[3], args[4], args[5]};
+        return transform.translated(dx, dy);
+    }
+
+    void executeTransformedSprite(lgfx::LovyanGFX &target, int32_t dx, int32_t dy) const
+    {
+        const ImageData data = SpriteData(static_cast<const M5Canvas *>(object));
+        if (data.pixels)
+        {
+            ImageBlit::DrawTransformed(target, data, transformOf(dx, dy), DirtyRect(bounds.x + dx, bounds.y + dy, bounds.w, bounds.h),
+                                       ImageFilter(args[6]));
+        }
+    }
+
+    void executeSprite(lgfx::LovyanGFX &target, int32_t dx, int32_t dy) const
+    {
+        M5Canvas *sprite = static_cast<M5Canvas *>(const_cast<void *>(object));
+        if (scaleX == 1.0f && scaleY == 1.0f)
+        {
+            sprite->pushSprite(&target, args[0] + dx, args[1] + dy);
+            return;
+        }
+
+        // 一時的なスプライトを作らず、描画先に直接拡大縮小して書き込む
+        const ImageData data = SpriteData(sprite);
+        if (data.pixels)
+        {
+            ImageBlit::DrawScaled(target, data, args[0] + dx, args[1] + dy, bounds.w, bounds.h, ImageFilter(args[3]));
+        }
+    }
+};
+
+// 描画命令の記録
+// 命令は可変長のレコードとしてバイト列 (アリーナ) に詰めて保存する。
+// clear() しても確保済みの領域は再利用するので、毎フレーム記録し直しても確保は発生しない。
+class DisplayList
+{
+public:
+    // 記録を消去する (領域は保持する)
+    void clear()
+    {
+        m_data.clear();
+        m_offsets.clear();
+    }
+
+    bool isEmpty() const { return m_offsets.empty(); }
+
+    // 記録した命令の数
+    size_t size() const { return m_offsets.size(); }
+
+    // index 番目の命令
+    DrawCommand operator[](size_t index) const
+    {
+        return Decode(m_data.data() + m_offsets[index]);
+    }
+
+    // 確保済みの領域ごと中身を入れ替える (前フレームの記録との入れ替え用)
+    void swap(DisplayList &other)
+    {
+        m_data.swap(other.m_data);
+        m_offsets.swap(other.m_offsets);
+    }
+
+    // すべての命令を囲む矩形
+    DirtyRect bounds() const
+    {
+        DirtyRect result;
+        for (Iterator it = begin(); it != end(); ++it)
+        {
+            result = result.united((*it).bounds);
+        }
+        return result;
+    }
+
+    // 記録に使っているバイト数
+    size_t bytes() const { return m_data.size(); }
+
+    void append(const DrawCommand &command)
+    {
+        const bool hasObject = HasObject(command.op);
+        const size_t textLength = HasText(command.op) ? command.textLength : 0;
+        const size_t recordSize = sizeof(RecordHeader) + command.argCount * sizeof(int32_t) +
+                                  (hasObject ? sizeof(RecordObject) : 0) + textLength;
+
+        RecordHeader header;
+        header.op = command.op;
+        header.argCount = command.argCount;
+        header.color = command.color;
+        header.textLength = uint16_t(textLength);
+        header.recordSize = uint16_t(recordSize);
+        header.bounds[0] = command.bounds.x;
+        header.bounds[1] = command.bounds.y;
+        header.bounds[2] = command.bounds.w;
+        header.bounds[3] = command.bounds.h;
+
+        const size_t offset = m_data.size();
+        m_data.resize(offset + recordSize);
+        m_offsets.push_back(uint32_t(offset));
+        uint8_t *out = m_data.data() + offset;
+
+        memcpy(out, &header, sizeof(header));
+        out += sizeof(header);
+        memcpy(out, command.args, command.argCount * sizeof(int32_t));
+        out += command.argCount * sizeof(int32_t);
+        if (hasObject)
+        {
+            RecordObject object;
+            object.object = command.object;
+            object.callback = command.callback;
+            object.scaleX = command.scaleX;
+            object.scaleY = command.scaleY;
+            memcpy(out, &object, sizeof(object));
+            out += sizeof(object);
+        }
+        if (textLength)
+        {
+            memcpy(out, command.text, textLength);
+        }
+    }
+
+    // 記録した順に命令を取り出す
+    // 取り出した Text / Print 命令の文字列は、この DisplayList を変更するまで有効
+    class Iterator
+    {
+    public:
+        Iterator(const uint8_t *position) : m_position(position) {}
+
+        DrawCommand operator*() const { return Decode(m_position); }
+
+        Iterator &operator++()
+        {
+            RecordHeader header;
+            memcpy(&header, m_position, sizeof(header));
+            m_position += header.recordSize;
+            return *this;
+        }
+
+        bool operator!=(const Iterator &other) const { return m_position != other.m_position; }
+
+    private:
+        const uint8_t *m_position;
+    };
+
+    Iterator begin() const { return Iterator(m_data.data()); }
+    Iterator end() const { return Iterator(m_data.data() + m_data.size()); }
+
+    // target に再生する
+    // 命令の座標を dx, dy だけ平行移動し、target の範囲に掛からない命令は飛ばす
+    void replay(lgfx::LovyanGFX &target, int32_t dx = 0, int32_t dy = 0) const
+    {
+        const DirtyRect area(-dx, -dy, target.width(), target.height());
+        for (Iterator it = begin(); it != end(); ++it)
+        {
+            const DrawCommand command = *it;
+            if (command.bounds.intersects(area))
+            {
+                command.execute(target, dx, dy);
+            }
+        }
+    }
+
+    // previous を描画した画面と current を描画した画面で、画素が異なりうる領域を damage に加える
+    //
+    // 先頭と末尾で一致する命令を除いた残りの範囲を集める。それ以外の画素に関わる命令は
+    // 同じ順序で同じ内容なので、描画結果も変わらない。
+    static void Diff(const DisplayList &previous, const DisplayList &current, DirtyRegion &damage)
+    {
+        const size_t previousCount = previous.size();
+        const size_t currentCount = current.size();
+
+        size_t head = 0;
+        while (head < previousCount && head < currentCount && SameRecord(previous, head, current, head))
+        {
+            ++head;
+        }
+
+        size_t tail = 0;
+        while (tail < previousCount - head && tail < currentCount - head &&
+               SameRecord(previous, previousCount - 1 - tail, current, currentCount - 1 - tail))
+        {
+            ++tail;
+        }
+
+        for (size_t i = head; i < previousCount - tail; ++i)
+        {
+            damage.add(previous[i].bounds);
+        }
+        for (size_t i = head; i < currentCount - tail; ++i)
+        {
+            damage.add(current[i].bounds);
+        }
+    }
+
+private:
+    // レコードの先頭 (この後に引数・オブジェクト・文字列が続く)
+    struct RecordHeader
+    {
+        DrawOp op;
+        uint8_t argCount;
+        uint16_t color;
+        uint16_t textLength;
+        uint16_t recordSize;
+        int32_t bounds[4];
+    };
+
+    struct RecordObject
+    {
+        const void *object;
+        DrawCallback callback;
+        float scaleX;
+        float scaleY;
+    };
+
+    std::vector<uint8_t> m_data;
+    std::vector<uint32_t> m_offsets; // 各レコードの開始位置
+
+    size_t recordSize(size_t index) const
+    {
+        const size_t end = (index + 1 < m_offsets.size()) ? m_offsets[index + 1] : m_data.size();
+        return end - m_offsets[index];
+    }
+
+    // バイト列が一致すれば同じ命令 (フォントやスプライトはポインタで比較する)
+    static bool SameRecord(const DisplayList &a, size_t indexA, const DisplayList &b, size_t indexB)
+    {
+        const size_t size = a.recordSize(indexA);
+        if (size != b.recordSize(indexB))
+        {
+            return false;
+        }
+        const uint8_t *recordA = a.m_data.data() + a.m_offsets[indexA];
+        const uint8_t *recordB = b.m_data.data() + b.m_offsets[indexB];
+        if (static_cast<DrawOp>(recordA[0]) == DrawOp::Callback)
+        {
+            return false;
+        }
+        return memcmp(recordA, recordB, size) == 0;
+    }
+
+    static bool HasText(DrawOp op)
+    {
+        return op == DrawOp::Text || op == DrawOp::Print || op == DrawOp::BlendText;
+    }
+
+    static bool HasObject(DrawOp op)
+    {
+        return HasText(op) || op == DrawOp::Sprite || op == DrawOp::TransparentSprite || op == DrawOp::FlashImage ||
+               op == DrawOp::SpriteRegion || op == DrawOp::TransformedFlashImage || op == DrawOp::TransformedSprite ||
+               op == DrawOp::Callback;
+    }
+
+    static DrawCommand Decode(const uint8_t *in)
+    {
+        RecordHeader header;
+        memcpy(&header, in, sizeof(header));
+        in += sizeof(header);
+
+        DrawCommand command;
+        command.op = header.op;
+        command.argCount = header.argCount;
+        command.color = header.color;
+        command.bounds = DirtyRect(header.bounds[0], header.bounds[1], header.bounds[2], header.bounds[3]);
+        memcpy(command.args, in, header.argCount * sizeof(int32_t));
+        in += header.argCount * sizeof(int32_t);
+
+        command.object = nullptr;
+        command.callback = nullptr;
+        command.scaleX = 1.0f;
+        command.scaleY = 1.0f;
+        if (HasObject(header.op))
+        {
+            RecordObject object;
+            memcpy(&object, in, sizeof(object));
+            in += sizeof(object);
+            command.object = object.object;
+            command.callback = object.callback;
+            command.scaleX = object.scaleX;
+            command.scaleY = object.scaleY;
+        }
+        command.text = reinterpret_cast<const char *>(in);
+        command.textLength = header.textLength;
+        return command;
+    }
+};
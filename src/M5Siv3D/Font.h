@@ -1,6 +1,6 @@
 #pragma once
 
-#include <M5Unified.h>
+#include "Platform.h"
 #include "Color.h"
 #include "Shapes.h"
 #include "System.h"
@@ -57,35 +57,28 @@ struct Font
 
     void draw(const String &text, int x, int y, const Color &color = Palette::White)
     {
-        auto &canvas = System::getInstance().getCanvas();
-        canvas.setTextColor(color.toRGB565());
-        canvas.setFont(m_fontPtr);
-        canvas.setTextSize(m_size);
+        M5SIV3D_PROFILE_SCOPE("Font::draw");
+        System::getInstance().getCanvas().setTextColor(color.toRGB565());
+        const DirtyRect bounds = layout(text, x, y);
+        System::Submit(DrawCommand::Text(text.c_str(), bounds.x, bounds.y, m_fontPtr, m_size, color.toRGB565(), bounds));
+    }
 
-        // 水平方向のアライメント処理
-        int actualX = x;
-        if (hAlign != HorizontalAlign::Left)
+    // 描画先と合成して描く
+    void draw(const String &text, int x, int y, const ColorA &color, BlendMode mode = BlendMode::Alpha)
+    {
+        if (Blend::IsOpaque(color.a, mode))
         {
-            int w = textWidth(text);
-            if (hAlign == HorizontalAlign::Center)
-                actualX = x - (w / 2);
-            else if (hAlign == HorizontalAlign::Right)
-                actualX = x - w;
+            draw(text, x, y, color.rgb());
+            return;
         }
-
-        // 垂直方向のアライメント処理
-        int actualY = y;
-        if (vAlign != VerticalAlign::Baseline)
+        if (Blend::IsInvisible(color.a))
         {
-            int h = textHeight();
-            if (vAlign == VerticalAlign::Center)
-                actualY = y - (h / 2) / 2;
-            else if (vAlign == VerticalAlign::Bottom)
-                actualY = y - h;
-            // Top alignment uses the original y position
+            return;
         }
-
-        canvas.drawString(text, actualX, actualY);
+        M5SIV3D_PROFILE_SCOPE("Font::draw");
+        const DirtyRect bounds = layout(text, x, y);
+        System::Submit(DrawCommand::BlendText(text.c_str(), bounds.x, bounds.y, m_fontPtr, m_size,
+                                              color.toRGB565(), color.a, mode, bounds));
     }
 
     // 描画位置を指定するための構造体
@@ -125,4 +118,39 @@ struct Font
     {
         return setHorizontalAlign(static_cast<HorizontalAlign>(a));
     }
+
+private:
+    // アライメントを反映した描画範囲 (左上が描画位置)
+    DirtyRect layout(const String &text, int x, int y) const
+    {
+        auto &canvas = System::getInstance().getCanvas();
+        canvas.setFont(m_fontPtr);
+        canvas.setTextSize(m_size);
+
+        // 水平方向のアライメント処理
+        int actualX = x;
+        if (hAlign != HorizontalAlign::Left)
+        {
+            int w = textWidth(text);
+            if (hAlign == HorizontalAlign::Center)
+                actualX = x - (w / 2);
+            else if (hAlign == HorizontalAlign::Right)
+                actualX = x - w;
+        }
+
+        // 垂直方向のアライメント処理
+        int actualY = y;
+        if (vAlign != VerticalAlign::Baseline)
+        {
+            int h = textHeight();
+            if (vAlign == VerticalAlign::Center)
+                actualY = y - (h / 2) / 2;
+            else if (vAlign == VerticalAlign::Bottom)
+                actualY = y - h;
+            // Top alignment uses the original y position
+        }
+
+        // キャンバスのフォント情報は文字サイズ込みの値を返す
+        return DirtyRect(actualX, actualY, canvas.textWidth(text), canvas.fontHeight());
+    }
 }; 
\ No newline at end of file
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Platform.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <algorithm>
+
+// フレーム内の処理区間
+enum class FramePhase : uint8_t
+{
+    Draw,    // ユーザーの描画処理 (beginDraw の画面クリアを含む)
+    Present, // endDraw による画面への転送
+    Input,   // InputManager::update による入力の更新
+    Idle,    // 次のフレームの予定時刻までの待機
+    Total,   // フレーム全体
+};
+
+// 1 フレーム分の処理時間 (μs)
+struct FrameTiming
+{
+    static constexpr size_t PhaseCount = 5;
+
+    uint32_t micros[PhaseCount];
+
+    FrameTiming() : micros{} {}
+
+    uint32_t &operator[](FramePhase phase) { return micros[static_cast<size_t>(phase)]; }
+    uint32_t operator[](FramePhase phase) const { return micros[static_cast<size_t>(phase)]; }
+};
+
+// 区間ごとの集計結果 (μs)
+struct PhaseStats
+{
+    uint32_t min;
+    uint32_t avg;
+    uint32_t max;
+    uint32_t p99;
+};
+
+// 直近のフレームの処理時間をリングバッファに記録し、区間ごとに集計する
+// 遅いフレームが転送 (SPI)、描画 (CPU)、入力のどれに時間を取られているかを切り分けるために使う
+class FrameProfiler
+{
+public:
+    static constexpr size_t Capacity = 120;
+
+    void record(const FrameTiming &timing)
+    {
+        m_frames[m_head] = timing;
+        m_head = (m_head + 1) % Capacity;
+        if (m_count < Capacity)
+        {
+            ++m_count;
+        }
+    }
+
+    void clear()
+    {
+        m_head = 0;
+        m_count = 0;
+    }
+
+    // 記録済みのフレーム数
+    size_t size() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+
+    // 古い順に index 番目のフレーム
+    const FrameTiming &operator[](size_t index) const
+    {
+        return m_frames[(m_head + Capacity - m_count + index) % Capacity];
+    }
+
+    // 最後に記録したフレーム
+    const FrameTiming &latest() const
+    {
+        return (*this)[m_count ? m_count - 1 : 0];
+    }
+
+    // 区間の最小・平均・最大・99 パーセンタイル
+    PhaseStats stats(FramePhase phase) const
+    {
+        PhaseStats result = {0, 0, 0, 0};
+        if (m_count == 0)
+        {
+            return result;
+        }
+
+        uint32_t values[Capacity];
+        uint64_t sum = 0;
+        for (size_t i = 0; i < m_count; ++i)
+        {
+            values[i] = (*this)[i][phase];
+            sum += values[i];
+        }
+
+        result.min = *std::min_element(values, values + m_count);
+        result.max = *std::max_element(values, values + m_count);
+        result.avg = uint32_t(sum / m_count);
+
+        // 上位 1% を除いた最大値 (nearest-rank 法)
+        const size_t rank = (m_count * 99 + 99) / 100 - 1;
+        std::nth_element(values, values + rank, values + m_count);
+        result.p99 = values[rank];
+        return result;
+    }
+
+    // 区間名 (表示用)
+    static const char *PhaseName(FramePhase phase)
+    {
+        switch (phase)
+        {
+        case FramePhase::Draw:
+            return "draw";
+        case FramePhase::Present:
+            return "present";
+        case FramePhase::Input:
+            return "input";
+        case FramePhase::Idle:
+            return "idle";
+        default:
+            return "total";
+        }
+    }
+
+    // 集計結果をテキストで出力する (シリアルでの現地調査用)
+    void report(Stream &stream) const
+    {
+        stream.printf("frames: %u (us) min/avg/max/p99\n", unsigned(m_count));
+        for (size_t i = 0; i < FrameTiming::PhaseCount; ++i)
+        {
+            const FramePhase phase = static_cast<FramePhase>(i);
+            const PhaseStats s = stats(phase);
+            stream.printf("%-8s %6u %6u %6u %6u\n", PhaseName(phase),
+                          unsigned(s.min), unsigned(s.avg), unsigned(s.max), unsigned(s.p99));
+        }
+    }
+
+private:
+    FrameTiming m_frames[Capacity];
+    size_t m_head = 0;
+    size_t m_count = 0;
+};
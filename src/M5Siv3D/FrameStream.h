@@ -0,0 +1,291 @@
+#pragma once
+
+#include "Platform.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <algorithm>
+#include <vector>
+
+// 画面の圧縮転送 (スクリーンショットとフレームのストリーミング)
+//
+// RGB565 の画素を連長圧縮してシリアルなどに書き出す。
+// キーフレームは画面全体、差分フレームは前回送ったときから変化した 16x16 のタイルだけを送る。
+// 出力は tools/frame_stream_decode.py で画像に変換できる。
+//
+// 出力形式 (値はリトルエンディアン、画素は RGB565)
+//
+//   "M5FS" u8:version u8:type(0=キー 1=差分) u16:width u16:height u8:tileSize u8:0 u32:frameIndex
+//   キー: width × height 画素分の連長圧縮 (左上から行順)
+//   差分: { u16:tileIndex, タイルの画素の連長圧縮 } を繰り返し、u16:0xFFFF で終わる
+//         (tileIndex は左上から行順に数えたタイルの番号。画面端のタイルははみ出さない大きさになる)
+//   u16:checksum (先頭からの Fletcher-16)
+//
+// 連長圧縮は 1 バイトの見出しに続けて画素を置く
+//   0x00-0x7F: 続く (n + 1) 画素をそのまま並べる
+//   0x80-0xFF: 続く 1 画素を ((n & 0x7F) + 2) 回繰り返す
+class FrameStreamEncoder
+{
+public:
+    static constexpr uint8_t FormatVersion = 1;
+    static constexpr int32_t TileSize = 16;
+    static constexpr uint16_t EndOfTiles = 0xFFFF;
+
+    enum class FrameType : uint8_t
+    {
+        Key = 0,
+        Delta = 1,
+    };
+
+    // フレームの大きさを設定する (変わった場合は次のフレームをキーフレームにする)
+    void setSize(int32_t width, int32_t height)
+    {
+        if (width == m_width && height == m_height)
+        {
+            return;
+        }
+        m_width = width;
+        m_height = height;
+        m_tilesX = (width + TileSize - 1) / TileSize;
+        m_tileHashes.assign(size_t(m_tilesX) * size_t((height + TileSize - 1) / TileSize), 0);
+        m_hasReference = false;
+    }
+
+    // 差分の基準になるフレームを送ったかどうか
+    bool hasReference() const { return m_hasReference; }
+
+    // 次のフレームをキーフレームにする
+    void reset() { m_hasReference = false; }
+
+    // フレームの書き出しを開始する
+    // 差分フレームで変化したタイルがなければ、何も書き出さない
+    void beginFrame(Stream &stream, FrameType type, uint32_t frameIndex)
+    {
+        m_stream = &stream;
+        m_type = (type == FrameType::Delta && m_hasReference) ? FrameType::Delta : FrameType::Key;
+        m_frameIndex = frameIndex;
+        m_frameBytes = 0;
+        m_tileCount = 0;
+        m_headerWritten = false;
+        m_sum1 = 0;
+        m_sum2 = 0;
+        if (m_type == FrameType::Key)
+        {
+            writeHeader();
+        }
+    }
+
+    // y 行目から rows 行 (TileSize 行ごと、最後だけ短い) の画素を渡す
+    // pixels はキャンバスのバッファと同じバイト順、stride は 1 行の画素数
+    void addTileRow(int32_t y, const uint16_t *pixels, int32_t stride, int32_t rows)
+    {
+        const int32_t tileY = y / TileSize;
+        for (int32_t tx = 0; tx < m_tilesX; ++tx)
+        {
+            const int32_t x = tx * TileSize;
+            const int32_t tw = std::min(int32_t(TileSize), m_width - x);
+            const size_t tileIndex = size_t(tileY) * size_t(m_tilesX) + size_t(tx);
+            const uint32_t hash = tileHash(pixels + x, stride, tw, rows);
+            const bool changed = (hash != m_tileHashes[tileIndex]);
+            m_tileHashes[tileIndex] = hash;
+
+            if (m_type == FrameType::Delta && changed)
+            {
+                if (!m_headerWritten)
+                {
+                    writeHeader();
+                }
+                putU16(uint16_t(tileIndex));
+                for (int32_t row = 0; row < rows; ++row)
+                {
+                    pushPixels(pixels + size_t(row) * stride + x, tw);
+                }
+                finishRuns();
+                ++m_tileCount;
+            }
+        }
+
+        if (m_type == FrameType::Key)
+        {
+            for (int32_t row = 0; row < rows; ++row)
+            {
+                pushPixels(pixels + size_t(row) * stride, m_width);
+            }
+            m_tileCount += uint32_t(m_tilesX);
+        }
+    }
+
+    // フレームの書き出しを終える
+    void endFrame()
+    {
+        if (m_type == FrameType::Key)
+        {
+            finishRuns();
+        }
+        else if (m_headerWritten)
+        {
+            putU16(EndOfTiles);
+        }
+        else
+        {
+            return;
+        }
+
+        const uint16_t checksum = uint16_t((m_sum2 << 8) | m_sum1);
+        putU16(checksum);
+        flush();
+        m_hasReference = true;
+    }
+
+    // 直前のフレームで書き出したバイト数 (差分がなく書き出さなかった場合は 0)
+    size_t lastFrameBytes() const { return m_frameBytes; }
+
+    // 直前のフレームで送ったタイルの数 (キーフレームでは全タイル)
+    uint32_t lastTileCount() const { return m_tileCount; }
+
+    FrameType lastFrameType() const { return m_type; }
+
+private:
+    static constexpr size_t BufferSize = 128;
+    static constexpr int32_t MaxLiteral = 128;
+    static constexpr int32_t MaxRun = 129;
+
+    int32_t m_width = 0;
+    int32_t m_height = 0;
+    int32_t m_tilesX = 0;
+    std::vector<uint32_t> m_tileHashes;
+    bool m_hasReference = false;
+
+    Stream *m_stream = nullptr;
+    FrameType m_type = FrameType::Key;
+    uint32_t m_frameIndex = 0;
+    bool m_headerWritten = false;
+    size_t m_frameBytes = 0;
+    uint32_t m_tileCount = 0;
+
+    // 出力のまとめ書き用
+    uint8_t m_buffer[BufferSize];
+    size_t m_bufferSize = 0;
+    uint32_t m_sum1 = 0;
+    uint32_t m_sum2 = 0;
+
+    // 連長圧縮の途中の状態
+    uint16_t m_literal[MaxLiteral];
+    int32_t m_literalCount = 0;
+    uint16_t m_runValue = 0;
+    int32_t m_runCount = 0;
+
+    void writeHeader()
+    {
+        const uint8_t header[8] = {'M', '5', 'F', 'S', FormatVersion, uint8_t(m_type),
+                                   uint8_t(m_width), uint8_t(m_width >> 8)};
+        for (uint8_t byte : header)
+        {
+            put(byte);
+        }
+        putU16(uint16_t(m_height));
+        put(uint8_t(TileSize));
+        put(0);
+        putU16(uint16_t(m_frameIndex));
+        putU16(uint16_t(m_frameIndex >> 16));
+        m_headerWritten = true;
+    }
+
+    // キャンバスのバッファはバイトを入れ替えた RGB565 なので、元に戻してから圧縮する
+    void pushPixels(const uint16_t *pixels, int32_t count)
+    {
+        for (int32_t i = 0; i < count; ++i)
+        {
+            const uint16_t pixel = uint16_t((pixels[i] >> 8) | (pixels[i] << 8));
+            if (m_runCount > 0 && pixel == m_runValue && m_runCount < MaxRun)
+            {
+                ++m_runCount;
+                continue;
+            }
+            closeRun();
+            m_runValue = pixel;
+            m_runCount = 1;
+        }
+    }
+
+    // 連続した画素が 2 つ以上なら繰り返しとして書き出し、1 つなら並べる画素に加える
+    void closeRun()
+    {
+        if (m_runCount >= 2)
+        {
+            flushLiteral();
+            put(uint8_t(0x80 | (m_runCount - 2)));
+            putU16(m_runValue);
+        }
+        else if (m_runCount == 1)
+        {
+            m_literal[m_literalCount++] = m_runValue;
+            if (m_literalCount == MaxLiteral)
+            {
+                flushLiteral();
+            }
+        }
+        m_runCount = 0;
+    }
+
+    void flushLiteral()
+    {
+        if (m_literalCount == 0)
+        {
+            return;
+        }
+        put(uint8_t(m_literalCount - 1));
+        for (int32_t i = 0; i < m_literalCount; ++i)
+        {
+            putU16(m_literal[i]);
+        }
+        m_literalCount = 0;
+    }
+
+    void finishRuns()
+    {
+        closeRun();
+        flushLiteral();
+    }
+
+    void put(uint8_t byte)
+    {
+        m_sum1 = (m_sum1 + byte) % 255;
+        m_sum2 = (m_sum2 + m_sum1) % 255;
+        m_buffer[m_bufferSize++] = byte;
+        if (m_bufferSize == BufferSize)
+        {
+            flush();
+        }
+    }
+
+    void putU16(uint16_t value)
+    {
+        put(uint8_t(value));
+        put(uint8_t(value >> 8));
+    }
+
+    void flush()
+    {
+        if (m_bufferSize)
+        {
+            m_stream->write(m_buffer, m_bufferSize);
+            m_frameBytes += m_bufferSize;
+            m_bufferSize = 0;
+        }
+    }
+
+    // タイルの内容のハッシュ (FNV-1a)
+    static uint32_t tileHash(const uint16_t *pixels, int32_t stride, int32_t tw, int32_t th)
+    {
+        uint32_t hash = 2166136261u;
+        for (int32_t y = 0; y < th; ++y)
+        {
+            const uint16_t *row = pixels + size_t(y) * stride;
+            for (int32_t x = 0; x < tw; ++x)
+            {
+                hash = (hash ^ row[x]) * 16777619u;
+            }
+        }
+        return hash;
+    }
+};
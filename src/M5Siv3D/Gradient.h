@@ -0,0 +1,237 @@
+#pragma once
+
+#include "Platform.h"
+#include "Math.h"
+#include "Color.h"
+#include "DirtyRegion.h"
+#include <stdint.h>
+#include <algorithm>
+
+// グラデーション
+// 図形の外接矩形を基準に色を変化させる
+//
+//   Rect(10, 10, 200, 20).draw(Gradient::Horizontal(Palette::Green, Palette::Red));
+//   Circle(160, 120, 50).draw(Gradient::Radial(Palette::White, Palette::Blue));
+struct Gradient
+{
+    enum class Type : uint8_t
+    {
+        Linear, // 角度の方向に from から to へ
+        Radial, // 中心の from から外側の to へ
+    };
+
+    Color from;
+    Color to;
+    Type type;
+    float angle; // Linear の向き (度、0 で左から右、90 で上から下)
+
+    constexpr Gradient(const Color &_from, const Color &_to, Type _type, float _angle = 0.0f)
+        : from(_from), to(_to), type(_type), angle(_angle) {}
+
+    // 左から右へ
+    static constexpr Gradient Horizontal(const Color &left, const Color &right)
+    {
+        return Gradient(left, right, Type::Linear, 0.0f);
+    }
+
+    // 上から下へ
+    static constexpr Gradient Vertical(const Color &top, const Color &bottom)
+    {
+        return Gradient(top, bottom, Type::Linear, 90.0f);
+    }
+
+    // angle 度の方向へ (外接矩形の角から反対の角までで from から to に変わる)
+    static constexpr Gradient Linear(const Color &from, const Color &to, float angle)
+    {
+        return Gradient(from, to, Type::Linear, angle);
+    }
+
+    // 外接矩形の中心から、長い辺の半分の距離までで center から edge に変わる
+    static constexpr Gradient Radial(const Color &center, const Color &edge)
+    {
+        return Gradient(center, edge, Type::Radial, 0.0f);
+    }
+
+    // 描画命令の引数 (from, to, 種類と角度) に詰める
+    void encode(int32_t *args) const
+    {
+        args[0] = int32_t((uint32_t(from.r) << 16) | (uint32_t(from.g) << 8) | from.b);
+        args[1] = int32_t((uint32_t(to.r) << 16) | (uint32_t(to.g) << 8) | to.b);
+        // 角度は 1/256 度単位
+        const float wrapped = angle - 360.0f * Math::floor(angle / 360.0f);
+        args[2] = (int32_t(wrapped * 256.0f + 0.5f) << 8) | int32_t(type);
+    }
+
+    static Gradient Decode(const int32_t *args)
+    {
+        return Gradient(Color(uint8_t(args[0] >> 16), uint8_t(args[0] >> 8), uint8_t(args[0])),
+                        Color(uint8_t(args[1] >> 16), uint8_t(args[1] >> 8), uint8_t(args[1])),
+                        Type(args[2] & 0xFF), (args[2] >> 8) / 256.0f);
+    }
+};
+
+// グラデーションの区間の塗り (Blend::FillRect などの Painter)
+//
+// 色は 256 段階の表にしておき、区間の中では表の位置を固定小数点で 1 画素ずつ進める。
+// 表は最近使った RampCacheSize 組の色の分を保持し、毎フレーム同じグラデーションを描く場合は作り直さない。
+// Linear は位置が画素ごとに一定量ずつ変わり、Radial は中心からの距離の 2 乗を差分で更新して
+// 整数の平方根も前の画素の値から少しだけ動かして求める。
+class GradientPainter
+{
+public:
+    static constexpr int32_t RampSize = 256;
+    static constexpr size_t RampCacheSize = 4;
+
+    // bounds は描画先の座標での図形の外接矩形
+    GradientPainter(const Gradient &gradient, const DirtyRect &bounds)
+        : m_type(gradient.type), m_ramp(FindRamp(gradient.from, gradient.to))
+    {
+        if (m_type == Gradient::Type::Radial)
+        {
+            // 座標は 1/16 画素単位
+            m_centerX = bounds.x * 16 + (bounds.w - 1) * 8;
+            m_centerY = bounds.y * 16 + (bounds.h - 1) * 8;
+            m_radius = std::max<int32_t>(1, std::max(bounds.w, bounds.h) * 8);
+            m_indexScale = uint32_t((uint32_t(RampSize) << 16) / uint32_t(m_radius));
+            return;
+        }
+
+        // 外接矩形の角 (画素の中心) を向きに射影した範囲で 0-1 にする
+        const float radians = Math::ToRadians(gradient.angle);
+        const float dx = Math::cos(radians);
+        const float dy = Math::sin(radians);
+        const float x0 = float(bounds.x), x1 = float(bounds.x + bounds.w - 1);
+        const float y0 = float(bounds.y), y1 = float(bounds.y + bounds.h - 1);
+        const float p00 = x0 * dx + y0 * dy, p10 = x1 * dx + y0 * dy;
+        const float p01 = x0 * dx + y1 * dy, p11 = x1 * dx + y1 * dy;
+        const float minimum = std::min(std::min(p00, p10), std::min(p01, p11));
+        const float length = std::max(std::max(p00, p10), std::max(p01, p11)) - minimum;
+        // 位置は 24 ビットの小数部を持つ固定小数点 (1 << 24 で to)
+        const float scale = (length > 0.0f) ? 16777216.0f / length : 0.0f;
+        m_originX = bounds.x;
+        m_originY = bounds.y;
+        m_stepX = int32_t(dx * scale);
+        m_stepY = dy * scale;
+        m_offset = (p00 - minimum) * scale;
+    }
+
+    bool readsTarget() const { return false; }
+
+    void paint(lgfx::swap565_t *pixels, int32_t x, int32_t y, int32_t count) const
+    {
+        if (m_type == Gradient::Type::Radial)
+        {
+            paintRadial(pixels, x, y, count);
+            return;
+        }
+
+        // 行の先頭だけ浮動小数点で求め、その後は整数で進める
+        // 外接矩形からの相対位置で求めるので、帯ごとに描画しても結果は変わらない
+        int32_t position = int32_t((y - m_originY) * m_stepY + m_offset) + (x - m_originX) * m_stepX;
+        for (int32_t i = 0; i < count; ++i)
+        {
+            pixels[i].raw = m_ramp[Clamp(position >> 16)];
+            position += m_stepX;
+        }
+    }
+
+private:
+    struct Ramp
+    {
+        uint32_t from = 0; // RGB888 (未使用の場合は to が 0xFFFFFFFF)
+        uint32_t to = 0xFFFFFFFFu;
+        uint16_t colors[RampSize]; // キャンバスと同じバイト順の RGB565
+    };
+
+    Gradient::Type m_type;
+    const uint16_t *m_ramp;
+
+    // Linear (位置は 1 << 24 で to)
+    int32_t m_originX = 0;
+    int32_t m_originY = 0;
+    int32_t m_stepX = 0;
+    float m_stepY = 0.0f;
+    float m_offset = 0.0f; // 外接矩形の左上の位置
+
+    // Radial (1/16 画素単位)
+    int32_t m_centerX = 0;
+    int32_t m_centerY = 0;
+    int32_t m_radius = 1;
+    uint32_t m_indexScale = 0;
+
+    static int32_t Clamp(int32_t index)
+    {
+        return std::min(RampSize - 1, std::max<int32_t>(0, index));
+    }
+
+    // from から to への表 (なければ一番古いものを作り直す)
+    static const uint16_t *FindRamp(const Color &from, const Color &to)
+    {
+        static Ramp cache[RampCacheSize];
+        static size_t next = 0;
+
+        const uint32_t fromKey = (uint32_t(from.r) << 16) | (uint32_t(from.g) << 8) | from.b;
+        const uint32_t toKey = (uint32_t(to.r) << 16) | (uint32_t(to.g) << 8) | to.b;
+        for (Ramp &ramp : cache)
+        {
+            if (ramp.from == fromKey && ramp.to == toKey)
+            {
+                return ramp.colors;
+            }
+        }
+
+        Ramp &ramp = cache[next];
+        next = (next + 1) % RampCacheSize;
+        ramp.from = fromKey;
+        ramp.to = toKey;
+        BuildRamp(from, to, ramp.colors);
+        return ramp.colors;
+    }
+
+    // 各成分を 16 ビットの小数部を持つ固定小数点で少しずつ変えて表を作る
+    static void BuildRamp(const Color &from, const Color &to, uint16_t *ramp)
+    {
+        int32_t r = int32_t(from.r) << 16, g = int32_t(from.g) << 16, b = int32_t(from.b) << 16;
+        const int32_t dr = (int32_t(to.r) - from.r) * 65536 / (RampSize - 1);
+        const int32_t dg = (int32_t(to.g) - from.g) * 65536 / (RampSize - 1);
+        const int32_t db = (int32_t(to.b) - from.b) * 65536 / (RampSize - 1);
+        for (int32_t i = 0; i < RampSize; ++i)
+        {
+            // 四捨五入 (最後の段階で割り切れない分の誤差が to に残らないようにする)
+            const Color color(uint8_t((r + 0x8000) >> 16), uint8_t((g + 0x8000) >> 16), uint8_t((b + 0x8000) >> 16));
+            ramp[i] = Color::SwapBytes(color.toRGB565());
+            r += dr;
+            g += dg;
+            b += db;
+        }
+        ramp[RampSize - 1] = Color::SwapBytes(to.toRGB565());
+    }
+
+    void paintRadial(lgfx::swap565_t *pixels, int32_t x, int32_t y, int32_t count) const
+    {
+        // 中心からの距離 (1/16 画素単位) の 2 乗と、その整数の平方根
+        int64_t dx = int64_t(x) * 16 - m_centerX;
+        const int64_t dy = int64_t(y) * 16 - m_centerY;
+        int64_t distance2 = dx * dx + dy * dy;
+        int64_t distance = int64_t(Math::sqrt(float(distance2)));
+        const int64_t radius = m_radius;
+
+        for (int32_t i = 0; i < count; ++i)
+        {
+            // 隣の画素では距離は最大 16 しか変わらないので、前の値から合わせ直す
+            while (distance * distance > distance2)
+            {
+                --distance;
+            }
+            while ((distance + 1) * (distance + 1) <= distance2)
+            {
+                ++distance;
+            }
+            pixels[i].raw = (distance >= radius) ? m_ramp[RampSize - 1]
+                                                 : m_ramp[Clamp(int32_t((uint32_t(distance) * m_indexScale) >> 16))];
+            // (dx + 16)² = dx² + 32dx + 256
+            distance2 += 32 * dx + 256;
+            dx += 16;
+        }
+    }
+};
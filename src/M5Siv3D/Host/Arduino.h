@@ -0,0 +1,344 @@
+#pragma once
+
+// ホスト(native)ビルド用の Arduino 互換レイヤー
+// M5Siv3D が利用する範囲(時間・String・Serial)だけを標準 C++ で実装する
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdarg>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+// Arduino.h (ESP32) と同様に std の関数をグローバルに公開する
+using std::abs;
+using std::max;
+using std::min;
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace Host
+{
+    // 時間の供給源
+    // 既定では実時間、テストでは仮想時間に切り替えて delay() を即座に進められる
+    class Clock
+    {
+    public:
+        static Clock &getInstance()
+        {
+            static Clock instance;
+            return instance;
+        }
+
+        uint64_t nowMicros() const
+        {
+            if (m_virtual)
+            {
+                return m_virtualMicros;
+            }
+            auto elapsed = std::chrono::steady_clock::now() - m_origin;
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        }
+
+        void sleepMicros(uint64_t us)
+        {
+            if (m_virtual)
+            {
+                m_virtualMicros += us;
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(us));
+        }
+
+        // 仮想時間モード (delay で待たずに時刻だけ進める)
+        void setVirtual(bool enabled)
+        {
+            if (enabled && !m_virtual)
+            {
+                m_virtualMicros = nowMicros();
+            }
+            m_virtual = enabled;
+        }
+
+        bool isVirtual() const { return m_virtual; }
+
+        // 仮想時間を進める (描画処理にかかった時間の模擬など)
+        void advanceMicros(uint64_t us)
+        {
+            if (m_virtual)
+            {
+                m_virtualMicros += us;
+            }
+        }
+
+    private:
+        Clock() : m_origin(std::chrono::steady_clock::now()) {}
+
+        std::chrono::steady_clock::time_point m_origin;
+        bool m_virtual = false;
+        uint64_t m_virtualMicros = 0;
+    };
+}
+
+inline unsigned long micros()
+{
+    return static_cast<unsigned long>(static_cast<uint32_t>(Host::Clock::getInstance().nowMicros()));
+}
+
+inline unsigned long millis()
+{
+    return static_cast<unsigned long>(static_cast<uint32_t>(Host::Clock::getInstance().nowMicros() / 1000));
+}
+
+inline void delay(uint32_t ms)
+{
+    Host::Clock::getInstance().sleepMicros(uint64_t(ms) * 1000);
+}
+
+inline void delayMicroseconds(uint32_t us)
+{
+    Host::Clock::getInstance().sleepMicros(us);
+}
+
+// Arduino の String クラス互換 (std::string のラッパー)
+class String
+{
+public:
+    String() = default;
+    String(const char *s) : m_str(s ? s : "") {}
+    String(const std::string &s) : m_str(s) {}
+    String(char c) : m_str(1, c) {}
+    String(int value, unsigned char base = 10) : m_str(fromInteger(value, base)) {}
+    String(unsigned int value, unsigned char base = 10) : m_str(fromInteger(value, base)) {}
+    String(long value, unsigned char base = 10) : m_str(fromInteger(value, base)) {}
+    String(unsigned long value, unsigned char base = 10) : m_str(fromInteger(value, base)) {}
+    String(float value, unsigned int decimalPlaces = 2) : m_str(fromFloat(value, decimalPlaces)) {}
+    String(double value, unsigned int decimalPlaces = 2) : m_str(fromFloat(value, decimalPlaces)) {}
+
+    const char *c_str() const { return m_str.c_str(); }
+    unsigned int length() const { return static_cast<unsigned int>(m_str.size()); }
+    bool isEmpty() const { return m_str.empty(); }
+
+    char operator[](unsigned int index) const { return index < m_str.size() ? m_str[index] : '\0'; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+
+    String &operator+=(const String &rhs)
+    {
+        m_str += rhs.m_str;
+        return *this;
+    }
+    String &operator+=(const char *rhs)
+    {
+        m_str += rhs;
+        return *this;
+    }
+    String &operator+=(char c)
+    {
+        m_str += c;
+        return *this;
+    }
+
+    bool operator==(const String &rhs) const { return m_str == rhs.m_str; }
+    bool operator!=(const String &rhs) const { return m_str != rhs.m_str; }
+    bool operator==(const char *rhs) const { return m_str == rhs; }
+
+    friend String operator+(const String &lhs, const String &rhs) { return String(lhs.m_str + rhs.m_str); }
+    friend String operator+(const String &lhs, const char *rhs) { return String(lhs.m_str + rhs); }
+    friend String operator+(const char *lhs, const String &rhs) { return String(lhs + rhs.m_str); }
+
+private:
+    template <typename T>
+    static std::string fromInteger(T value, unsigned char base)
+    {
+        if (base == 10)
+        {
+            return std::to_string(value);
+        }
+        char buf[66];
+        char *p = buf + sizeof(buf) - 1;
+        *p = '\0';
+        unsigned long long v = static_cast<unsigned long long>(value);
+        do
+        {
+            *--p = "0123456789abcdefghijklmnopqrstuvwxyz"[v % base];
+            v /= base;
+        } while (v);
+        return std::string(p);
+    }
+
+    static std::string fromFloat(double value, unsigned int decimalPlaces)
+    {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%.*f", static_cast<int>(decimalPlaces), value);
+        return std::string(buf);
+    }
+
+    std::string m_str;
+};
+
+// Arduino の Print / Stream 互換
+class Print
+{
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t c) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size--)
+        {
+            n += write(*buffer++);
+        }
+        return n;
+    }
+
+    size_t write(const char *str) { return str ? write(reinterpret_cast<const uint8_t *>(str), std::strlen(str)) : 0; }
+
+    size_t print(const char *str) { return write(str); }
+    size_t print(const String &str) { return write(str.c_str()); }
+    size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+    size_t print(int value) { return print(String(value)); }
+    size_t print(unsigned int value) { return print(String(value)); }
+    size_t print(long value) { return print(String(value)); }
+    size_t print(unsigned long value) { return print(String(value)); }
+    size_t print(double value, int digits = 2) { return print(String(value, digits)); }
+
+    template <typename T>
+    size_t println(const T &value)
+    {
+        size_t n = print(value);
+        return n + println();
+    }
+    size_t println() { return write("\r\n"); }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char buf[256];
+        va_list args;
+        va_start(args, format);
+        int len = std::vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        if (len < 0)
+        {
+            return 0;
+        }
+        if (static_cast<size_t>(len) < sizeof(buf))
+        {
+            return write(reinterpret_cast<const uint8_t *>(buf), len);
+        }
+        std::vector<char> large(len + 1);
+        va_start(args, format);
+        std::vsnprintf(large.data(), large.size(), format, args);
+        va_end(args);
+        return write(reinterpret_cast<const uint8_t *>(large.data()), len);
+    }
+
+    virtual void flush() {}
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    size_t readBytes(uint8_t *buffer, size_t length)
+    {
+        size_t count = 0;
+        while (count < length)
+        {
+            int c = read();
+            if (c < 0)
+            {
+                break;
+            }
+            buffer[count++] = static_cast<uint8_t>(c);
+        }
+        return count;
+    }
+};
+
+namespace Host
+{
+    // メモリ上のストリーム (テストで Serial の代わりに使う)
+    class MemoryStream : public Stream
+    {
+    public:
+        using Stream::write;
+
+        size_t write(uint8_t c) override
+        {
+            m_data.push_back(c);
+            return 1;
+        }
+
+        size_t write(const uint8_t *buffer, size_t size) override
+        {
+            m_data.insert(m_data.end(), buffer, buffer + size);
+            return size;
+        }
+
+        int available() override { return static_cast<int>(m_data.size() - m_readPos); }
+        int read() override { return m_readPos < m_data.size() ? m_data[m_readPos++] : -1; }
+        int peek() override { return m_readPos < m_data.size() ? m_data[m_readPos] : -1; }
+
+        const std::vector<uint8_t> &data() const { return m_data; }
+
+        void clear()
+        {
+            m_data.clear();
+            m_readPos = 0;
+        }
+
+    private:
+        std::vector<uint8_t> m_data;
+        size_t m_readPos = 0;
+    };
+}
+
+// 標準出力に流すシリアルポート
+class HardwareSerial : public Stream
+{
+public:
+    using Stream::write;
+
+    void begin(unsigned long) {}
+    void end() {}
+
+    size_t write(uint8_t c) override
+    {
+        std::fputc(c, stdout);
+        return 1;
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override
+    {
+        return std::fwrite(buffer, 1, size, stdout);
+    }
+
+    int available() override { return m_input.available(); }
+    int read() override { return m_input.read(); }
+    int peek() override { return m_input.peek(); }
+    void flush() override { std::fflush(stdout); }
+
+    // テストから受信データを注入する
+    void hostInject(const char *text) { m_input.write(text); }
+
+    explicit operator bool() const { return true; }
+
+private:
+    Host::MemoryStream m_input;
+};
+
+inline HardwareSerial Serial;
+inline HardwareSerial Serial2;
@@ -0,0 +1,1096 @@
+#pragma once
+
+// ホスト(native)ビルド用の LovyanGFX / M5GFX 互換レイヤー
+// キャンバスもディスプレイもメモリ上の RGB565 バッファとして実装する
+// 画素はデバイスと同じくバイトスワップした RGB565 で格納する
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "Arduino.h"
+
+// 主要な色の定数 (RGB565)
+static constexpr uint16_t TFT_BLACK = 0x0000;
+static constexpr uint16_t TFT_WHITE = 0xFFFF;
+static constexpr uint16_t TFT_RED = 0xF800;
+static constexpr uint16_t TFT_GREEN = 0x07E0;
+static constexpr uint16_t TFT_BLUE = 0x001F;
+
+namespace lgfx
+{
+    // バイトスワップ済み RGB565 (スプライト内部の画素形式)
+    struct swap565_t
+    {
+        uint16_t raw;
+    };
+
+    inline uint16_t swap16(uint16_t v)
+    {
+        return static_cast<uint16_t>((v << 8) | (v >> 8));
+    }
+
+    // RGB565 と RGB888 の変換 (LovyanGFX の colortype.hpp と同じ名前)
+    constexpr uint16_t convert_rgb888_to_rgb565(uint32_t c)
+    {
+        return static_cast<uint16_t>(((c >> 8) & 0xF800) | ((c >> 5) & 0x07E0) | ((c >> 3) & 0x001F));
+    }
+
+    constexpr uint32_t convert_rgb565_to_rgb888(uint16_t c)
+    {
+        return ((((c >> 11) * 0x21) >> 2) << 16) | (((((c >> 5) & 0x3F) * 0x41) >> 4) << 8) | (((c & 0x1F) * 0x21) >> 2);
+    }
+
+    // フォント (ホストでは 5x7 GLCD グリフを各サイズのセルに配置する)
+    struct IFont
+    {
+        uint8_t cellWidth;
+        uint8_t cellHeight;
+        uint8_t glyphOffsetY;
+    };
+
+    namespace fonts
+    {
+        inline const IFont Font0{6, 8, 0};
+        inline const IFont Font2{8, 16, 4};
+        inline const IFont Font4{14, 26, 9};
+        inline const IFont lgfxJapanGothic_12{6, 12, 2};
+        inline const IFont lgfxJapanGothicP_12{6, 12, 2};
+        inline const IFont lgfxJapanGothicP_16{8, 16, 4};
+        inline const IFont efontJA_12{6, 12, 2};
+    }
+
+    // ストリームデコーダに渡すデータ供給源
+    struct DataWrapper
+    {
+        virtual ~DataWrapper() = default;
+        virtual int read(uint8_t *buf, uint32_t len) = 0;
+        virtual void skip(int32_t offset) = 0;
+        virtual bool seek(uint32_t offset) = 0;
+        virtual void close() = 0;
+        virtual int32_t tell() = 0;
+        bool need_transaction = false;
+    };
+
+    namespace detail
+    {
+        // 5x7 ASCII フォント (0x20-0x7E, 列ごと・LSB が上端)
+        inline const uint8_t *GlcdGlyph(uint32_t codepoint)
+        {
+            static const uint8_t glyphs[95][5] = {
+                {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+                {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+                {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+                {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+                {0x00, 0x80, 0x70, 0x30, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x00, 0x60, 0x60, 0x00},
+                {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+                {0x72, 0x49, 0x49, 0x49, 0x46}, {0x21, 0x41, 0x49, 0x4D, 0x33}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+                {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07},
+                {0x36, 0x49, 0x49, 0x49, 0x36}, {0x46, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x00, 0x14, 0x00, 0x00},
+                {0x00, 0x40, 0x34, 0x00, 0x00}, {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},
+                {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x59, 0x09, 0x06}, {0x3E, 0x41, 0x5D, 0x59, 0x4E},
+                {0x7C, 0x12, 0x11, 0x12, 0x7C}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+                {0x7F, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},
+                {0x3E, 0x41, 0x41, 0x51, 0x73}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+                {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+                {0x7F, 0x02, 0x1C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+                {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+                {0x26, 0x49, 0x49, 0x49, 0x32}, {0x03, 0x01, 0x7F, 0x01, 0x03}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+                {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+                {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x59, 0x49, 0x4D, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x41},
+                {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x41, 0x7F}, {0x04, 0x02, 0x01, 0x02, 0x04},
+                {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x03, 0x07, 0x08, 0x00}, {0x20, 0x54, 0x54, 0x78, 0x40},
+                {0x7F, 0x28, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x28}, {0x38, 0x44, 0x44, 0x28, 0x7F},
+                {0x38, 0x54, 0x54, 0x54, 0x18}, {0x00, 0x08, 0x7E, 0x09, 0x02}, {0x18, 0xA4, 0xA4, 0x9C, 0x78},
+                {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x40, 0x3D, 0x00},
+                {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x78, 0x04, 0x78},
+                {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0xFC, 0x18, 0x24, 0x24, 0x18},
+                {0x18, 0x24, 0x24, 0x18, 0xFC}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x24},
+                {0x04, 0x04, 0x3F, 0x44, 0x24}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+                {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x4C, 0x90, 0x90, 0x90, 0x7C},
+                {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x77, 0x00, 0x00},
+                {0x00, 0x41, 0x36, 0x08, 0x00}, {0x02, 0x01, 0x02, 0x04, 0x02},
+            };
+            // ASCII 外の文字は中抜きの四角で表す
+            static const uint8_t missing[5] = {0x7F, 0x41, 0x41, 0x41, 0x7F};
+
+            if (codepoint >= 0x20 && codepoint <= 0x7E)
+            {
+                return glyphs[codepoint - 0x20];
+            }
+            return missing;
+        }
+
+        // UTF-8 文字列から 1 文字取り出す
+        inline uint32_t NextCodepoint(const char *&p)
+        {
+            const uint8_t c = static_cast<uint8_t>(*p++);
+            if (c < 0x80)
+            {
+                return c;
+            }
+            int extra = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : (c >= 0xC0) ? 1 : 0;
+            uint32_t cp = c & (0x3F >> extra);
+            while (extra-- && (static_cast<uint8_t>(*p) & 0xC0) == 0x80)
+            {
+                cp = (cp << 6) | (static_cast<uint8_t>(*p++) & 0x3F);
+            }
+            return cp;
+        }
+    }
+
+    // 描画先の共通基底 (ディスプレイとスプライトで共有する)
+    class LovyanGFX
+    {
+    public:
+        virtual ~LovyanGFX() = default;
+
+        int32_t width() const { return m_width; }
+        int32_t height() const { return m_height; }
+
+        //////////////////////////////////////////////////
+        // クリップ領域
+        //////////////////////////////////////////////////
+
+        void setClipRect(int32_t x, int32_t y, int32_t w, int32_t h)
+        {
+            m_clipL = std::max<int32_t>(0, x);
+            m_clipT = std::max<int32_t>(0, y);
+            m_clipR = std::min<int32_t>(m_width - 1, x + w - 1);
+            m_clipB = std::min<int32_t>(m_height - 1, y + h - 1);
+        }
+
+        void clearClipRect()
+        {
+            m_clipL = 0;
+            m_clipT = 0;
+            m_clipR = m_width - 1;
+            m_clipB = m_height - 1;
+        }
+
+        void getClipRect(int32_t *x, int32_t *y, int32_t *w, int32_t *h) const
+        {
+            *x = m_clipL;
+            *y = m_clipT;
+            *w = m_clipR - m_clipL + 1;
+            *h = m_clipB - m_clipT + 1;
+        }
+
+        //////////////////////////////////////////////////
+        // 画素アクセス
+        //////////////////////////////////////////////////
+
+        void *getBuffer() const { return m_buffer; }
+
+        void drawPixel(int32_t x, int32_t y, uint16_t color)
+        {
+            if (x < m_clipL || x > m_clipR || y < m_clipT || y > m_clipB)
+            {
+                return;
+            }
+            m_buffer[y * m_width + x] = swap16(color);
+        }
+
+        uint16_t readPixel(int32_t x, int32_t y) const
+        {
+            if (!m_buffer || x < 0 || y < 0 || x >= m_width || y >= m_height)
+            {
+                return 0;
+            }
+            return swap16(m_buffer[y * m_width + x]);
+        }
+
+        //////////////////////////////////////////////////
+        // 基本図形
+        //////////////////////////////////////////////////
+
+        void fillScreen(uint16_t color) { fillRect(0, 0, m_width, m_height, color); }
+
+        void drawFastHLine(int32_t x, int32_t y, int32_t w, uint16_t color) { fillRect(x, y, w, 1, color); }
+        void drawFastVLine(int32_t x, int32_t y, int32_t h, uint16_t color) { fillRect(x, y, 1, h, color); }
+
+        void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color)
+        {
+            if (w < 0)
+            {
+                x += w + 1;
+                w = -w;
+            }
+            if (h < 0)
+            {
+                y += h + 1;
+                h = -h;
+            }
+            int32_t l = std::max(x, m_clipL);
+            int32_t r = std::min(x + w - 1, m_clipR);
+            int32_t t = std::max(y, m_clipT);
+            int32_t b = std::min(y + h - 1, m_clipB);
+            if (!m_buffer || l > r || t > b)
+            {
+                return;
+            }
+            const uint16_t raw = swap16(color);
+            for (int32_t yy = t; yy <= b; ++yy)
+            {
+                std::fill_n(m_buffer + yy * m_width + l, r - l + 1, raw);
+            }
+        }
+
+        void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color)
+        {
+            if (w <= 0 || h <= 0)
+            {
+                return;
+            }
+            drawFastHLine(x, y, w, color);
+            if (h > 1)
+            {
+                drawFastHLine(x, y + h - 1, w, color);
+            }
+            if (h > 2)
+            {
+                drawFastVLine(x, y + 1, h - 2, color);
+                if (w > 1)
+                {
+                    drawFastVLine(x + w - 1, y + 1, h - 2, color);
+                }
+            }
+        }
+
+        void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t color)
+        {
+            const int32_t dx = std::abs(x1 - x0);
+            const int32_t dy = -std::abs(y1 - y0);
+            const int32_t sx = x0 < x1 ? 1 : -1;
+            const int32_t sy = y0 < y1 ? 1 : -1;
+            int32_t err = dx + dy;
+            for (;;)
+            {
+                drawPixel(x0, y0, color);
+                if (x0 == x1 && y0 == y1)
+                {
+                    break;
+                }
+                const int32_t e2 = 2 * err;
+                if (e2 >= dy)
+                {
+                    err += dy;
+                    x0 += sx;
+                }
+                if (e2 <= dx)
+                {
+                    err += dx;
+                    y0 += sy;
+                }
+            }
+        }
+
+        void drawCircle(int32_t x0, int32_t y0, int32_t r, uint16_t color)
+        {
+            if (r < 0)
+            {
+                return;
+            }
+            int32_t x = 0;
+            int32_t y = r;
+            int32_t d = 1 - r;
+            while (x <= y)
+            {
+                drawPixel(x0 + x, y0 + y, color);
+                drawPixel(x0 - x, y0 + y, color);
+                drawPixel(x0 + x, y0 - y, color);
+                drawPixel(x0 - x, y0 - y, color);
+                drawPixel(x0 + y, y0 + x, color);
+                drawPixel(x0 - y, y0 + x, color);
+                drawPixel(x0 + y, y0 - x, color);
+                drawPixel(x0 - y, y0 - x, color);
+                if (d < 0)
+                {
+                    d += 2 * x + 3;
+                }
+                else
+                {
+                    d += 2 * (x - y) + 5;
+                    --y;
+                }
+                ++x;
+            }
+        }
+
+        void fillCircle(int32_t x0, int32_t y0, int32_t r, uint16_t color)
+        {
+            if (r < 0)
+            {
+                return;
+            }
+            int32_t x = 0;
+            int32_t y = r;
+            int32_t d = 1 - r;
+            while (x <= y)
+            {
+                drawFastHLine(x0 - y, y0 + x, 2 * y + 1, color);
+                drawFastHLine(x0 - y, y0 - x, 2 * y + 1, color);
+                drawFastHLine(x0 - x, y0 + y, 2 * x + 1, color);
+                drawFastHLine(x0 - x, y0 - y, 2 * x + 1, color);
+                if (d < 0)
+                {
+                    d += 2 * x + 3;
+                }
+                else
+                {
+                    d += 2 * (x - y) + 5;
+                    --y;
+                }
+                ++x;
+            }
+        }
+
+        void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint16_t color)
+        {
+            if (w <= 0 || h <= 0)
+            {
+                return;
+            }
+            r = std::max<int32_t>(0, std::min(r, std::min(w, h) / 2));
+            for (int32_t i = 0; i < h; ++i)
+            {
+                const int32_t inset = roundRectInset(i, h, r);
+                drawFastHLine(x + inset, y + i, w - inset * 2, color);
+            }
+        }
+
+        void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint16_t color)
+        {
+            if (w <= 0 || h <= 0)
+            {
+                return;
+            }
+            r = std::max<int32_t>(0, std::min(r, std::min(w, h) / 2));
+            for (int32_t i = 0; i < h; ++i)
+            {
+                const int32_t inset = roundRectInset(i, h, r);
+                if (i == 0 || i == h - 1)
+                {
+                    drawFastHLine(x + inset, y + i, w - inset * 2, color);
+                    continue;
+                }
+                // 隣接行の内側位置まで伸ばして輪郭を連続させる
+                const int32_t neighbour = std::max(roundRectInset(i - 1, h, r), roundRectInset(i + 1, h, r));
+                const int32_t span = std::max<int32_t>(1, neighbour - inset);
+                drawFastHLine(x + inset, y + i, span, color);
+                drawFastHLine(x + w - inset - span, y + i, span, color);
+            }
+        }
+
+        void fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t color)
+        {
+            if (y0 > y1)
+            {
+                std::swap(y0, y1);
+                std::swap(x0, x1);
+            }
+            if (y1 > y2)
+            {
+                std::swap(y2, y1);
+                std::swap(x2, x1);
+            }
+            if (y0 > y1)
+            {
+                std::swap(y0, y1);
+                std::swap(x0, x1);
+            }
+
+            if (y0 == y2)
+            {
+                const int32_t a = std::min({x0, x1, x2});
+                const int32_t b = std::max({x0, x1, x2});
+                drawFastHLine(a, y0, b - a + 1, color);
+                return;
+            }
+
+            const int32_t dx01 = x1 - x0, dy01 = y1 - y0;
+            const int32_t dx02 = x2 - x0, dy02 = y2 - y0;
+            const int32_t dx12 = x2 - x1, dy12 = y2 - y1;
+            int32_t sa = 0;
+            int32_t sb = 0;
+
+            const int32_t last = (y1 == y2) ? y1 : y1 - 1;
+            int32_t yy = y0;
+            for (; yy <= last; ++yy)
+            {
+                int32_t a = x0 + (dy01 ? sa / dy01 : 0);
+                int32_t b = x0 + sb / dy02;
+                sa += dx01;
+                sb += dx02;
+                if (a > b)
+                {
+                    std::swap(a, b);
+                }
+                drawFastHLine(a, yy, b - a + 1, color);
+            }
+
+            sa = dx12 * (yy - y1);
+            sb = dx02 * (yy - y0);
+            for (; yy <= y2; ++yy)
+            {
+                int32_t a = x1 + sa / dy12;
+                int32_t b = x0 + sb / dy02;
+                sa += dx12;
+                sb += dx02;
+                if (a > b)
+                {
+                    std::swap(a, b);
+                }
+                drawFastHLine(a, yy, b - a + 1, color);
+            }
+        }
+
+        void drawTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t color)
+        {
+            drawLine(x0, y0, x1, y1, color);
+            drawLine(x1, y1, x2, y2, color);
+            drawLine(x2, y2, x0, y0, color);
+        }
+
+        // 角度は度単位・3時方向が 0 度で時計回り (LovyanGFX と同じ)
+        void fillArc(int32_t x, int32_t y, int32_t r0, int32_t r1, float angle0, float angle1, uint16_t color)
+        {
+            forEachArcPixel(x, y, r0, r1, angle0, angle1, false, color);
+        }
+
+        void drawArc(int32_t x, int32_t y, int32_t r0, int32_t r1, float angle0, float angle1, uint16_t color)
+        {
+            forEachArcPixel(x, y, r0, r1, angle0, angle1, true, color);
+        }
+
+        void drawBezier(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t color)
+        {
+            const int32_t steps = bezierSteps(std::abs(x1 - x0) + std::abs(y1 - y0) + std::abs(x2 - x1) + std::abs(y2 - y1));
+            int32_t px = x0;
+            int32_t py = y0;
+            for (int32_t i = 1; i <= steps; ++i)
+            {
+                const float t = float(i) / steps;
+                const float u = 1.0f - t;
+                const int32_t qx = static_cast<int32_t>(std::lround(u * u * x0 + 2 * u * t * x1 + t * t * x2));
+                const int32_t qy = static_cast<int32_t>(std::lround(u * u * y0 + 2 * u * t * y1 + t * t * y2));
+                drawLine(px, py, qx, qy, color);
+                px = qx;
+                py = qy;
+            }
+        }
+
+        void drawBezier(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, uint16_t color)
+        {
+            const int32_t steps = bezierSteps(std::abs(x1 - x0) + std::abs(y1 - y0) + std::abs(x2 - x1) + std::abs(y2 - y1) + std::abs(x3 - x2) + std::abs(y3 - y2));
+            int32_t px = x0;
+            int32_t py = y0;
+            for (int32_t i = 1; i <= steps; ++i)
+            {
+                const float t = float(i) / steps;
+                const float u = 1.0f - t;
+                const float a = u * u * u, b = 3 * u * u * t, c = 3 * u * t * t, d = t * t * t;
+                const int32_t qx = static_cast<int32_t>(std::lround(a * x0 + b * x1 + c * x2 + d * x3));
+                const int32_t qy = static_cast<int32_t>(std::lround(a * y0 + b * y1 + c * y2 + d * y3));
+                drawLine(px, py, qx, qy, color);
+                px = qx;
+                py = qy;
+            }
+        }
+
+        //////////////////////////////////////////////////
+        // テキスト
+        //////////////////////////////////////////////////
+
+        void setFont(const IFont *font) { m_font = font ? font : &fonts::Font0; }
+        const IFont *getFont() const { return m_font; }
+
+        void setTextSize(float size) { setTextSize(size, size); }
+        void setTextSize(float sx, float sy)
+        {
+            m_textSizeX = sx > 0 ? sx : 1.0f;
+            m_textSizeY = sy > 0 ? sy : 1.0f;
+        }
+        float getTextSizeX() const { return m_textSizeX; }
+        float getTextSizeY() const { return m_textSizeY; }
+
+        // 文字の色とサイズの一括取得・設定 (LovyanGFX の TextStyle 相当)
+        // 色は RGB888 で持ち、背景色が文字色と同じ場合は背景を塗らない (LovyanGFX と同じ)
+        struct TextStyle
+        {
+            uint32_t fore_rgb888;
+            uint32_t back_rgb888;
+            float size_x;
+            float size_y;
+        };
+        TextStyle getTextStyle() const
+        {
+            const uint16_t back = m_textFillBackground ? m_textBackground : m_textColor;
+            return TextStyle{convert_rgb565_to_rgb888(m_textColor), convert_rgb565_to_rgb888(back), m_textSizeX, m_textSizeY};
+        }
+        void setTextStyle(const TextStyle &style)
+        {
+            m_textColor = convert_rgb888_to_rgb565(style.fore_rgb888);
+            m_textBackground = convert_rgb888_to_rgb565(style.back_rgb888);
+            m_textFillBackground = style.fore_rgb888 != style.back_rgb888;
+            m_textSizeX = style.size_x;
+            m_textSizeY = style.size_y;
+        }
+
+        void setTextColor(uint16_t color) { m_textColor = color; m_textFillBackground = false; }
+        void setTextColor(uint16_t color, uint16_t background)
+        {
+            m_textColor = color;
+            m_textBackground = background;
+            m_textFillBackground = true;
+        }
+
+        void setCursor(int32_t x, int32_t y)
+        {
+            m_cursorX = x;
+            m_cursorY = y;
+        }
+        int32_t getCursorX() const { return m_cursorX; }
+        int32_t getCursorY() const { return m_cursorY; }
+
+        int32_t fontHeight() const { return static_cast<int32_t>(m_font->cellHeight * m_textSizeY); }
+        int32_t fontWidth() const { return static_cast<int32_t>(m_font->cellWidth * m_textSizeX); }
+
+        int32_t textWidth(const char *text) const
+        {
+            int32_t count = 0;
+            while (*text)
+            {
+                detail::NextCodepoint(text);
+                ++count;
+            }
+            return static_cast<int32_t>(count * m_font->cellWidth * m_textSizeX);
+        }
+        int32_t textWidth(const String &text) const { return textWidth(text.c_str()); }
+
+        int32_t drawString(const char *text, int32_t x, int32_t y)
+        {
+            const int32_t startX = x;
+            while (*text)
+            {
+                x += drawGlyph(detail::NextCodepoint(text), x, y);
+            }
+            return x - startX;
+        }
+        int32_t drawString(const String &text, int32_t x, int32_t y) { return drawString(text.c_str(), x, y); }
+
+        size_t print(const char *text)
+        {
+            const char *begin = text;
+            while (*text)
+            {
+                const uint32_t cp = detail::NextCodepoint(text);
+                if (cp == '\n')
+                {
+                    m_cursorX = 0;
+                    m_cursorY += fontHeight();
+                    continue;
+                }
+                if (cp == '\r')
+                {
+                    continue;
+                }
+                if (m_cursorX + fontWidth() > m_width)
+                {
+                    m_cursorX = 0;
+                    m_cursorY += fontHeight();
+                }
+                m_cursorX += drawGlyph(cp, m_cursorX, m_cursorY);
+            }
+            return static_cast<size_t>(text - begin);
+        }
+        size_t print(const String &text) { return print(text.c_str()); }
+        size_t println(const char *text)
+        {
+            size_t n = print(text);
+            return n + print("\n");
+        }
+
+        //////////////////////////////////////////////////
+        // 画像転送
+        //////////////////////////////////////////////////
+
+        void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const swap565_t *data)
+        {
+            blit(x, y, w, h, w, reinterpret_cast<const uint16_t *>(data), true, false, 0);
+        }
+
+        // uint16_t の配列は非スワップの RGB565 として扱う (LovyanGFX と同じ)
+        void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data)
+        {
+            blit(x, y, w, h, w, data, false, false, 0);
+        }
+
+        void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const swap565_t *data, uint16_t transparent)
+        {
+            blit(x, y, w, h, w, reinterpret_cast<const uint16_t *>(data), true, true, transparent);
+        }
+
+        // 範囲の画素をスワップ済み RGB565 で読み出す (範囲外は 0)
+        void readRect(int32_t x, int32_t y, int32_t w, int32_t h, swap565_t *data) const
+        {
+            for (int32_t yy = 0; yy < h; ++yy)
+            {
+                for (int32_t xx = 0; xx < w; ++xx)
+                {
+                    data[yy * w + xx].raw = swap16(readPixel(x + xx, y + yy));
+                }
+            }
+        }
+
+        bool drawPng(const uint8_t *, uint32_t, int32_t = 0, int32_t = 0)
+        {
+            // ホストには PNG デコーダを持たない
+            return false;
+        }
+
+        bool drawPng(DataWrapper *, int32_t = 0, int32_t = 0)
+        {
+            return false;
+        }
+
+        void startWrite() { ++m_writeDepth; }
+        void endWrite()
+        {
+            if (m_writeDepth > 0)
+            {
+                --m_writeDepth;
+            }
+        }
+
+        // ホスト専用: 開いているトランザクションの数 (バスの解放の検証用)
+        int32_t writeDepth() const { return m_writeDepth; }
+
+    protected:
+        // 転送元の画素 (src は stride 画素ごとの行) を描画先に写す
+        // 描画先のクリップ領域を尊重し、実際に書き込んだ画素数を返す
+        virtual uint64_t blit(int32_t x, int32_t y, int32_t w, int32_t h, int32_t stride, const uint16_t *src,
+                              bool swapped, bool useTransparent, uint16_t transparent)
+        {
+            int32_t l = std::max(x, m_clipL);
+            int32_t r = std::min(x + w - 1, m_clipR);
+            int32_t t = std::max(y, m_clipT);
+            int32_t b = std::min(y + h - 1, m_clipB);
+            if (!m_buffer || !src || l > r || t > b)
+            {
+                return 0;
+            }
+            const uint16_t transparentRaw = swap16(transparent);
+            for (int32_t yy = t; yy <= b; ++yy)
+            {
+                const uint16_t *s = src + (yy - y) * stride + (l - x);
+                uint16_t *d = m_buffer + yy * m_width + l;
+                if (swapped && !useTransparent)
+                {
+                    std::memcpy(d, s, (r - l + 1) * sizeof(uint16_t));
+                    continue;
+                }
+                for (int32_t xx = l; xx <= r; ++xx, ++s, ++d)
+                {
+                    const uint16_t raw = swapped ? *s : swap16(*s);
+                    if (useTransparent && raw == transparentRaw)
+                    {
+                        continue;
+                    }
+                    *d = raw;
+                }
+            }
+            return uint64_t(r - l + 1) * uint64_t(b - t + 1);
+        }
+
+        void attachBuffer(uint16_t *buffer, int32_t w, int32_t h)
+        {
+            m_buffer = buffer;
+            m_width = buffer ? w : 0;
+            m_height = buffer ? h : 0;
+            clearClipRect();
+        }
+
+        int32_t m_writeDepth = 0;
+
+    private:
+        int32_t drawGlyph(uint32_t codepoint, int32_t x, int32_t y)
+        {
+            const int32_t advance = static_cast<int32_t>(m_font->cellWidth * m_textSizeX);
+            if (m_textFillBackground)
+            {
+                fillRect(x, y, advance, fontHeight(), m_textBackground);
+            }
+            const uint8_t *glyph = detail::GlcdGlyph(codepoint);
+            const float offsetY = m_font->glyphOffsetY * m_textSizeY;
+            for (int32_t col = 0; col < 5; ++col)
+            {
+                uint8_t bits = glyph[col];
+                const int32_t px0 = x + static_cast<int32_t>(col * m_textSizeX);
+                const int32_t px1 = x + static_cast<int32_t>((col + 1) * m_textSizeX);
+                for (int32_t row = 0; bits; ++row, bits >>= 1)
+                {
+                    if (bits & 1)
+                    {
+                        const int32_t py0 = y + static_cast<int32_t>(offsetY + row * m_textSizeY);
+                        const int32_t py1 = y + static_cast<int32_t>(offsetY + (row + 1) * m_textSizeY);
+                        fillRect(px0, py0, std::max(1, px1 - px0), std::max(1, py1 - py0), m_textColor);
+                    }
+                }
+            }
+            return advance;
+        }
+
+        static int32_t roundRectInset(int32_t row, int32_t h, int32_t r)
+        {
+            int32_t dy = 0;
+            if (row < r)
+            {
+                dy = r - row;
+            }
+            else if (row > h - 1 - r)
+            {
+                dy = row - (h - 1 - r);
+            }
+            if (dy == 0)
+            {
+                return 0;
+            }
+            const float dx = std::sqrt(float(r * r - (dy - 0.5f) * (dy - 0.5f)));
+            return r - static_cast<int32_t>(dx + 0.5f);
+        }
+
+        static int32_t bezierSteps(int32_t length)
+        {
+            return std::max<int32_t>(2, std::min<int32_t>(256, length / 4 + 2));
+        }
+
+        void forEachArcPixel(int32_t cx, int32_t cy, int32_t r0, int32_t r1, float angle0, float angle1, bool outline, uint16_t color)
+        {
+            const int32_t inner = std::min(std::abs(r0), std::abs(r1));
+            const int32_t outer = std::max(std::abs(r0), std::abs(r1));
+            float start = std::fmod(angle0, 360.0f);
+            if (start < 0)
+            {
+                start += 360.0f;
+            }
+            float sweep = angle1 - angle0;
+            if (sweep < 0)
+            {
+                sweep = std::fmod(sweep, 360.0f) + 360.0f;
+            }
+            const bool full = sweep >= 360.0f;
+
+            auto inside = [&](int32_t dx, int32_t dy) {
+                const int32_t d2 = dx * dx + dy * dy;
+                if (d2 > outer * outer + outer || d2 < inner * inner - inner)
+                {
+                    return false;
+                }
+                if (full)
+                {
+                    return true;
+                }
+                float a = std::atan2(float(dy), float(dx)) * 180.0f / float(M_PI);
+                if (a < 0)
+                {
+                    a += 360.0f;
+                }
+                float rel = a - start;
+                if (rel < 0)
+                {
+                    rel += 360.0f;
+                }
+                return rel <= sweep;
+            };
+
+            for (int32_t dy = -outer; dy <= outer; ++dy)
+            {
+                for (int32_t dx = -outer; dx <= outer; ++dx)
+                {
+                    if (!inside(dx, dy))
+                    {
+                        continue;
+                    }
+                    if (outline && inside(dx - 1, dy) && inside(dx + 1, dy) && inside(dx, dy - 1) && inside(dx, dy + 1))
+                    {
+                        continue;
+                    }
+                    drawPixel(cx + dx, cy + dy, color);
+                }
+            }
+        }
+
+        uint16_t *m_buffer = nullptr;
+        int32_t m_width = 0;
+        int32_t m_height = 0;
+        int32_t m_clipL = 0;
+        int32_t m_clipT = 0;
+        int32_t m_clipR = -1;
+        int32_t m_clipB = -1;
+
+        const IFont *m_font = &fonts::Font0;
+        float m_textSizeX = 1.0f;
+        float m_textSizeY = 1.0f;
+        uint16_t m_textColor = 0xFFFF;
+        uint16_t m_textBackground = 0x0000;
+        bool m_textFillBackground = false;
+        int32_t m_cursorX = 0;
+        int32_t m_cursorY = 0;
+    };
+
+    // メモリ上のスプライト
+    class LGFX_Sprite : public LovyanGFX
+    {
+    public:
+        LGFX_Sprite() = default;
+        explicit LGFX_Sprite(LovyanGFX *parent) : m_parent(parent) {}
+
+        LGFX_Sprite(const LGFX_Sprite &) = delete;
+        LGFX_Sprite &operator=(const LGFX_Sprite &) = delete;
+
+        void setColorDepth(int bits) { m_colorDepth = bits; }
+        void setPsram(bool) {}
+
+        void *createSprite(int32_t w, int32_t h)
+        {
+            deleteSprite();
+            if (w <= 0 || h <= 0 || !Allocation::reserve(size_t(w) * size_t(h) * sizeof(uint16_t)))
+            {
+                return nullptr;
+            }
+            m_pixels.assign(size_t(w) * size_t(h), 0);
+            attachBuffer(m_pixels.data(), w, h);
+            return m_pixels.data();
+        }
+
+        void deleteSprite()
+        {
+            if (!m_pixels.empty())
+            {
+                Allocation::release(m_pixels.size() * sizeof(uint16_t));
+            }
+            std::vector<uint16_t>().swap(m_pixels);
+            attachBuffer(nullptr, 0, 0);
+        }
+
+        ~LGFX_Sprite() override { deleteSprite(); }
+
+        void fillSprite(uint16_t color) { fillScreen(color); }
+
+        void pushSprite(int32_t x, int32_t y)
+        {
+            if (m_parent)
+            {
+                pushSprite(m_parent, x, y);
+            }
+        }
+
+        void pushSprite(LovyanGFX *dst, int32_t x, int32_t y)
+        {
+            if (dst && getBuffer())
+            {
+                dst->pushImage(x, y, width(), height(), static_cast<const swap565_t *>(getBuffer()));
+            }
+        }
+
+        void pushSprite(LovyanGFX *dst, int32_t x, int32_t y, uint16_t transparent)
+        {
+            if (dst && getBuffer())
+            {
+                dst->pushImage(x, y, width(), height(), static_cast<const swap565_t *>(getBuffer()), transparent);
+            }
+        }
+
+        void setPivot(float x, float y)
+        {
+            m_pivotX = x;
+            m_pivotY = y;
+        }
+
+        // 逆写像による回転拡大縮小転送 (最近傍)
+        void pushRotateZoom(LovyanGFX *dst, float dstX, float dstY, float angle, float zoomX, float zoomY)
+        {
+            if (!dst || !getBuffer() || zoomX == 0 || zoomY == 0)
+            {
+                return;
+            }
+            const float rad = angle * float(M_PI) / 180.0f;
+            const float c = std::cos(rad);
+            const float s = std::sin(rad);
+            const float hw = std::abs(width() * zoomX) + std::abs(height() * zoomY);
+            const int32_t l = static_cast<int32_t>(std::floor(dstX - hw));
+            const int32_t r = static_cast<int32_t>(std::ceil(dstX + hw));
+            const int32_t t = static_cast<int32_t>(std::floor(dstY - hw));
+            const int32_t b = static_cast<int32_t>(std::ceil(dstY + hw));
+            for (int32_t y = t; y <= b; ++y)
+            {
+                for (int32_t x = l; x <= r; ++x)
+                {
+                    const float dx = x + 0.5f - dstX;
+                    const float dy = y + 0.5f - dstY;
+                    const float u = (c * dx + s * dy) / zoomX + m_pivotX;
+                    const float v = (-s * dx + c * dy) / zoomY + m_pivotY;
+                    if (u < 0 || v < 0 || u >= width() || v >= height())
+                    {
+                        continue;
+                    }
+                    dst->drawPixel(x, y, readPixel(static_cast<int32_t>(u), static_cast<int32_t>(v)));
+                }
+            }
+        }
+
+        void pushRotateZoom(float dstX, float dstY, float angle, float zoomX, float zoomY)
+        {
+            pushRotateZoom(m_parent, dstX, dstY, angle, zoomX, zoomY);
+        }
+
+        // ホスト専用: スプライト確保量の上限 (メモリ不足の再現用)
+        struct Allocation
+        {
+            static size_t &limit()
+            {
+                static size_t value = SIZE_MAX;
+                return value;
+            }
+
+            static size_t &used()
+            {
+                static size_t value = 0;
+                return value;
+            }
+
+            static bool reserve(size_t bytes)
+            {
+                if (used() + bytes > limit())
+                {
+                    return false;
+                }
+                used() += bytes;
+                return true;
+            }
+
+            static void release(size_t bytes) { used() -= std::min(bytes, used()); }
+        };
+
+    private:
+        LovyanGFX *m_parent = nullptr;
+        std::vector<uint16_t> m_pixels;
+        int m_colorDepth = 16;
+        float m_pivotX = 0;
+        float m_pivotY = 0;
+    };
+}
+
+using lgfx::LovyanGFX;
+using lgfx::LGFX_Sprite;
+namespace fonts = lgfx::fonts;
+
+// メモリ上のフレームバッファを持つディスプレイ
+// 転送量の統計と DMA 転送の遅延を模擬できる
+class M5GFX : public lgfx::LovyanGFX
+{
+public:
+    struct Stats
+    {
+        uint64_t pushedPixels = 0;
+        uint32_t pushCount = 0;
+        uint32_t dmaTransfers = 0;
+        uint64_t dmaWaitMicros = 0;
+    };
+
+    M5GFX() { setSize(320, 240); }
+
+    // ホスト専用: 画面サイズの変更 (M5.begin より前に呼ぶ)
+    void setSize(int32_t w, int32_t h)
+    {
+        m_frame.assign(size_t(w) * size_t(h), 0);
+        attachBuffer(m_frame.data(), w, h);
+    }
+
+    // ホスト専用: DMA 転送 1 画素あたりの所要時間 (ナノ秒)
+    void setDmaNanosPerPixel(uint32_t ns) { m_dmaNanosPerPixel = ns; }
+
+    const Stats &stats() const { return m_stats; }
+    void resetStats() { m_stats = Stats(); }
+
+    // DMA 転送: 完了時点の転送元バッファの内容が画面に反映される
+    void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const lgfx::swap565_t *data)
+    {
+        waitDMA();
+        m_dma.active = true;
+        m_dma.x = x;
+        m_dma.y = y;
+        m_dma.w = w;
+        m_dma.h = h;
+        m_dma.data = reinterpret_cast<const uint16_t *>(data);
+        m_dma.completeAt = Host::Clock::getInstance().nowMicros() + (uint64_t(w) * h * m_dmaNanosPerPixel) / 1000;
+        ++m_stats.dmaTransfers;
+    }
+
+    bool dmaBusy()
+    {
+        if (m_dma.active && Host::Clock::getInstance().nowMicros() >= m_dma.completeAt)
+        {
+            completeDMA();
+        }
+        return m_dma.active;
+    }
+
+    void waitDMA()
+    {
+        if (!m_dma.active)
+        {
+            return;
+        }
+        auto &clock = Host::Clock::getInstance();
+        const uint64_t now = clock.nowMicros();
+        if (now < m_dma.completeAt)
+        {
+            m_stats.dmaWaitMicros += m_dma.completeAt - now;
+            clock.sleepMicros(m_dma.completeAt - now);
+        }
+        completeDMA();
+    }
+
+    // ホスト専用: 転送中のバッファ (フェンス検証用)
+    const void *dmaSource() const { return m_dma.active ? m_dma.data : nullptr; }
+
+protected:
+    uint64_t blit(int32_t x, int32_t y, int32_t w, int32_t h, int32_t stride, const uint16_t *src,
+                  bool swapped, bool useTransparent, uint16_t transparent) override
+    {
+        const uint64_t pixels = LovyanGFX::blit(x, y, w, h, stride, src, swapped, useTransparent, transparent);
+        m_stats.pushedPixels += pixels;
+        ++m_stats.pushCount;
+        return pixels;
+    }
+
+private:
+    void completeDMA()
+    {
+        m_dma.active = false;
+        blit(m_dma.x, m_dma.y, m_dma.w, m_dma.h, m_dma.w, m_dma.data, true, false, 0);
+    }
+
+    struct DmaTransfer
+    {
+        bool active = false;
+        int32_t x = 0, y = 0, w = 0, h = 0;
+        const uint16_t *data = nullptr;
+        uint64_t completeAt = 0;
+    };
+
+    std::vector<uint16_t> m_frame;
+    Stats m_stats;
+    DmaTransfer m_dma;
+    uint32_t m_dmaNanosPerPixel = 0;
+};
+
+class M5Canvas : public lgfx::LGFX_Sprite
+{
+public:
+    M5Canvas() = default;
+    explicit M5Canvas(lgfx::LovyanGFX *parent) : LGFX_Sprite(parent) {}
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+// ホスト(native)ビルド用の M5Unified 互換レイヤー
+// ボタン・タッチ・IMU はテストから状態を注入して使う
+
+#include "Arduino.h"
+#include "LovyanGFX.h"
+
+namespace m5
+{
+    class Button_Class
+    {
+    public:
+        bool isPressed() const { return m_pressed; }
+        bool isReleased() const { return !m_pressed; }
+        bool wasPressed() const { return m_pressed && !m_previous; }
+        bool wasReleased() const { return !m_pressed && m_previous; }
+        bool pressedFor(uint32_t ms) const { return m_pressed && millis() - m_changedAt >= ms; }
+        bool releasedFor(uint32_t ms) const { return !m_pressed && millis() - m_changedAt >= ms; }
+
+        // ホスト専用: 次の update で反映される物理状態
+        void setRawState(bool pressed) { m_raw = pressed; }
+
+        void update()
+        {
+            m_previous = m_pressed;
+            m_pressed = m_raw;
+            if (m_pressed != m_previous)
+            {
+                m_changedAt = millis();
+            }
+        }
+
+    private:
+        bool m_raw = false;
+        bool m_pressed = false;
+        bool m_previous = false;
+        uint32_t m_changedAt = 0;
+    };
+
+    struct touch_detail_t
+    {
+        int16_t x = -1;
+        int16_t y = -1;
+        bool pressed = false;
+
+        bool isPressed() const { return pressed; }
+    };
+
+    class Touch_Class
+    {
+    public:
+        bool isEnabled() const { return m_enabled; }
+        touch_detail_t getDetail() const { return m_detail; }
+
+        // ホスト専用: タッチ状態の注入
+        void setEnabled(bool enabled) { m_enabled = enabled; }
+        void setRawState(int16_t x, int16_t y, bool pressed)
+        {
+            m_detail.x = x;
+            m_detail.y = y;
+            m_detail.pressed = pressed;
+        }
+
+    private:
+        bool m_enabled = true;
+        touch_detail_t m_detail;
+    };
+
+    class IMU_Class
+    {
+    public:
+        struct imu_3d_t
+        {
+            float x = 0;
+            float y = 0;
+            float z = 0;
+        };
+
+        struct imu_data_t
+        {
+            imu_3d_t accel;
+            imu_3d_t gyro;
+            imu_3d_t mag;
+        };
+
+        bool update() { return true; }
+        imu_data_t getImuData() const { return m_data; }
+
+        // ホスト専用: センサー値の注入
+        void setRawData(const imu_data_t &data) { m_data = data; }
+
+    private:
+        imu_data_t m_data;
+    };
+
+    class M5Unified
+    {
+    public:
+        struct config_t
+        {
+            uint32_t serial_baudrate = 115200;
+        };
+
+        config_t config() const { return config_t(); }
+        void begin(const config_t &) {}
+
+        void update()
+        {
+            BtnA.update();
+            BtnB.update();
+            BtnC.update();
+        }
+
+        void delay(uint32_t ms) { ::delay(ms); }
+
+        M5GFX Display;
+        Touch_Class Touch;
+        IMU_Class Imu;
+        Button_Class BtnA;
+        Button_Class BtnB;
+        Button_Class BtnC;
+    };
+}
+
+inline m5::M5Unified M5;
@@ -0,0 +1,48 @@
+#pragma once
+
+// ホスト(native)のテストで共通に使う画面の確認
+// Unity を使うので M5Siv3D.h からは読み込まず、各テストから直接読み込む
+
+#include <unity.h>
+#include <cstdint>
+#include <vector>
+#include "../../M5Siv3D.h"
+
+namespace Host
+{
+    // 転送の完了を待ってから画面全体の画素を読み出す
+    inline std::vector<uint16_t> CaptureScreen()
+    {
+        M5.Display.waitDMA();
+        std::vector<uint16_t> pixels;
+        pixels.reserve(size_t(M5.Display.width()) * size_t(M5.Display.height()));
+        for (int32_t y = 0; y < M5.Display.height(); ++y)
+        {
+            for (int32_t x = 0; x < M5.Display.width(); ++x)
+            {
+                pixels.push_back(uint16_t(M5.Display.readPixel(x, y)));
+            }
+        }
+        return pixels;
+    }
+
+    // scene() で描いたフレームが、現在の表示方法と Banded で同じ画面になることを確かめる
+    // 終了後は Banded のままなので、tearDown で表示方法を戻すこと
+    template <class Scene>
+    void CheckBandedMatchesFull(Scene scene)
+    {
+        System::Update();
+        scene();
+        System::Update();
+        const std::vector<uint16_t> full = CaptureScreen();
+
+        System::SetPresentMode(PresentMode::Banded);
+        System::Update();
+        scene();
+        System::Update();
+        const std::vector<uint16_t> banded = CaptureScreen();
+
+        TEST_ASSERT_EQUAL_UINT32(full.size(), banded.size());
+        TEST_ASSERT_TRUE(full == banded);
+    }
+}
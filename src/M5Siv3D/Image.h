@@ -1,10 +1,12 @@
 #pragma once
 
-#include <M5Unified.h>
-#include <base64.hpp>
+#include "Platform.h"
 #include "Math.h"
 #include "Color.h"
 #include "System.h"
+#include "Base64Stream.h"
+#include "ImageData.h"
+#include "ScaledImageCache.h"
 
 class Image {
 private:
@@ -12,6 +14,22 @@ private:
     bool m_valid = false;
     int32_t m_width = 0;
     int32_t m_height = 0;
+    uint32_t m_revision = 0;  // 内容を読み込み直すたびに増やす (描画命令の差分検出用)
+    const ImageData* m_data = nullptr;  // フラッシュの画像を参照している場合 (キャンバスは使わない)
+
+    friend class TextureAtlas;  // 複数の画像をキャンバスに詰める
+
+    // フラッシュの画像の参照をやめ、キャンバスを用意する
+    bool prepareCanvas() {
+        m_data = nullptr;
+        if (!m_canvas) {
+            m_canvas = new M5Canvas(&M5.Display);
+            if (m_canvas) {
+                m_canvas->setColorDepth(16);
+            }
+        }
+        return m_canvas != nullptr;
+    }
 
 public:
     Image() : m_canvas(nullptr) {
@@ -21,9 +39,16 @@ public:
             m_canvas->setColorDepth(16);  // 16bitカラーモードを設定
         }
     }
+
+    // フラッシュの変換済み画像を参照する (tools/image_to_rgb565.py で生成)
+    // デコードもキャンバスへのコピーもせず、描画のたびに data から直接転送する
+    // data は Image より長く存在する必要がある
+    explicit Image(const ImageData& data)
+        : m_canvas(nullptr), m_valid(true), m_width(data.width), m_height(data.height), m_data(&data) {}
+    explicit Image(ImageData&&) = delete;  // 一時オブジェクトは参照できない
     
     bool loadBase64(const char* base64Data) {
-        if (!m_canvas) {
+        if (!prepareCanvas()) {
             Serial.println("Canvas not initialized");
             return false;
         }
@@ -32,58 +57,49 @@ public:
         m_canvas->deleteSprite();
         m_valid = false;
         
-        // Base64デコード
-        size_t decodedLen = decode_base64_length((unsigned char*)base64Data);
-        if (decodedLen == 0) {
+        // Base64デコード (全体を展開せず、PNGデコーダが読む分だけ少しずつデコードする)
+        Base64Stream stream(base64Data);
+        if (stream.size() == 0) {
             Serial.println("Base64 decode length is 0");
             return false;
         }
-        
-        uint8_t* decodedData = new uint8_t[decodedLen];
-        size_t actualLen = decode_base64((unsigned char*)base64Data, decodedData);
-        if (actualLen == 0) {
-            Serial.println("Base64 decode failed");
-            delete[] decodedData;
-            return false;
-        }
 
         // PNGヘッダーからサイズを読み取る (IHDRチャンク)
-        if (actualLen < 24 || decodedData[0] != 0x89 || decodedData[1] != 'P' || decodedData[2] != 'N' || decodedData[3] != 'G') {
+        uint8_t header[24];
+        if (stream.read(header, sizeof(header)) != int(sizeof(header)) || header[0] != 0x89 || header[1] != 'P' || header[2] != 'N' || header[3] != 'G') {
             Serial.println("Invalid PNG format");
-            delete[] decodedData;
             return false;
         }
 
         // 幅と高さを取得 (ビッグエンディアン)
-        m_width = (decodedData[16] << 24) | (decodedData[17] << 16) | (decodedData[18] << 8) | decodedData[19];
-        m_height = (decodedData[20] << 24) | (decodedData[21] << 16) | (decodedData[22] << 8) | decodedData[23];
+        m_width = (header[16] << 24) | (header[17] << 16) | (header[18] << 8) | header[19];
+        m_height = (header[20] << 24) | (header[21] << 16) | (header[22] << 8) | header[23];
         
         Serial.printf("Image dimensions from PNG header: %dx%d\n", m_width, m_height);
 
         // 実際のサイズでスプライトを作成
         if (!m_canvas->createSprite(m_width, m_height)) {
             Serial.println("Failed to create sprite");
-            delete[] decodedData;
             return false;
         }
 
         
-        // PNG画像を描画
-        if (!m_canvas->drawPng(decodedData, actualLen, 0, 0)) {
+        // PNG画像を描画 (先頭から読み直す)
+        stream.seek(0);
+        if (!m_canvas->drawPng(&stream, 0, 0)) {
             Serial.println("Failed to draw PNG");
-            delete[] decodedData;
             return false;
         }
 
-        delete[] decodedData;
         m_valid = true;
+        ++m_revision;
         
         Serial.println("Image loaded successfully");
         return true;
     }
 
     bool create(int32_t width, int32_t height, const Color& backgroundColor = Palette::Black) {
-        if (!m_canvas) {
+        if (!prepareCanvas()) {
             Serial.println("Canvas not initialized");
             return false;
         }
@@ -102,49 +118,137 @@ public:
         m_height = height;
         m_canvas->fillSprite(backgroundColor.toRGB565());  
         m_valid = true;
+        ++m_revision;
         return true;
     }
 
     void draw(int32_t x, int32_t y) const {
-        if (m_valid && m_canvas) {
-            m_canvas->pushSprite(&System::getInstance().getCanvas(), x, y);
+        M5SIV3D_PROFILE_SCOPE("Image::draw");
+        if (m_data) {
+            System::Submit(DrawCommand::FlashImage(m_data, x, y, m_width, m_height));
+        } else if (m_valid && m_canvas) {
+            System::Submit(DrawCommand::Sprite(m_canvas, x, y, 1.0f, 1.0f, m_revision));
         }
     }
 
+    // 画像の region の部分を (x, y) に描画する (スプライトシートの 1 コマなど)
+    void drawRegion(int32_t x, int32_t y, const ImageRegion& region) const {
+        M5SIV3D_PROFILE_SCOPE("Image::drawRegion");
+        if (m_data) {
+            System::Submit(DrawCommand::FlashImage(m_data, region, x, y, region.w, region.h));
+        } else if (m_valid && m_canvas) {
+            System::Submit(DrawCommand::SpriteRegion(m_canvas, region, x, y, m_revision));
+        }
+    }
+
+    void drawRegion(int32_t x, int32_t y, int32_t regionX, int32_t regionY, int32_t regionWidth, int32_t regionHeight) const {
+        drawRegion(x, y, ImageRegion(regionX, regionY, regionWidth, regionHeight));
+    }
+
     int32_t width() const { return m_width; }
     int32_t height() const { return m_height; }
-    bool isEmpty() const { return !m_valid || !m_canvas; }
+    uint32_t revision() const { return m_revision; }
+    bool isEmpty() const { return !m_valid || (!m_canvas && !m_data); }
     Math::Vec2i size() const { return Math::Vec2i(m_width, m_height); }
 
-    void draw(int32_t x, int32_t y, float scale_x, float scale_y) const {
-        if (!m_valid || !m_canvas) return;
-        
-        // Calculate scaled dimensions
-        int32_t scaled_w = m_width * scale_x;
-        int32_t scaled_h = m_height * scale_y;
-        
-        // Create temporary canvas for scaling
-        M5Canvas temp(&M5.Display);
-        temp.createSprite(scaled_w, scaled_h);
-        
-        // Scale the image
-        temp.setPivot(0, 0);
-        temp.pushRotateZoom(0, 0, 0, scale_x, scale_y);
-        
-        // Draw the scaled image to the main canvas
-        temp.pushSprite(&System::getInstance().getCanvas(), x, y);
-        
-        // Clean up
-        temp.deleteSprite();
+    // 拡大縮小して描画する (filter が Bilinear なら周りの 4 画素を補間する)
+    // ScaledImageCache に上限を設定していれば、拡大縮小した結果を次のフレームでも使い回す
+    void draw(int32_t x, int32_t y, float scale_x, float scale_y, ImageFilter filter = ImageFilter::Nearest) const {
+        M5SIV3D_PROFILE_SCOPE("Image::draw(scaled)");
+        if (!m_data && (!m_valid || !m_canvas)) return;
+
+        const int32_t w = int32_t(m_width * scale_x + 0.5f);
+        const int32_t h = int32_t(m_height * scale_y + 0.5f);
+        if (w == m_width && h == m_height) {
+            draw(x, y);
+            return;
+        }
+        // 記録した命令は後のフレームで再生されるので、キャッシュの項目を参照させない
+        if (!System::getInstance().isRecording()) {
+            const ImageData source = m_data ? *m_data
+                : ImageData::RGB565(m_width, m_height, static_cast<const uint16_t*>(m_canvas->getBuffer()));
+            uint32_t id = 0;
+            // フラッシュの画像は変わらないので、同じ ImageData を参照する Image どうしで共有する
+            const void* key = m_data ? static_cast<const void*>(m_data) : m_canvas;
+            M5Canvas* cached = ScaledImageCache::getInstance().acquire(source, key, m_data ? 0 : m_revision, w, h, filter, id);
+            if (cached) {
+                System::Submit(DrawCommand::Sprite(cached, x, y, 1.0f, 1.0f, id));
+                return;
+            }
+        }
+
+        // 拡大縮小しながらキャンバスに直接描画する
+        if (m_data) {
+            System::Submit(DrawCommand::FlashImage(m_data, x, y, w, h, filter));
+        } else {
+            System::Submit(DrawCommand::Sprite(m_canvas, x, y, scale_x, scale_y, m_revision, filter));
+        }
     }
 
     // Overload for uniform scaling
-    void draw(int32_t x, int32_t y, float scale) const {
-        draw(x, y, scale, scale);
+    void draw(int32_t x, int32_t y, float scale, ImageFilter filter = ImageFilter::Nearest) const {
+        draw(x, y, scale, scale, filter);
+    }
+
+    // 画像の座標を描画先の座標に移す transform で描画する (回転・拡大縮小・せん断)
+    // 一時的なスプライトは使わず、描画先の各行で画像と重なる区間だけを逆変換で読んで書き込む
+    void draw(const Math::Mat3x2& transform, ImageFilter filter = ImageFilter::Nearest) const {
+        M5SIV3D_PROFILE_SCOPE("Image::draw(transformed)");
+        if (!m_data && (!m_valid || !m_canvas)) return;
+
+        // 整数の平行移動だけなら変換せずに転送する
+        if (transform._11 == 1.0f && transform._12 == 0.0f && transform._21 == 0.0f && transform._22 == 1.0f &&
+            transform._31 == Math::floor(transform._31) && transform._32 == Math::floor(transform._32)) {
+            draw(int32_t(transform._31), int32_t(transform._32));
+            return;
+        }
+
+        ImageTransform inverse;
+        if (!ImageTransform::FromMatrix(transform, inverse)) return;
+
+        // 変換した四隅を囲む範囲
+        const Math::Vec2f corners[] = {
+            transform.transformPoint(Math::Vec2f(0.0f, 0.0f)),
+            transform.transformPoint(Math::Vec2f(float(m_width), 0.0f)),
+            transform.transformPoint(Math::Vec2f(0.0f, float(m_height))),
+            transform.transformPoint(Math::Vec2f(float(m_width), float(m_height))),
+        };
+        float left = corners[0].x, top = corners[0].y, right = left, bottom = top;
+        for (const Math::Vec2f& corner : corners) {
+            left = Math::min(left, corner.x);
+            top = Math::min(top, corner.y);
+            right = Math::max(right, corner.x);
+            bottom = Math::max(bottom, corner.y);
+        }
+        const float limit = 32767.0f;
+        const int32_t x0 = int32_t(Math::floor(Math::clamp(left, -limit, limit)));
+        const int32_t y0 = int32_t(Math::floor(Math::clamp(top, -limit, limit)));
+        const int32_t x1 = int32_t(Math::ceil(Math::clamp(right, -limit, limit)));
+        const int32_t y1 = int32_t(Math::ceil(Math::clamp(bottom, -limit, limit)));
+        const DirtyRect bounds(x0, y0, x1 - x0, y1 - y0);
+
+        if (m_data) {
+            System::Submit(DrawCommand::TransformedFlashImage(m_data, inverse, bounds, filter));
+        } else {
+            System::Submit(DrawCommand::TransformedSprite(m_canvas, inverse, bounds, m_revision, filter));
+        }
+    }
+
+    // 画像の中心を軸に angle (ラジアン、時計回り) 回転して描画する ((x, y) は回転する前の左上)
+    void drawRotated(int32_t x, int32_t y, float angle, ImageFilter filter = ImageFilter::Nearest) const {
+        draw(Math::Mat3x2::Rotate(angle, m_width * 0.5f, m_height * 0.5f) * Math::Mat3x2::Translate(float(x), float(y)), filter);
+    }
+
+    // 画像の (pivotX, pivotY) を (x, y) に置き、そこを軸に angle 回転・scale 倍して描画する (メーターの針など)
+    void drawRotatedAt(float x, float y, float pivotX, float pivotY, float angle, float scale = 1.0f,
+                       ImageFilter filter = ImageFilter::Nearest) const {
+        draw(Math::Mat3x2::Translate(-pivotX, -pivotY) * Math::Mat3x2::Scale(scale, scale) * Math::Mat3x2::Rotate(angle) *
+             Math::Mat3x2::Translate(x, y), filter);
     }
 
     ~Image() {
         if (m_canvas) {
+            ScaledImageCache::getInstance().forget(m_canvas);
             m_canvas->deleteSprite();
             delete m_canvas;
             m_canvas = nullptr;
@@ -0,0 +1,467 @@
+#pragma once
+
+#include "Platform.h"
+#include "DirtyRegion.h"
+#include "Blend.h"
+#include "Math.h"
+#include <stdint.h>
+#include <algorithm>
+
+// フラッシュに置く変換済みの画像
+//
+// tools/image_to_rgb565.py が PNG から生成する constexpr の配列を参照する。
+// 実行時のデコードやキャンバスへのコピーをせず、描画のたびにフラッシュから直接転送する。
+// 画素はキャンバスと同じバイト順 (上位と下位のバイトを入れ替えた RGB565) で持つ。
+//
+//   #include "icon.h"  // constexpr ImageData icon = ImageData::RGB565(...);
+//   const Image image(icon);
+//   image.draw(10, 10);
+struct ImageData
+{
+    enum class Format : uint8_t
+    {
+        RGB565,   // 画素をそのまま並べる (転送時にコピーしない)
+        Indexed8, // 1 画素 1 バイトのパレット番号
+        RLE,      // (画素数, 色) の組を並べる (組は行をまたがない)
+    };
+
+    int32_t width;
+    int32_t height;
+    Format format;
+    const uint16_t *pixels;   // RGB565: width * height 画素、RLE: (画素数, 色) の組
+    const uint8_t *indices;   // Indexed8: width * height 個のパレット番号
+    const uint16_t *palette;  // Indexed8: パレットの色
+    const uint32_t *rows;     // RLE: 各行の先頭の組の位置 (pixels の要素番号)
+
+    constexpr ImageData(int32_t _width, int32_t _height, Format _format, const uint16_t *_pixels,
+                        const uint8_t *_indices, const uint16_t *_palette, const uint32_t *_rows)
+        : width(_width), height(_height), format(_format), pixels(_pixels), indices(_indices), palette(_palette), rows(_rows) {}
+
+    static constexpr ImageData RGB565(int32_t width, int32_t height, const uint16_t *pixels)
+    {
+        return ImageData(width, height, Format::RGB565, pixels, nullptr, nullptr, nullptr);
+    }
+
+    static constexpr ImageData Indexed8(int32_t width, int32_t height, const uint8_t *indices, const uint16_t *palette)
+    {
+        return ImageData(width, height, Format::Indexed8, nullptr, indices, palette, nullptr);
+    }
+
+    static constexpr ImageData RLE(int32_t width, int32_t height, const uint16_t *runs, const uint32_t *rows)
+    {
+        return ImageData(width, height, Format::RLE, runs, nullptr, nullptr, rows);
+    }
+};
+
+// 画像の中の矩形 (画像の左上からの画素単位)
+struct ImageRegion
+{
+    int32_t x;
+    int32_t y;
+    int32_t w;
+    int32_t h;
+
+    constexpr ImageRegion() : x(0), y(0), w(0), h(0) {}
+    constexpr ImageRegion(int32_t _x, int32_t _y, int32_t _w, int32_t _h) : x(_x), y(_y), w(_w), h(_h) {}
+
+    bool isEmpty() const { return w <= 0 || h <= 0; }
+
+    // 画像の範囲に収める
+    ImageRegion clamped(int32_t width, int32_t height) const
+    {
+        const int32_t left = std::max<int32_t>(0, x), top = std::max<int32_t>(0, y);
+        const int32_t right = std::min(width, x + w), bottom = std::min(height, y + h);
+        return ImageRegion(left, top, std::max<int32_t>(0, right - left), std::max<int32_t>(0, bottom - top));
+    }
+};
+
+// 拡大縮小するときの画素の選び方
+enum class ImageFilter : uint8_t
+{
+    Nearest,  // 最も近い画素 (くっきり、速い)
+    Bilinear, // 周りの 4 画素を線形補間 (なめらか)
+};
+
+// 画像の 1 行の画素を読む
+// x は前回と同じか大きい値で呼ぶ (RLE は前回の組から先へ進めるだけで読める)
+class ImageRowReader
+{
+public:
+    ImageRowReader(const ImageData &data, int32_t row)
+        : m_data(data), m_row(row), m_run(nullptr), m_runEnd(0)
+    {
+        if (data.format == ImageData::Format::RLE)
+        {
+            m_run = data.pixels + data.rows[row];
+            m_runEnd = m_run[0];
+        }
+    }
+
+    // キャンバスと同じバイト順の RGB565
+    uint16_t operator()(int32_t x)
+    {
+        switch (m_data.format)
+        {
+        case ImageData::Format::RGB565:
+            return m_data.pixels[m_row * m_data.width + x];
+        case ImageData::Format::Indexed8:
+            return m_data.palette[m_data.indices[m_row * m_data.width + x]];
+        case ImageData::Format::RLE:
+            break;
+        }
+        while (m_runEnd <= x)
+        {
+            m_run += 2;
+            m_runEnd += m_run[0];
+        }
+        return m_run[1];
+    }
+
+private:
+    const ImageData &m_data;
+    int32_t m_row;
+    const uint16_t *m_run;
+    int32_t m_runEnd; // m_run の組の右端 (含まない)
+};
+
+// ImageData の区間の塗り (Blend::FillRect の Painter)
+// 描画先の (left, top) を画像の region の左上とし、描画先の 1 画素ごとに画像の上を stepX, stepY 画素進む
+// (16 ビットの小数部を持つ固定小数点)
+class ImageDataPainter
+{
+public:
+    ImageDataPainter(const ImageData &data, const ImageRegion &region, int32_t left, int32_t top,
+                     int32_t stepX = 0x10000, int32_t stepY = 0x10000, ImageFilter filter = ImageFilter::Nearest)
+        : m_data(data), m_region(region), m_left(left), m_top(top), m_stepX(stepX), m_stepY(stepY), m_filter(filter) {}
+
+    bool readsTarget() const { return false; }
+
+    void paint(lgfx::swap565_t *pixels, int32_t x, int32_t y, int32_t count) const
+    {
+        if (m_filter == ImageFilter::Bilinear && (m_stepX != 0x10000 || m_stepY != 0x10000))
+        {
+            paintBilinear(pixels, x, y, count);
+            return;
+        }
+
+        const int32_t sy = m_region.y + std::min(m_region.h - 1, int32_t((int64_t(y - m_top) * m_stepY + m_stepY / 2) >> 16));
+        if (m_stepX == 0x10000)
+        {
+            paintRow(pixels, m_region.x + x - m_left, sy, count);
+            return;
+        }
+
+        // 画素の中心に最も近い画素を使う (区間の中では画像の x は増える一方)
+        const int32_t last = m_region.w - 1;
+        int64_t position = int64_t(x - m_left) * m_stepX + m_stepX / 2;
+        ImageRowReader row(m_data, sy);
+        for (int32_t i = 0; i < count; ++i, position += m_stepX)
+        {
+            pixels[i].raw = row(m_region.x + std::min(last, int32_t(position >> 16)));
+        }
+    }
+
+    // 広げた RGB565 (Blend::Spread) を weight / 32 の割合で補間する
+    static uint32_t Lerp(uint32_t a, uint32_t b, uint32_t weight)
+    {
+        return ((a * (32 - weight) + b * weight) >> 5) & Blend::SpreadMask;
+    }
+
+    static uint32_t Spread(uint16_t swapped)
+    {
+        return Blend::Spread(Blend::Swap(swapped));
+    }
+
+private:
+    const ImageData &m_data;
+    ImageRegion m_region;
+    int32_t m_left;
+    int32_t m_top;
+    int32_t m_stepX;
+    int32_t m_stepY;
+    ImageFilter m_filter;
+
+    // 描画先の画素の中心に対応する画像の位置を、まわりの 4 画素の中心から補間する
+    void paintBilinear(lgfx::swap565_t *pixels, int32_t x, int32_t y, int32_t count) const
+    {
+        const int64_t maxV = int64_t(m_region.h - 1) << 16;
+        const int64_t v = std::min(maxV, std::max<int64_t>(0, int64_t(y - m_top) * m_stepY + m_stepY / 2 - 0x8000));
+        const int32_t y0 = m_region.y + int32_t(v >> 16);
+        const int32_t y1 = std::min(y0 + 1, m_region.y + m_region.h - 1);
+        const uint32_t fy = uint32_t(v >> 11) & 31;
+
+        // 左右の画素を別々に読み、それぞれの x が増える一方になるようにする
+        ImageRowReader topLeft(m_data, y0), topRight(m_data, y0);
+        ImageRowReader bottomLeft(m_data, y1), bottomRight(m_data, y1);
+
+        const int64_t maxU = int64_t(m_region.w - 1) << 16;
+        const int32_t lastX = m_region.x + m_region.w - 1;
+        int64_t u = int64_t(x - m_left) * m_stepX + m_stepX / 2 - 0x8000;
+        for (int32_t i = 0; i < count; ++i, u += m_stepX)
+        {
+            const int64_t clamped = std::min(maxU, std::max<int64_t>(0, u));
+            const int32_t x0 = m_region.x + int32_t(clamped >> 16);
+            const int32_t x1 = std::min(x0 + 1, lastX);
+            const uint32_t fx = uint32_t(clamped >> 11) & 31;
+            const uint32_t top = Lerp(Spread(topLeft(x0)), Spread(topRight(x1)), fx);
+            const uint32_t bottom = Lerp(Spread(bottomLeft(x0)), Spread(bottomRight(x1)), fx);
+            pixels[i].raw = Blend::Swap(Blend::Pack(Lerp(top, bottom, fy)));
+        }
+    }
+
+    // 画像の sy 行目の sx から count 画素
+    void paintRow(lgfx::swap565_t *pixels, int32_t sx, int32_t sy, int32_t count) const
+    {
+        switch (m_data.format)
+        {
+        case ImageData::Format::RGB565:
+        {
+            const uint16_t *source = m_data.pixels + sy * m_data.width + sx;
+            for (int32_t i = 0; i < count; ++i)
+            {
+                pixels[i].raw = source[i];
+            }
+            break;
+        }
+        case ImageData::Format::Indexed8:
+        {
+            const uint8_t *source = m_data.indices + sy * m_data.width + sx;
+            for (int32_t i = 0; i < count; ++i)
+            {
+                pixels[i].raw = m_data.palette[source[i]];
+            }
+            break;
+        }
+        case ImageData::Format::RLE:
+        {
+            // 行の先頭から sx を含む組まで進める
+            const uint16_t *run = m_data.pixels + m_data.rows[sy];
+            int32_t position = 0;
+            while (position + run[0] <= sx)
+            {
+                position += run[0];
+                run += 2;
+            }
+            int32_t remaining = position + run[0] - sx;
+            for (int32_t i = 0; i < count; ++i)
+            {
+                if (remaining == 0)
+                {
+                    run += 2;
+                    remaining = run[0];
+                }
+                pixels[i].raw = run[1];
+                --remaining;
+            }
+            break;
+        }
+        }
+    }
+};
+
+// 描画先から画像への逆変換 (16 ビットの小数部を持つ固定小数点)
+// 描画先の画素 (x, y) の中心は、画像の (ux * x + uy * y + u0, vx * x + vy * y + v0) に対応する
+struct ImageTransform
+{
+    int32_t ux, uy, u0;
+    int32_t vx, vy, v0;
+
+    // 画像の座標を描画先の座標に移す変換から作る (逆変換できない場合や固定小数点に収まらない場合は false)
+    static bool FromMatrix(const Math::Mat3x2 &transform, ImageTransform &result)
+    {
+        if (Math::abs(transform.determinant()) < 1e-6f)
+        {
+            return false;
+        }
+        const Math::Mat3x2 inv = transform.inverse();
+        return ToFixed(inv._11, result.ux) && ToFixed(inv._21, result.uy) && ToFixed(inv._31 + (inv._11 + inv._21) * 0.5f, result.u0) &&
+               ToFixed(inv._12, result.vx) && ToFixed(inv._22, result.vy) && ToFixed(inv._32 + (inv._12 + inv._22) * 0.5f, result.v0);
+    }
+
+    // 描画先を (dx, dy) ずらしたときの逆変換
+    ImageTransform translated(int32_t dx, int32_t dy) const
+    {
+        ImageTransform result = *this;
+        result.u0 = int32_t(u0 - int64_t(ux) * dx - int64_t(uy) * dy);
+        result.v0 = int32_t(v0 - int64_t(vx) * dx - int64_t(vy) * dy);
+        return result;
+    }
+
+private:
+    static bool ToFixed(float value, int32_t &result)
+    {
+        if (!(Math::abs(value) < 32767.0f))
+        {
+            return false;
+        }
+        result = int32_t(Math::floor(value * 65536.0f + 0.5f));
+        return true;
+    }
+};
+
+// 変換した ImageData の区間の塗り (Blend::Span の Painter)
+// 描画先の画素ごとに逆変換で画像の位置を求めて読む (区間は画像の内側に限ること)
+class ImageTransformPainter
+{
+public:
+    ImageTransformPainter(const ImageData &data, const ImageTransform &transform, ImageFilter filter)
+        : m_data(data), m_transform(transform), m_filter(filter) {}
+
+    bool readsTarget() const { return false; }
+
+    void paint(lgfx::swap565_t *pixels, int32_t x, int32_t y, int32_t count) const
+    {
+        const ImageTransform &t = m_transform;
+        int64_t u = int64_t(t.ux) * x + int64_t(t.uy) * y + t.u0;
+        int64_t v = int64_t(t.vx) * x + int64_t(t.vy) * y + t.v0;
+        const int32_t lastX = m_data.width - 1;
+        const int32_t lastY = m_data.height - 1;
+
+        if (m_filter == ImageFilter::Nearest)
+        {
+            for (int32_t i = 0; i < count; ++i, u += t.ux, v += t.vx)
+            {
+                const int32_t sx = std::min(lastX, std::max<int32_t>(0, int32_t(u >> 16)));
+                const int32_t sy = std::min(lastY, std::max<int32_t>(0, int32_t(v >> 16)));
+                pixels[i].raw = Fetch(sx, sy);
+            }
+            return;
+        }
+
+        // まわりの 4 画素の中心から補間する (画像の端では端の画素を使う)
+        const int64_t maxU = int64_t(lastX) << 16;
+        const int64_t maxV = int64_t(lastY) << 16;
+        for (int32_t i = 0; i < count; ++i, u += t.ux, v += t.vx)
+        {
+            const int64_t cu = std::min(maxU, std::max<int64_t>(0, u - 0x8000));
+            const int64_t cv = std::min(maxV, std::max<int64_t>(0, v - 0x8000));
+            const int32_t x0 = int32_t(cu >> 16), y0 = int32_t(cv >> 16);
+            const int32_t x1 = std::min(x0 + 1, lastX), y1 = std::min(y0 + 1, lastY);
+            const uint32_t fx = uint32_t(cu >> 11) & 31;
+            const uint32_t fy = uint32_t(cv >> 11) & 31;
+            const uint32_t top = ImageDataPainter::Lerp(ImageDataPainter::Spread(Fetch(x0, y0)), ImageDataPainter::Spread(Fetch(x1, y0)), fx);
+            const uint32_t bottom = ImageDataPainter::Lerp(ImageDataPainter::Spread(Fetch(x0, y1)), ImageDataPainter::Spread(Fetch(x1, y1)), fx);
+            pixels[i].raw = Blend::Swap(Blend::Pack(ImageDataPainter::Lerp(top, bottom, fy)));
+        }
+    }
+
+private:
+    const ImageData &m_data;
+    ImageTransform m_transform;
+    ImageFilter m_filter;
+
+    // 画素の位置は行をまたいで動くので 1 画素ずつ読む (RLE は行の先頭から数える)
+    uint16_t Fetch(int32_t x, int32_t y) const
+    {
+        return ImageRowReader(m_data, y)(x);
+    }
+};
+
+namespace ImageBlit
+{
+    // 画像の region の部分を (x, y) に w x h の大きさで描画する (拡大縮小する場合は filter で画素を選ぶ)
+    // RGB565 を拡大縮小しない場合は配列をそのまま転送し、それ以外は行ごとに展開しながら転送する
+    // 一時的なスプライトは使わず、描画先のクリップ領域の中だけを 1 行ずつ書き込む
+    inline void DrawRegion(lgfx::LovyanGFX &target, const ImageData &data, const ImageRegion &region,
+                           int32_t x, int32_t y, int32_t w, int32_t h, ImageFilter filter = ImageFilter::Nearest)
+    {
+        const ImageRegion source = region.clamped(data.width, data.height);
+        if (source.isEmpty() || w <= 0 || h <= 0)
+        {
+            return;
+        }
+
+        // 範囲外を切り詰めた分だけ描画先もずらす
+        if (w == region.w && h == region.h)
+        {
+            x += source.x - region.x;
+            y += source.y - region.y;
+            w = source.w;
+            h = source.h;
+        }
+        if (w != source.w || h != source.h)
+        {
+            const int32_t stepX = int32_t((int64_t(source.w) << 16) / w);
+            const int32_t stepY = int32_t((int64_t(source.h) << 16) / h);
+            Blend::FillRect(target, x, y, w, h, ImageDataPainter(data, source, x, y, stepX, stepY, filter));
+            return;
+        }
+        if (data.format != ImageData::Format::RGB565)
+        {
+            Blend::FillRect(target, x, y, w, h, ImageDataPainter(data, source, x, y));
+            return;
+        }
+
+        const lgfx::swap565_t *pixels = reinterpret_cast<const lgfx::swap565_t *>(data.pixels);
+        if (source.w == data.width)
+        {
+            // 行が続いているので 1 回で転送する
+            target.pushImage(x, y, w, h, pixels + source.y * data.width);
+            return;
+        }
+        const DirtyRect clip = Blend::ClipArea(target);
+        const int32_t top = std::max(y, clip.y);
+        const int32_t bottom = std::min(y + h, clip.y + clip.h);
+        for (int32_t row = top; row < bottom; ++row)
+        {
+            target.pushImage(x, row, w, 1, pixels + (source.y + row - y) * data.width + source.x);
+        }
+    }
+
+    // step * x + k が 0 以上 limit 以下になる x に [left, right] を狭める (なければ false)
+    inline bool NarrowSpan(int64_t step, int64_t k, int64_t limit, int32_t &left, int32_t &right)
+    {
+        const auto floorDiv = [](int64_t a, int64_t b) -> int64_t {
+            return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+        };
+        if (step == 0)
+        {
+            return 0 <= k && k <= limit;
+        }
+        const int64_t low = (step > 0) ? -floorDiv(k, step) : -floorDiv(k - limit, step);
+        const int64_t high = (step > 0) ? floorDiv(limit - k, step) : floorDiv(-k, step);
+        left = int32_t(std::max<int64_t>(left, low));
+        right = int32_t(std::min<int64_t>(right, high));
+        return left <= right;
+    }
+
+    // 画像を transform で変換して描画する (回転・拡大縮小・せん断)
+    // bounds は描画される範囲で、その中の各行で画像の内側になる区間だけを計算して書き込む
+    inline void DrawTransformed(lgfx::LovyanGFX &target, const ImageData &data, const ImageTransform &transform,
+                                const DirtyRect &bounds, ImageFilter filter = ImageFilter::Nearest)
+    {
+        const DirtyRect clip = Blend::ClipArea(target);
+        const DirtyRect area = bounds.intersected(clip);
+        if (area.isEmpty() || data.width <= 0 || data.height <= 0)
+        {
+            return;
+        }
+
+        const ImageTransformPainter painter(data, transform, filter);
+        const int64_t maxU = (int64_t(data.width) << 16) - 1;
+        const int64_t maxV = (int64_t(data.height) << 16) - 1;
+        for (int32_t row = area.y; row < area.bottom(); ++row)
+        {
+            int32_t left = area.x;
+            int32_t right = area.right() - 1;
+            if (NarrowSpan(transform.ux, int64_t(transform.uy) * row + transform.u0, maxU, left, right) &&
+                NarrowSpan(transform.vx, int64_t(transform.vy) * row + transform.v0, maxV, left, right))
+            {
+                Blend::Span(target, clip, left, right, row, painter);
+            }
+        }
+    }
+
+    // 画像全体を (x, y) に描画する
+    inline void Draw(lgfx::LovyanGFX &target, const ImageData &data, int32_t x, int32_t y)
+    {
+        DrawRegion(target, data, ImageRegion(0, 0, data.width, data.height), x, y, data.width, data.height);
+    }
+
+    // 画像全体を (x, y) に w x h の大きさで描画する
+    inline void DrawScaled(lgfx::LovyanGFX &target, const ImageData &data, int32_t x, int32_t y, int32_t w, int32_t h,
+                           ImageFilter filter = ImageFilter::Nearest)
+    {
+        DrawRegion(target, data, ImageRegion(0, 0, data.width, data.height), x, y, w, h, filter);
+    }
+}
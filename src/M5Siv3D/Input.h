@@ -1,7 +1,8 @@
 #pragma once
 
-#include <M5Unified.h>
+#include "Platform.h"
 #include "Math.h"
+#include "InputLog.h"
 
 namespace Input
 {
@@ -10,15 +11,49 @@ namespace Input
     private:
         m5::Button_Class *m_button;
 
+        // リプレイ中の状態 (時刻は記録した時間で進める)
+        bool m_replaying = false;
+        bool m_replayPressed = false;
+        bool m_replayPrevious = false;
+        uint32_t m_replayChangedAt = 0;
+        uint32_t m_replayNow = 0;
+
     public:
         ButtonState(m5::Button_Class *btn) : m_button(btn) {}
 
-        bool down() const { return m_button->isPressed(); }
-        bool up() const { return m_button->isReleased(); }
-        bool pressed() const { return m_button->wasPressed(); }
-        bool released() const { return m_button->wasReleased(); }
-        bool pressedDuration(uint32_t ms) const { return m_button->pressedFor(ms); }
-        bool releasedDuration(uint32_t ms) const { return m_button->releasedFor(ms); }
+        bool down() const { return m_replaying ? m_replayPressed : m_button->isPressed(); }
+        bool up() const { return m_replaying ? !m_replayPressed : m_button->isReleased(); }
+        bool pressed() const { return m_replaying ? (m_replayPressed && !m_replayPrevious) : m_button->wasPressed(); }
+        bool released() const { return m_replaying ? (!m_replayPressed && m_replayPrevious) : m_button->wasReleased(); }
+        bool pressedDuration(uint32_t ms) const
+        {
+            return m_replaying ? (m_replayPressed && m_replayNow - m_replayChangedAt >= ms) : m_button->pressedFor(ms);
+        }
+        bool releasedDuration(uint32_t ms) const
+        {
+            return m_replaying ? (!m_replayPressed && m_replayNow - m_replayChangedAt >= ms) : m_button->releasedFor(ms);
+        }
+
+        // リプレイの入力を設定する (InputManager から呼び出される)
+        void setReplayState(bool pressed, uint32_t nowMillis)
+        {
+            if (!m_replaying)
+            {
+                m_replaying = true;
+                m_replayPressed = m_button->isPressed();
+                m_replayChangedAt = nowMillis;
+            }
+            m_replayPrevious = m_replayPressed;
+            m_replayPressed = pressed;
+            if (m_replayPressed != m_replayPrevious)
+            {
+                m_replayChangedAt = nowMillis;
+            }
+            m_replayNow = nowMillis;
+        }
+
+        // 実際のボタンの状態に戻す
+        void clearReplay() { m_replaying = false; }
     };
 
     // グローバルなボタンステート
@@ -81,6 +116,10 @@ namespace Input
         // 加速度を取得 (G)
         Math::Vec3f getAccel() const
         {
+            if (m_replaying)
+            {
+                return m_replayAccel;
+            }
             auto data = M5.Imu.getImuData();
             return Math::Vec3f(data.accel.x, data.accel.y, data.accel.z);
         }
@@ -88,6 +127,10 @@ namespace Input
         // 角速度を取得 (deg/s)
         Math::Vec3f getGyro() const
         {
+            if (m_replaying)
+            {
+                return m_replayGyro;
+            }
             auto data = M5.Imu.getImuData();
             return Math::Vec3f(data.gyro.x, data.gyro.y, data.gyro.z);
         }
@@ -99,6 +142,18 @@ namespace Input
             return Math::Vec3f(data.mag.x, data.mag.y, data.mag.z);
         }
 
+        // リプレイの加速度と角速度を設定する (InputManager から呼び出される)
+        // 地磁気は記録しないので、リプレイ中も実際の値を返す
+        void setReplayData(const Math::Vec3f &accel, const Math::Vec3f &gyro)
+        {
+            m_replaying = true;
+            m_replayAccel = accel;
+            m_replayGyro = gyro;
+        }
+
+        // 実際のセンサーの値に戻す
+        void clearReplay() { m_replaying = false; }
+
     private:
         IMU() : m_currentAngles{0.0f, 0.0f, 0.0f} {}
 
@@ -110,6 +165,10 @@ namespace Input
         }
 
         EulerAngles m_currentAngles;  // 現在の姿勢角度
+
+        bool m_replaying = false;
+        Math::Vec3f m_replayAccel;
+        Math::Vec3f m_replayGyro;
     };
 
     // グローバルなIMUインスタンス
@@ -138,6 +197,15 @@ namespace Input
             }
         }
 
+        // リプレイの入力で状態を更新する（InputManagerから呼び出される）
+        void setReplayState(int32_t x, int32_t y, bool pressed)
+        {
+            m_previousTouchState = m_currentTouchState;
+            m_currentTouchState.pressed = pressed;
+            m_currentTouchState.x = x;
+            m_currentTouchState.y = y;
+        }
+
         // 現在のタッチ位置を取得
         Math::Vec2i pos() const
         {
@@ -179,6 +247,15 @@ namespace Input
     // グローバルなタッチ入力インスタンス
     inline TouchInput& Touch = TouchInput::getInstance();
 
+    // 入力の更新と、記録・リプレイを管理するクラス
+    //
+    //   InputLog log;
+    //   InputManager::StartRecording(log); // 以降の入力をフレームごとに記録する
+    //   ...
+    //   InputManager::StartReplay(log);    // 記録した入力と DeltaTime を再現する
+    //
+    // リプレイ中はボタン・タッチ・IMU の実際の入力を無視し、
+    // 記録が終わると実際の入力に戻る。
     class InputManager
     {
     public:
@@ -188,14 +265,123 @@ namespace Input
             return instance;
         }
 
-        void update()
+        // frameMicros は前のフレームからの経過時間 (System::Update から渡される)
+        void update(uint32_t frameMicros = 0)
         {
             M5.update();  // M5の状態を更新
             M5.Imu.update();
+
+            if (m_replayLog && m_replayIndex >= m_replayLog->size())
+            {
+                stopReplay();
+            }
+
+            if (m_replayLog)
+            {
+                applyFrame((*m_replayLog)[m_replayIndex++]);
+                return;
+            }
+
             Touch.update();
+            m_frameMicros = frameMicros;
+            if (m_recordLog)
+            {
+                m_recordLog->append(captureFrame());
+            }
+        }
+
+        // このフレームの経過時間 (リプレイ中は記録した時間)
+        uint32_t frameMicros() const { return m_frameMicros; }
+
+        // 入力の記録を開始する (log は記録を止めるまで破棄しないこと)
+        void startRecording(InputLog &log)
+        {
+            m_recordLog = &log;
+        }
+
+        void stopRecording()
+        {
+            m_recordLog = nullptr;
+        }
+
+        // 記録した入力の再生を開始する (log は再生が終わるまで破棄しないこと)
+        void startReplay(const InputLog &log)
+        {
+            m_replayLog = &log;
+            m_replayIndex = 0;
+            m_replayMicros = 0;
         }
 
+        void stopReplay()
+        {
+            if (!m_replayLog)
+            {
+                return;
+            }
+            m_replayLog = nullptr;
+            ButtonA.clearReplay();
+            ButtonB.clearReplay();
+            ButtonC.clearReplay();
+            IMU.clearReplay();
+        }
+
+        bool isRecording() const { return m_recordLog != nullptr; }
+        bool isReplaying() const { return m_replayLog != nullptr; }
+
+        // 再生したフレーム数
+        size_t replayPosition() const { return m_replayIndex; }
+
+        static void StartRecording(InputLog &log) { getInstance().startRecording(log); }
+        static void StopRecording() { getInstance().stopRecording(); }
+        static void StartReplay(const InputLog &log) { getInstance().startReplay(log); }
+        static void StopReplay() { getInstance().stopReplay(); }
+        static bool IsRecording() { return getInstance().isRecording(); }
+        static bool IsReplaying() { return getInstance().isReplaying(); }
+
     private:
         InputManager() = default;
+
+        InputFrame captureFrame() const
+        {
+            InputFrame frame;
+            frame.deltaMicros = m_frameMicros;
+            const Math::Vec2i pos = Touch.pos();
+            frame.touchX = int16_t(pos.x);
+            frame.touchY = int16_t(pos.y);
+            frame.buttons = (Touch.pressed() ? InputFrame::TouchPressed : 0) |
+                            (ButtonA.down() ? InputFrame::ButtonAPressed : 0) |
+                            (ButtonB.down() ? InputFrame::ButtonBPressed : 0) |
+                            (ButtonC.down() ? InputFrame::ButtonCPressed : 0);
+            const Math::Vec3f accel = IMU.getAccel();
+            const Math::Vec3f gyro = IMU.getGyro();
+            frame.accel[0] = InputFrame::EncodeAccel(accel.x);
+            frame.accel[1] = InputFrame::EncodeAccel(accel.y);
+            frame.accel[2] = InputFrame::EncodeAccel(accel.z);
+            frame.gyro[0] = InputFrame::EncodeGyro(gyro.x);
+            frame.gyro[1] = InputFrame::EncodeGyro(gyro.y);
+            frame.gyro[2] = InputFrame::EncodeGyro(gyro.z);
+            return frame;
+        }
+
+        void applyFrame(const InputFrame &frame)
+        {
+            m_frameMicros = frame.deltaMicros;
+            m_replayMicros += frame.deltaMicros;
+            const uint32_t nowMillis = uint32_t(m_replayMicros / 1000);
+
+            ButtonA.setReplayState(frame.isPressed(InputFrame::ButtonAPressed), nowMillis);
+            ButtonB.setReplayState(frame.isPressed(InputFrame::ButtonBPressed), nowMillis);
+            ButtonC.setReplayState(frame.isPressed(InputFrame::ButtonCPressed), nowMillis);
+            Touch.setReplayState(frame.touchX, frame.touchY, frame.isPressed(InputFrame::TouchPressed));
+            IMU.setReplayData(
+                Math::Vec3f(InputFrame::DecodeAccel(frame.accel[0]), InputFrame::DecodeAccel(frame.accel[1]), InputFrame::DecodeAccel(frame.accel[2])),
+                Math::Vec3f(InputFrame::DecodeGyro(frame.gyro[0]), InputFrame::DecodeGyro(frame.gyro[1]), InputFrame::DecodeGyro(frame.gyro[2])));
+        }
+
+        uint32_t m_frameMicros = 0;
+        InputLog *m_recordLog = nullptr;
+        const InputLog *m_replayLog = nullptr;
+        size_t m_replayIndex = 0;
+        uint64_t m_replayMicros = 0;
     };
-} 
\ No newline at end of file
+}
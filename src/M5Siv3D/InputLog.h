@@ -0,0 +1,199 @@
+#pragma once
+
+#include "Platform.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+namespace Input
+{
+    // 1 フレーム分の入力
+    struct InputFrame
+    {
+        // buttons のビット
+        static constexpr uint8_t TouchPressed = 0x01;
+        static constexpr uint8_t ButtonAPressed = 0x02;
+        static constexpr uint8_t ButtonBPressed = 0x04;
+        static constexpr uint8_t ButtonCPressed = 0x08;
+
+        uint32_t deltaMicros; // 前のフレームからの経過時間
+        int16_t touchX;
+        int16_t touchY;
+        uint8_t buttons;      // 押されているボタンとタッチ (押した・離したフレームは前後の比較で求める)
+        int16_t accel[3];     // 加速度 (mG)
+        int16_t gyro[3];      // 角速度 (0.1 deg/s)
+
+        bool isPressed(uint8_t bit) const { return (buttons & bit) != 0; }
+
+        // 加速度 (G) と角速度 (deg/s) から記録用の値を作る
+        static int16_t EncodeAccel(float g) { return Saturate(g * 1000.0f); }
+        static int16_t EncodeGyro(float dps) { return Saturate(dps * 10.0f); }
+        static float DecodeAccel(int16_t value) { return value / 1000.0f; }
+        static float DecodeGyro(int16_t value) { return value / 10.0f; }
+
+    private:
+        static int16_t Saturate(float value)
+        {
+            const float rounded = value < 0 ? value - 0.5f : value + 0.5f;
+            return int16_t(std::max(-32768.0f, std::min(32767.0f, rounded)));
+        }
+    };
+
+    // フレームごとの入力の記録
+    // InputManager::StartRecording で記録し、StartReplay で同じ入力を再現する。
+    // 1 フレームは 22 バイト (60fps で 1 分あたり約 80KB)。
+    //
+    // 保存形式 (値はリトルエンディアン)
+    //   "M5IN" u8:version u8:recordSize u16:0 u32:frameCount
+    //   frameCount × { u32:deltaMicros i16:touchX i16:touchY u8:buttons u8:0 i16[3]:accel i16[3]:gyro }
+    class InputLog
+    {
+    public:
+        static constexpr uint8_t FormatVersion = 1;
+        static constexpr size_t RecordSize = 22;
+        static constexpr size_t HeaderSize = 12;
+
+        // 読み込めるフレーム数の上限 (バイト数が size_t に収まる数)
+        static constexpr size_t MaxFrames = SIZE_MAX / RecordSize;
+
+        void clear() { m_data.clear(); }
+
+        bool isEmpty() const { return m_data.empty(); }
+
+        // 記録したフレーム数
+        size_t size() const { return m_data.size() / RecordSize; }
+
+        // 記録に使っているバイト数
+        size_t bytes() const { return m_data.size(); }
+
+        void append(const InputFrame &frame)
+        {
+            uint8_t record[RecordSize];
+            putU32(record, frame.deltaMicros);
+            putU16(record + 4, uint16_t(frame.touchX));
+            putU16(record + 6, uint16_t(frame.touchY));
+            record[8] = frame.buttons;
+            record[9] = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                putU16(record + 10 + i * 2, uint16_t(frame.accel[i]));
+                putU16(record + 16 + i * 2, uint16_t(frame.gyro[i]));
+            }
+            m_data.insert(m_data.end(), record, record + RecordSize);
+        }
+
+        // index 番目のフレーム
+        InputFrame operator[](size_t index) const
+        {
+            const uint8_t *record = m_data.data() + index * RecordSize;
+            InputFrame frame;
+            frame.deltaMicros = getU32(record);
+            frame.touchX = int16_t(getU16(record + 4));
+            frame.touchY = int16_t(getU16(record + 6));
+            frame.buttons = record[8];
+            for (int i = 0; i < 3; ++i)
+            {
+                frame.accel[i] = int16_t(getU16(record + 10 + i * 2));
+                frame.gyro[i] = int16_t(getU16(record + 16 + i * 2));
+            }
+            return frame;
+        }
+
+        // 記録を書き出す (SD カードのファイルやシリアルなど)
+        void write(Stream &stream) const
+        {
+            uint8_t header[HeaderSize] = {'M', '5', 'I', 'N', FormatVersion, uint8_t(RecordSize), 0, 0};
+            putU32(header + 8, uint32_t(size()));
+            stream.write(header, sizeof(header));
+            stream.write(m_data.data(), m_data.size());
+        }
+
+        // write で書き出した記録を読み込む
+        // ヘッダのフレーム数は壊れていることがあるので、先にまとめて確保せず、読めた分だけ広げていく
+        bool read(Stream &stream)
+        {
+            uint8_t header[HeaderSize];
+            if (stream.readBytes(header, sizeof(header)) != sizeof(header) || !isValidHeader(header))
+            {
+                Serial.println("InputLog: invalid header");
+                return false;
+            }
+            const uint32_t frameCount = getU32(header + 8);
+            if (frameCount > MaxFrames)
+            {
+                Serial.println("InputLog: too many frames");
+                return false;
+            }
+
+            std::vector<uint8_t> data;
+            for (uint32_t frame = 0; frame < frameCount;)
+            {
+                const uint32_t chunkFrames = std::min(frameCount - frame, uint32_t(ReadChunkFrames));
+                const size_t offset = data.size();
+                data.resize(offset + chunkFrames * RecordSize);
+                if (stream.readBytes(data.data() + offset, chunkFrames * RecordSize) != chunkFrames * RecordSize)
+                {
+                    Serial.println("InputLog: truncated log");
+                    return false;
+                }
+                frame += chunkFrames;
+            }
+            m_data.swap(data);
+            return true;
+        }
+
+        // メモリ上 (PROGMEM の配列など) の記録を読み込む
+        bool read(const uint8_t *data, size_t length)
+        {
+            if (length < HeaderSize || !isValidHeader(data))
+            {
+                Serial.println("InputLog: invalid header");
+                return false;
+            }
+            const uint32_t frameCount = getU32(data + 8);
+            if (frameCount > (length - HeaderSize) / RecordSize)
+            {
+                Serial.println("InputLog: truncated log");
+                return false;
+            }
+            const size_t dataBytes = size_t(frameCount) * RecordSize;
+            m_data.assign(data + HeaderSize, data + HeaderSize + dataBytes);
+            return true;
+        }
+
+    private:
+        // Stream から 1 度に読み込むフレーム数
+        static constexpr uint32_t ReadChunkFrames = 64;
+
+        std::vector<uint8_t> m_data;
+
+        static bool isValidHeader(const uint8_t *header)
+        {
+            return memcmp(header, "M5IN", 4) == 0 && header[4] == FormatVersion && header[5] == RecordSize;
+        }
+
+        static void putU16(uint8_t *out, uint16_t value)
+        {
+            out[0] = uint8_t(value);
+            out[1] = uint8_t(value >> 8);
+        }
+
+        static void putU32(uint8_t *out, uint32_t value)
+        {
+            putU16(out, uint16_t(value));
+            putU16(out + 2, uint16_t(value >> 16));
+        }
+
+        static uint16_t getU16(const uint8_t *in)
+        {
+            return uint16_t(in[0] | (in[1] << 8));
+        }
+
+        static uint32_t getU32(const uint8_t *in)
+        {
+            return getU16(in) | (uint32_t(getU16(in + 2)) << 16);
+        }
+    };
+}
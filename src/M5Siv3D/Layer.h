@@ -0,0 +1,181 @@
+#pragma once
+
+#include "Platform.h"
+#include "Math.h"
+#include "Color.h"
+#include "Palette.h"
+#include "System.h"
+
+// 画面に重ねて表示するレイヤー
+//
+// レイヤーは自分のスプライトを持ち、描画命令が変わったときだけスプライトを描き直す。
+// 毎フレームの合成はスプライトの転送だけなので、目盛りやラベルのような静的な UI を
+// 毎フレーム描き直す必要がなくなる。
+//
+//   Layer gauge(0, 0, 320, 240, -1); // z < 0: そのフレームの描画より下に合成する
+//
+//   void loop()
+//   {
+//       // 無効化されているとき (初回) だけラムダを呼んで描き直す
+//       gauge.paint([] { Circle(160, 120, 100).drawFrame(Palette::White); });
+//       Line(160, 120, needleX, needleY).draw(Palette::Red);
+//   }
+//
+// paint() の中の描画命令は、レイヤーの左上を原点とする座標で記録される。
+// 合成は System への描画命令として行うので、転送方法や更新領域の検出はそのまま働く
+// (SetDamageDetection が有効なら、内容も位置も変わらないレイヤーは転送されない)。
+// 背面のレイヤー (z < 0) は beginDraw で合成するので、描き直しは次のフレームから反映される。
+// 最初の paint() (または setCommands / setColorKey / setBackgroundColor) までは何も合成しない。
+class Layer : public LayerBase
+{
+public:
+    Layer(int32_t x, int32_t y, int32_t width, int32_t height, int32_t z = 0)
+        : m_x(x), m_y(y), m_z(z)
+    {
+        m_sprite.setColorDepth(16);
+        if (!m_sprite.createSprite(width, height))
+        {
+            Serial.printf("Layer: failed to create %dx%d sprite\n", int(width), int(height));
+        }
+        System::getInstance().addLayer(this);
+    }
+
+    // フレームの描画中 (合成した命令が転送されるまで) に破棄しないこと
+    ~Layer()
+    {
+        System::getInstance().removeLayer(this);
+        m_sprite.deleteSprite();
+    }
+
+    // 無効化されていれば painter() を呼び、その描画命令でスプライトを描き直す
+    // 描き直した場合は true を返す
+    template <class Painter>
+    bool paint(Painter painter)
+    {
+        if (!m_invalid)
+        {
+            return false;
+        }
+
+        m_commands.clear();
+        {
+            RecordingScope recording(m_commands);
+            painter();
+        }
+        m_invalid = false;
+        rasterize();
+        return true;
+    }
+
+    // 記録済みの描画命令 (レイヤーの左上が原点) でスプライトを描き直す
+    void setCommands(const DisplayList &commands)
+    {
+        m_commands = commands;
+        m_invalid = false;
+        rasterize();
+    }
+
+    // 次の paint() で描き直す
+    void invalidate() { m_invalid = true; }
+    bool isInvalid() const { return m_invalid; }
+
+    void setPosition(int32_t x, int32_t y)
+    {
+        m_x = x;
+        m_y = y;
+    }
+
+    void setPosition(const Math::Vec2i &pos)
+    {
+        setPosition(pos.x, pos.y);
+    }
+
+    // 重ね順 (負の値はそのフレームの描画より下、0 以上は上。同じ値なら先に作ったものが下)
+    void setZ(int32_t z)
+    {
+        m_z = z;
+        System::getInstance().sortLayers();
+    }
+
+    void setVisible(bool visible) { m_visible = visible; }
+
+    // 透過色の設定 (この色で塗りつぶしてから描画し、合成時にこの色の画素を描画しない)
+    void setColorKey(const Color &color)
+    {
+        m_hasColorKey = true;
+        m_colorKey = color.toRGB565();
+        rasterize();
+    }
+
+    void clearColorKey()
+    {
+        m_hasColorKey = false;
+        rasterize();
+    }
+
+    // 透過色を使わないときの背景色
+    void setBackgroundColor(const Color &color)
+    {
+        m_backgroundColor = color.toRGB565();
+        rasterize();
+    }
+
+    int32_t x() const { return m_x; }
+    int32_t y() const { return m_y; }
+    int32_t width() const { return m_sprite.width(); }
+    int32_t height() const { return m_sprite.height(); }
+    int32_t getZ() const override { return m_z; }
+    bool isVisible() const { return m_visible; }
+    bool isEmpty() const { return m_sprite.getBuffer() == nullptr; }
+
+    // スプライトを描き直すたびに増える値
+    uint32_t revision() const { return m_revision; }
+
+    // スプライトの描画に使っている命令
+    const DisplayList &commands() const { return m_commands; }
+
+    void composite() override
+    {
+        // 1 度も描いていないスプライトは中身が不定なので合成しない
+        if (!m_visible || isEmpty() || m_revision == 0)
+        {
+            return;
+        }
+        if (m_hasColorKey)
+        {
+            System::Submit(DrawCommand::TransparentSprite(&m_sprite, m_x, m_y, m_colorKey, m_revision));
+        }
+        else
+        {
+            System::Submit(DrawCommand::Sprite(&m_sprite, m_x, m_y, 1.0f, 1.0f, m_revision));
+        }
+    }
+
+private:
+    M5Canvas m_sprite{&M5.Display};
+    DisplayList m_commands;
+    int32_t m_x;
+    int32_t m_y;
+    int32_t m_z;
+    bool m_visible = true;
+    bool m_invalid = true;
+    bool m_hasColorKey = false;
+    uint16_t m_colorKey = 0;
+    uint16_t m_backgroundColor = Palette::Black.toRGB565();
+    uint32_t m_revision = 0;
+
+    // コピー禁止
+    Layer(const Layer &) = delete;
+    Layer &operator=(const Layer &) = delete;
+
+    void rasterize()
+    {
+        if (isEmpty())
+        {
+            return;
+        }
+        m_sprite.fillSprite(m_hasColorKey ? m_colorKey : m_backgroundColor);
+        m_commands.replay(m_sprite);
+        ++m_revision;
+    }
+};
@@ -187,6 +187,64 @@ namespace Math
         float diff = fmod(b - a + Pi, TwoPi) - Pi;
         return diff < -Pi ? diff + TwoPi : diff;
     }
+
+    // 2 次元のアフィン変換 (3 行 2 列の行列)
+    // 点 (x, y) を (x * _11 + y * _21 + _31, x * _12 + y * _22 + _32) に移す
+    // a * b は a の後に b を適用する変換
+    struct Mat3x2
+    {
+        float _11, _12;
+        float _21, _22;
+        float _31, _32;
+
+        constexpr Mat3x2(float m11 = 1.0f, float m12 = 0.0f, float m21 = 0.0f, float m22 = 1.0f, float m31 = 0.0f, float m32 = 0.0f)
+            : _11(m11), _12(m12), _21(m21), _22(m22), _31(m31), _32(m32) {}
+
+        static constexpr Mat3x2 Identity() { return Mat3x2(); }
+
+        static constexpr Mat3x2 Translate(float x, float y) { return Mat3x2(1.0f, 0.0f, 0.0f, 1.0f, x, y); }
+
+        // (centerX, centerY) を中心に拡大縮小する
+        static constexpr Mat3x2 Scale(float sx, float sy, float centerX = 0.0f, float centerY = 0.0f)
+        {
+            return Mat3x2(sx, 0.0f, 0.0f, sy, centerX - centerX * sx, centerY - centerY * sy);
+        }
+
+        // (centerX, centerY) を中心に angle (ラジアン) 回転する (y 軸が下向きの画面では時計回り)
+        static Mat3x2 Rotate(float angle, float centerX = 0.0f, float centerY = 0.0f)
+        {
+            const float s = sin(angle);
+            const float c = cos(angle);
+            return Mat3x2(c, s, -s, c, centerX - centerX * c + centerY * s, centerY - centerX * s - centerY * c);
+        }
+
+        Mat3x2 operator*(const Mat3x2 &other) const
+        {
+            return Mat3x2(_11 * other._11 + _12 * other._21, _11 * other._12 + _12 * other._22,
+                          _21 * other._11 + _22 * other._21, _21 * other._12 + _22 * other._22,
+                          _31 * other._11 + _32 * other._21 + other._31, _31 * other._12 + _32 * other._22 + other._32);
+        }
+
+        Vec2f transformPoint(const Vec2f &point) const
+        {
+            return Vec2f(point.x * _11 + point.y * _21 + _31, point.x * _12 + point.y * _22 + _32);
+        }
+
+        float determinant() const { return _11 * _22 - _12 * _21; }
+
+        // 逆変換 (determinant() が 0 の場合は単位行列)
+        Mat3x2 inverse() const
+        {
+            const float det = determinant();
+            if (det == 0.0f)
+            {
+                return Mat3x2();
+            }
+            const float inv = 1.0f / det;
+            return Mat3x2(_22 * inv, -_12 * inv, -_21 * inv, _11 * inv,
+                          (_21 * _32 - _22 * _31) * inv, (_12 * _31 - _11 * _32) * inv);
+        }
+    };
 }
 
 // グローバル名前空間でも使えるように using 宣言を追加
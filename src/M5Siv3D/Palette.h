@@ -1,67 +1,69 @@
 #pragma once
 
+#include "Platform.h"
 #include "Color.h"
 
 // 色定数の追加
+// constexpr なので、描画時の RGB565 への変換もコンパイル時に済む
 namespace Palette
 {
     // Basic colors
-    const Color Black(0, 0, 0);
-    const Color White(255, 255, 255);
-    const Color Red(255, 0, 0);
-    const Color Green(0, 128, 0);
-    const Color Blue(0, 0, 255);
-    const Color Yellow(255, 255, 0);
-    const Color Magenta(255, 0, 255);
-    const Color Cyan(0, 255, 255);
+    M5SIV3D_INLINE_CONSTEXPR Color Black(0, 0, 0);
+    M5SIV3D_INLINE_CONSTEXPR Color White(255, 255, 255);
+    M5SIV3D_INLINE_CONSTEXPR Color Red(255, 0, 0);
+    M5SIV3D_INLINE_CONSTEXPR Color Green(0, 128, 0);
+    M5SIV3D_INLINE_CONSTEXPR Color Blue(0, 0, 255);
+    M5SIV3D_INLINE_CONSTEXPR Color Yellow(255, 255, 0);
+    M5SIV3D_INLINE_CONSTEXPR Color Magenta(255, 0, 255);
+    M5SIV3D_INLINE_CONSTEXPR Color Cyan(0, 255, 255);
 
     // Gray shades
-    const Color Dimgray(105, 105, 105);
-    const Color Gray(128, 128, 128);
-    const Color Darkgray(169, 169, 169);
-    const Color Silver(192, 192, 192);
-    const Color Lightgray(211, 211, 211);
-    const Color Gainsboro(220, 220, 220);
-    const Color Whitesmoke(245, 245, 245);
+    M5SIV3D_INLINE_CONSTEXPR Color Dimgray(105, 105, 105);
+    M5SIV3D_INLINE_CONSTEXPR Color Gray(128, 128, 128);
+    M5SIV3D_INLINE_CONSTEXPR Color Darkgray(169, 169, 169);
+    M5SIV3D_INLINE_CONSTEXPR Color Silver(192, 192, 192);
+    M5SIV3D_INLINE_CONSTEXPR Color Lightgray(211, 211, 211);
+    M5SIV3D_INLINE_CONSTEXPR Color Gainsboro(220, 220, 220);
+    M5SIV3D_INLINE_CONSTEXPR Color Whitesmoke(245, 245, 245);
 
     // Warm colors
-    const Color Orange(255, 165, 0);
-    const Color Darkorange(255, 140, 0);
-    const Color Coral(255, 127, 80);
-    const Color Tomato(255, 99, 71);
-    const Color Orangered(255, 69, 0);
-    const Color Crimson(220, 20, 60);
-    const Color Firebrick(178, 34, 34);
-    const Color Darkred(139, 0, 0);
-    const Color Maroon(128, 0, 0);
+    M5SIV3D_INLINE_CONSTEXPR Color Orange(255, 165, 0);
+    M5SIV3D_INLINE_CONSTEXPR Color Darkorange(255, 140, 0);
+    M5SIV3D_INLINE_CONSTEXPR Color Coral(255, 127, 80);
+    M5SIV3D_INLINE_CONSTEXPR Color Tomato(255, 99, 71);
+    M5SIV3D_INLINE_CONSTEXPR Color Orangered(255, 69, 0);
+    M5SIV3D_INLINE_CONSTEXPR Color Crimson(220, 20, 60);
+    M5SIV3D_INLINE_CONSTEXPR Color Firebrick(178, 34, 34);
+    M5SIV3D_INLINE_CONSTEXPR Color Darkred(139, 0, 0);
+    M5SIV3D_INLINE_CONSTEXPR Color Maroon(128, 0, 0);
 
     // Cool colors
-    const Color Navy(0, 0, 128);
-    const Color Darkblue(0, 0, 139);
-    const Color Mediumblue(0, 0, 205);
-    const Color Royalblue(65, 105, 225);
-    const Color Steelblue(70, 130, 180);
-    const Color Deepskyblue(0, 191, 255);
-    const Color Dodgerblue(30, 144, 255);
-    const Color Cornflowerblue(100, 149, 237);
+    M5SIV3D_INLINE_CONSTEXPR Color Navy(0, 0, 128);
+    M5SIV3D_INLINE_CONSTEXPR Color Darkblue(0, 0, 139);
+    M5SIV3D_INLINE_CONSTEXPR Color Mediumblue(0, 0, 205);
+    M5SIV3D_INLINE_CONSTEXPR Color Royalblue(65, 105, 225);
+    M5SIV3D_INLINE_CONSTEXPR Color Steelblue(70, 130, 180);
+    M5SIV3D_INLINE_CONSTEXPR Color Deepskyblue(0, 191, 255);
+    M5SIV3D_INLINE_CONSTEXPR Color Dodgerblue(30, 144, 255);
+    M5SIV3D_INLINE_CONSTEXPR Color Cornflowerblue(100, 149, 237);
 
     // Green shades
-    const Color Darkgreen(0, 100, 0);
-    const Color Forestgreen(34, 139, 34);
-    const Color Seagreen(46, 139, 87);
-    const Color Limegreen(50, 205, 50);
-    const Color Springgreen(0, 255, 127);
-    const Color Lime(0, 255, 0);
+    M5SIV3D_INLINE_CONSTEXPR Color Darkgreen(0, 100, 0);
+    M5SIV3D_INLINE_CONSTEXPR Color Forestgreen(34, 139, 34);
+    M5SIV3D_INLINE_CONSTEXPR Color Seagreen(46, 139, 87);
+    M5SIV3D_INLINE_CONSTEXPR Color Limegreen(50, 205, 50);
+    M5SIV3D_INLINE_CONSTEXPR Color Springgreen(0, 255, 127);
+    M5SIV3D_INLINE_CONSTEXPR Color Lime(0, 255, 0);
 
     // Purple shades
-    const Color Indigo(75, 0, 130);
-    const Color Purple(128, 0, 128);
-    const Color Darkmagenta(139, 0, 139);
-    const Color Darkviolet(148, 0, 211);
-    const Color Darkorchid(153, 50, 204);
-    const Color Blueviolet(138, 43, 226);
+    M5SIV3D_INLINE_CONSTEXPR Color Indigo(75, 0, 130);
+    M5SIV3D_INLINE_CONSTEXPR Color Purple(128, 0, 128);
+    M5SIV3D_INLINE_CONSTEXPR Color Darkmagenta(139, 0, 139);
+    M5SIV3D_INLINE_CONSTEXPR Color Darkviolet(148, 0, 211);
+    M5SIV3D_INLINE_CONSTEXPR Color Darkorchid(153, 50, 204);
+    M5SIV3D_INLINE_CONSTEXPR Color Blueviolet(138, 43, 226);
 
     // Special colors
-    const Color DefaultLetterbox(1, 2, 3);
-    const Color DefaultBackground(11, 22, 33);
+    M5SIV3D_INLINE_CONSTEXPR Color DefaultLetterbox(1, 2, 3);
+    M5SIV3D_INLINE_CONSTEXPR Color DefaultBackground(11, 22, 33);
 } 
\ No newline at end of file
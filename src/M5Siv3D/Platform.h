@@ -0,0 +1,23 @@
+#pragma once
+
+// 実行環境の選択
+//
+// M5SIV3D_HOST を定義してビルドすると (PlatformIO の native 環境)、M5Unified・LovyanGFX・
+// Arduino の代わりに Host/ の実装を使う。キャンバスも画面もメモリ上の RGB565 バッファになるので、
+// 実機なしで描画結果の検証や描画速度の計測ができる。
+// 画面の内容は M5.Display.getBuffer()、転送量は M5.Display.stats() で参照できる。
+
+#if defined(M5SIV3D_HOST)
+#include "Host/M5Unified.h"
+#else
+#include <M5Unified.h>
+#include <SPI.h>
+#endif
+
+// ヘッダーで定義する定数
+// C++17 以降は inline 変数にして、翻訳単位ごとに複製されないようにする (C++11 では constexpr のみ)
+#if defined(__cpp_inline_variables) && (__cpp_inline_variables >= 201606L)
+#define M5SIV3D_INLINE_CONSTEXPR inline constexpr
+#else
+#define M5SIV3D_INLINE_CONSTEXPR constexpr
+#endif
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <sstream>
+#include <string>
 #include "System.h"
 
 class PrintManager {
@@ -31,13 +35,61 @@ public:
     void draw() {
         if (m_buffer.str().empty()) return;
 
-        auto& canvas = System::getInstance().getCanvas();
-        canvas.setCursor(m_cursorX, m_cursorY);
-        canvas.print(m_buffer.str().c_str());
+        auto& system = System::getInstance();
+        auto& canvas = system.getCanvas();
+
+        // 折り返しを含めて実際に描く行数分だけを更新領域とする
+        const std::string text = m_buffer.str();
+        const int32_t lines = countLines(canvas, text);
+        // 描画は横の倍率を縦にも使うので、行の高さもその倍率で求める
+        const float size = canvas.getTextSizeX();
+        const int32_t lineHeight = int32_t(ceilf(canvas.fontHeight() * size / canvas.getTextSizeY()));
+        const DirtyRect bounds(0, m_cursorY, system.getWidth(), lines * lineHeight);
+        const uint16_t color = lgfx::convert_rgb888_to_rgb565(canvas.getTextStyle().fore_rgb888);
+        System::Submit(DrawCommand::Print(text.c_str(), m_cursorX, m_cursorY,
+                                          canvas.getFont(), size, color, bounds));
     }
 
 private:
     PrintManager() = default;
+
+    // print() と同じ規則 (改行と、右端を越える文字の前) で折り返したときの行数
+    int32_t countLines(const M5Canvas& canvas, const std::string& text) const {
+        const int32_t width = canvas.width();
+        int32_t lines = 0;
+        int32_t x = m_cursorX;
+        bool pending = false; // 最後の行が改行で終わらずに文字を描いている
+        char glyph[5];
+        for (size_t i = 0; i < text.size();) {
+            // UTF-8 の 1 文字分を取り出す
+            const uint8_t lead = uint8_t(text[i]);
+            const size_t length = (lead < 0x80) ? 1 : (lead < 0xE0) ? 2 : (lead < 0xF0) ? 3 : 4;
+            const size_t n = std::min(length, text.size() - i);
+            if (text[i] == '\n') {
+                ++lines;
+                x = 0;
+                pending = false;
+                ++i;
+                continue;
+            }
+            if (text[i] == '\r') {
+                ++i;
+                continue;
+            }
+            memcpy(glyph, text.data() + i, n);
+            glyph[n] = '\0';
+            i += n;
+
+            const int32_t advance = canvas.textWidth(glyph);
+            if (x + advance > width) {
+                ++lines;
+                x = 0;
+            }
+            x += advance;
+            pending = true;
+        }
+        return lines + (pending ? 1 : 0);
+    }
 };
 
 // グローバル関数として定義
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "Platform.h"
+#include "System.h"
+#include "ImageData.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// ScaledImageCache の統計
+struct ScaledImageCacheStats
+{
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint32_t evictions = 0;
+};
+
+// 拡大縮小した画像のキャッシュ
+//
+// 同じ画像を同じ大きさで毎フレーム描く場合、拡大縮小した結果をスプライトに残しておき、
+// 次からはそのまま転送する。メモリの上限 (バイト) を超える分は、最後に使ってから
+// 最も時間が経ったものから解放する。既定の上限は 0 (キャッシュしない) で、
+// その場合 Image::draw は毎回描画先に直接拡大縮小して書き込む。
+//
+//   ScaledImageCache::SetBudget(32 * 1024);
+//   image.draw(10, 10, 2.0f, ImageFilter::Bilinear);
+class ScaledImageCache
+{
+public:
+    static ScaledImageCache &getInstance()
+    {
+        static ScaledImageCache instance;
+        return instance;
+    }
+
+    static void SetBudget(size_t bytes) { getInstance().setBudget(bytes); }
+    static size_t Budget() { return getInstance().budget(); }
+    static size_t UsedBytes() { return getInstance().usedBytes(); }
+    static size_t Count() { return getInstance().count(); }
+    static void Clear() { getInstance().clear(); }
+    static const ScaledImageCacheStats &Stats() { return getInstance().stats(); }
+
+    void setBudget(size_t bytes)
+    {
+        m_budget = bytes;
+        evictUntil(m_budget);
+    }
+
+    size_t budget() const { return m_budget; }
+    size_t usedBytes() const { return m_usedBytes; }
+    size_t count() const { return m_entries.size(); }
+    const ScaledImageCacheStats &stats() const { return m_stats; }
+
+    // 使っていない項目をすべて解放する (このフレームで描画したものは残す)
+    void clear()
+    {
+        evictUntil(0);
+    }
+
+    // source を w x h に拡大縮小したスプライトを返す (キャッシュできない場合は nullptr)
+    // key と revision で画像を区別し、id には差分の検出に使う項目ごとの番号を返す
+    // 返したスプライトはこのフレームの間は解放しない
+    M5Canvas *acquire(const ImageData &source, const void *key, uint32_t revision, int32_t w, int32_t h, ImageFilter filter,
+                      uint32_t &id)
+    {
+        const size_t bytes = size_t(w) * size_t(h) * sizeof(uint16_t);
+        if (w <= 0 || h <= 0 || bytes > m_budget)
+        {
+            return nullptr;
+        }
+
+        const uint64_t frame = System::FrameCount();
+        for (Entry &entry : m_entries)
+        {
+            if (entry.key == key && entry.revision == revision && entry.w == w && entry.h == h && entry.filter == filter)
+            {
+                entry.lastUse = ++m_tick;
+                entry.lastFrame = frame;
+                ++m_stats.hits;
+                id = entry.id;
+                return entry.canvas;
+            }
+        }
+        ++m_stats.misses;
+
+        // 同じ画像の古い内容はもう使わない
+        for (Entry &entry : m_entries)
+        {
+            if (entry.key == key && entry.revision != revision)
+            {
+                entry.key = nullptr;
+            }
+        }
+        if (!evictUntil(m_budget - bytes))
+        {
+            return nullptr;
+        }
+
+        M5Canvas *canvas = new M5Canvas(&M5.Display);
+        canvas->setColorDepth(16);
+        if (!canvas->createSprite(w, h))
+        {
+            delete canvas;
+            return nullptr;
+        }
+        ImageBlit::DrawScaled(*canvas, source, 0, 0, w, h, filter);
+
+        Entry entry;
+        entry.key = key;
+        entry.revision = revision;
+        entry.w = w;
+        entry.h = h;
+        entry.filter = filter;
+        entry.canvas = canvas;
+        entry.bytes = bytes;
+        entry.id = ++m_nextId;
+        entry.lastUse = ++m_tick;
+        entry.lastFrame = frame;
+        m_entries.push_back(entry);
+        m_usedBytes += bytes;
+        id = entry.id;
+        return canvas;
+    }
+
+    // 画像を解放するときに呼ぶ (同じアドレスの別の画像と取り違えないようにする)
+    void forget(const void *key)
+    {
+        for (Entry &entry : m_entries)
+        {
+            if (entry.key == key)
+            {
+                entry.key = nullptr;
+            }
+        }
+    }
+
+    ~ScaledImageCache()
+    {
+        for (Entry &entry : m_entries)
+        {
+            release(entry);
+        }
+    }
+
+private:
+    struct Entry
+    {
+        const void *key;
+        uint32_t revision;
+        int32_t w;
+        int32_t h;
+        ImageFilter filter;
+        M5Canvas *canvas;
+        size_t bytes;
+        uint32_t id;
+        uint32_t lastUse;
+        uint64_t lastFrame;
+    };
+
+    std::vector<Entry> m_entries;
+    size_t m_budget = 0;
+    size_t m_usedBytes = 0;
+    uint32_t m_tick = 0;
+    uint32_t m_nextId = 0;
+    ScaledImageCacheStats m_stats;
+
+    ScaledImageCache() = default;
+    ScaledImageCache(const ScaledImageCache &) = delete;
+    ScaledImageCache &operator=(const ScaledImageCache &) = delete;
+
+    static void release(Entry &entry)
+    {
+        entry.canvas->deleteSprite();
+        delete entry.canvas;
+    }
+
+    // 使用量が limit 以下になるまで、古い順に解放する
+    // このフレームの描画命令が参照している項目は解放できないので、足りなければ false を返す
+    bool evictUntil(size_t limit)
+    {
+        const uint64_t frame = System::FrameCount();
+        while (m_usedBytes > limit)
+        {
+            size_t oldest = m_entries.size();
+            for (size_t i = 0; i < m_entries.size(); ++i)
+            {
+                const Entry &entry = m_entries[i];
+                if (entry.lastFrame == frame)
+                {
+                    continue;
+                }
+                // 参照されなくなった項目を優先する
+                if (oldest == m_entries.size() || (!entry.key && m_entries[oldest].key) ||
+                    ((!entry.key == !m_entries[oldest].key) && entry.lastUse < m_entries[oldest].lastUse))
+                {
+                    oldest = i;
+                }
+            }
+            if (oldest == m_entries.size())
+            {
+                return false;
+            }
+            m_usedBytes -= m_entries[oldest].bytes;
+            release(m_entries[oldest]);
+            m_entries.erase(m_entries.begin() + oldest);
+            ++m_stats.evictions;
+        }
+        return true;
+    }
+};
@@ -30,24 +30,43 @@ struct Circle
     {
     }
 
-    void draw(const Color &color = Color(0, 0, 0))
+    void draw(Color565 color = Color565())
     {
-        System::getInstance().getCanvas().fillCircle(m_x, m_y, m_r, color.toRGB565());
+        System::Submit(DrawCommand::FillCircle(m_x, m_y, m_r, color.toRGB565()));
     }
 
-    void drawFrame(const Color &color = Color(0, 0, 0))
+    // 描画先と合成して塗る
+    void draw(const ColorA &color, BlendMode mode = BlendMode::Alpha)
     {
-        System::getInstance().getCanvas().drawCircle(m_x, m_y, m_r, color.toRGB565());
+        if (Blend::IsOpaque(color.a, mode))
+        {
+            draw(Color565(color.toRGB565()));
+        }
+        else if (!Blend::IsInvisible(color.a))
+        {
+            System::Submit(DrawCommand::BlendCircle(m_x, m_y, m_r, color.toRGB565(), color.a, mode));
+        }
     }
 
-    void drawArc(int32_t thickness, int32_t startAngle, int32_t endAngle, const Color &color = Color(0, 0, 0))
+    // グラデーションで塗る
+    void draw(const Gradient &gradient)
     {
-        System::getInstance().getCanvas().drawArc(m_x, m_y, m_r, thickness, startAngle, endAngle, color.toRGB565());
+        System::Submit(DrawCommand::GradientCircle(m_x, m_y, m_r, gradient));
     }
 
-    void fillArc(int32_t thickness, int32_t startAngle, int32_t endAngle, const Color &color = Color(0, 0, 0))
+    void drawFrame(Color565 color = Color565())
     {
-        System::getInstance().getCanvas().fillArc(m_x, m_y, m_r, thickness, startAngle, endAngle, color.toRGB565());
+        System::Submit(DrawCommand::DrawCircle(m_x, m_y, m_r, color.toRGB565()));
+    }
+
+    void drawArc(int32_t thickness, int32_t startAngle, int32_t endAngle, Color565 color = Color565())
+    {
+        System::Submit(DrawCommand::DrawArc(m_x, m_y, m_r, thickness, startAngle, endAngle, color.toRGB565()));
+    }
+
+    void fillArc(int32_t thickness, int32_t startAngle, int32_t endAngle, Color565 color = Color565())
+    {
+        System::Submit(DrawCommand::FillArc(m_x, m_y, m_r, thickness, startAngle, endAngle, color.toRGB565()));
     }
 
     // 点が円内にあるかどうかをチェック
@@ -128,24 +147,43 @@ struct Rect
     }
 
     // 既存のメソッド
-    void draw(const Color &color = Color(0, 0, 0))
+    void draw(Color565 color = Color565())
+    {
+        System::Submit(DrawCommand::FillRect(m_x, m_y, m_width, m_height, color.toRGB565()));
+    }
+
+    // 描画先と合成して塗る
+    void draw(const ColorA &color, BlendMode mode = BlendMode::Alpha)
+    {
+        if (Blend::IsOpaque(color.a, mode))
+        {
+            draw(Color565(color.toRGB565()));
+        }
+        else if (!Blend::IsInvisible(color.a))
+        {
+            System::Submit(DrawCommand::BlendRect(m_x, m_y, m_width, m_height, color.toRGB565(), color.a, mode));
+        }
+    }
+
+    // グラデーションで塗る
+    void draw(const Gradient &gradient)
     {
-        System::getInstance().getCanvas().fillRect(m_x, m_y, m_width, m_height, color.toRGB565());
+        System::Submit(DrawCommand::GradientRect(m_x, m_y, m_width, m_height, gradient));
     }
 
-    void drawFrame(const Color &color = Color(0, 0, 0))
+    void drawFrame(Color565 color = Color565())
     {
-        System::getInstance().getCanvas().drawRect(m_x, m_y, m_width, m_height, color.toRGB565());
+        System::Submit(DrawCommand::DrawRect(m_x, m_y, m_width, m_height, color.toRGB565()));
     }
 
-    void drawRoundFrame(int32_t radius, const Color &color = Color(0, 0, 0))
+    void drawRoundFrame(int32_t radius, Color565 color = Color565())
     {
-        System::getInstance().getCanvas().drawRoundRect(m_x, m_y, m_width, m_height, radius, color.toRGB565());
+        System::Submit(DrawCommand::DrawRoundRect(m_x, m_y, m_width, m_height, radius, color.toRGB565()));
     }
 
-    void drawRound(int32_t radius, const Color &color = Color(0, 0, 0))
+    void drawRound(int32_t radius, Color565 color = Color565())
     {
-        System::getInstance().getCanvas().fillRoundRect(m_x, m_y, m_width, m_height, radius, color.toRGB565());
+        System::Submit(DrawCommand::FillRoundRect(m_x, m_y, m_width, m_height, radius, color.toRGB565()));
     }
 
     // 点が矩形内にあるかどうかをチェック
@@ -206,14 +244,33 @@ struct Triangle
     {
     }
 
-    void draw(const Color &color = Color(0, 0, 0))
+    void draw(Color565 color = Color565())
+    {
+        System::Submit(DrawCommand::FillTriangle(m_x1, m_y1, m_x2, m_y2, m_x3, m_y3, color.toRGB565()));
+    }
+
+    // 描画先と合成して塗る
+    void draw(const ColorA &color, BlendMode mode = BlendMode::Alpha)
+    {
+        if (Blend::IsOpaque(color.a, mode))
+        {
+            draw(Color565(color.toRGB565()));
+        }
+        else if (!Blend::IsInvisible(color.a))
+        {
+            System::Submit(DrawCommand::BlendTriangle(m_x1, m_y1, m_x2, m_y2, m_x3, m_y3, color.toRGB565(), color.a, mode));
+        }
+    }
+
+    // グラデーションで塗る
+    void draw(const Gradient &gradient)
     {
-        System::getInstance().getCanvas().fillTriangle(m_x1, m_y1, m_x2, m_y2, m_x3, m_y3, color.toRGB565());
+        System::Submit(DrawCommand::GradientTriangle(m_x1, m_y1, m_x2, m_y2, m_x3, m_y3, gradient));
     }
 
-    void drawFrame(const Color &color = Color(0, 0, 0))
+    void drawFrame(Color565 color = Color565())
     {
-        System::getInstance().getCanvas().drawTriangle(m_x1, m_y1, m_x2, m_y2, m_x3, m_y3, color.toRGB565());
+        System::Submit(DrawCommand::DrawTriangle(m_x1, m_y1, m_x2, m_y2, m_x3, m_y3, color.toRGB565()));
     }
 
     // 点が三角形内にあるかどうかをチェック
@@ -286,9 +343,9 @@ struct Line
     {
     }
 
-    void draw(const Color &color = Color(0, 0, 0))
+    void draw(Color565 color = Color565())
     {
-        System::getInstance().getCanvas().drawLine(m_x1, m_y1, m_x2, m_y2, color.toRGB565());
+        System::Submit(DrawCommand::DrawLine(m_x1, m_y1, m_x2, m_y2, color.toRGB565()));
     }
 };
 
@@ -306,9 +363,9 @@ struct Bezier
         {
         }
 
-        void draw(const Color &color = Color(0, 0, 0))
+        void draw(Color565 color = Color565())
         {
-            System::getInstance().getCanvas().drawBezier(x0, y0, x1, y1, x2, y2, color.toRGB565());
+            System::Submit(DrawCommand::DrawBezier(x0, y0, x1, y1, x2, y2, color.toRGB565()));
         }
     };
 
@@ -326,9 +383,9 @@ struct Bezier
         {
         }
 
-        void draw(const Color &color = Color(0, 0, 0))
+        void draw(Color565 color = Color565())
         {
-            System::getInstance().getCanvas().drawBezier(x0, y0, x1, y1, x2, y2, x3, y3, color.toRGB565());
+            System::Submit(DrawCommand::DrawBezier(x0, y0, x1, y1, x2, y2, x3, y3, color.toRGB565()));
         }
     };
 
@@ -57,6 +57,7 @@ namespace SimpleGUI
                       int32_t width = DefaultStyle.DefaultWidth,
                       bool enabled = true)
     {
+        M5SIV3D_PROFILE_SCOPE("SimpleGUI::Button");
         auto button = ButtonRegion(label, pos, width);
         static constexpr int32_t cornerRadius = 4;  // 角の丸みの半径
 
@@ -113,6 +114,7 @@ namespace SimpleGUI
                       int32_t width = DefaultStyle.DefaultWidth,
                       bool enabled = true)
     {
+        M5SIV3D_PROFILE_SCOPE("SimpleGUI::Slider");
         auto slider = SliderRegion(pos, width);
         bool changed = false;
         static constexpr int32_t cornerRadius = 4;
@@ -226,6 +228,7 @@ namespace SimpleGUI
                         int32_t width = DefaultStyle.DefaultWidth,
                         bool enabled = true)
     {
+        M5SIV3D_PROFILE_SCOPE("SimpleGUI::CheckBox");
         auto box = CheckBoxRegion(pos);
         bool changed = false;
         static constexpr int32_t cornerRadius = 2;  // チェックボックスの角の丸み
@@ -301,6 +304,7 @@ namespace SimpleGUI
                            int32_t width = DefaultStyle.DefaultWidth,
                            bool enabled = true)
     {
+        M5SIV3D_PROFILE_SCOPE("SimpleGUI::RadioButtons");
         bool changed = false;
         static constexpr int32_t cornerRadius = 4;
 
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <utility>
+
+// ダブルバッファによる非同期(DMA)転送
+//
+// present() は描画済みのバッファの DMA 転送を開始し、もう一方のバッファを
+// 次の描画先として返す。転送中のバッファには触れないよう、バッファを再利用する
+// 前に必ず直前の転送の完了を待つ (フェンス)。
+//
+// バスのトランザクションは present() で開き、fence() で転送の完了を待ってから閉じる。
+// present() から次の fence() までは、同じ SPI バスにつながる SD カード (Core / Core2) などは使えない。
+//
+// Canvas  : createSprite / deleteSprite / getBuffer / width / height を持つ描画バッファ
+// Display : startWrite / endWrite / pushImageDMA / waitDMA を持つ転送先
+// Pixel   : 転送時の画素型 (デバイスではスプライトと同じバイトスワップ済み RGB565)
+template <class Canvas, class Display, class Pixel>
+class SwapChain
+{
+public:
+    explicit SwapChain(Display *display)
+        : m_display(display), m_bufferA(display), m_bufferB(display)
+    {
+    }
+
+    ~SwapChain()
+    {
+        release();
+    }
+
+    // 2 枚のバッファを確保する
+    bool create(int32_t width, int32_t height)
+    {
+        release();
+
+        m_bufferA.setColorDepth(16);
+        m_bufferB.setColorDepth(16);
+        if (!m_bufferA.createSprite(width, height) || !m_bufferB.createSprite(width, height))
+        {
+            m_bufferA.deleteSprite();
+            m_bufferB.deleteSprite();
+            return false;
+        }
+
+        m_back = &m_bufferA;
+        m_front = &m_bufferB;
+        m_presentCount = 0;
+        m_created = true;
+        return true;
+    }
+
+    // 転送の完了を待ってからバッファを解放する
+    void release()
+    {
+        if (!m_created)
+        {
+            return;
+        }
+        fence();
+        m_bufferA.deleteSprite();
+        m_bufferB.deleteSprite();
+        m_created = false;
+    }
+
+    bool isCreated() const { return m_created; }
+
+    // 描画先のバッファ
+    Canvas &back() { return *m_back; }
+    const Canvas &back() const { return *m_back; }
+
+    // 最後に転送を開始した (または転送中の) バッファ
+    Canvas &front() { return *m_front; }
+    const Canvas &front() const { return *m_front; }
+
+    // 描画済みのバッファの転送を開始し、描画先を入れ替える
+    void present()
+    {
+        present(0, 0, m_back->height());
+    }
+
+    // 描画済みのバッファの上から rows 行を (x, y) に転送する (帯単位の描画用)
+    void present(int32_t x, int32_t y, int32_t rows)
+    {
+        if (!m_created)
+        {
+            return;
+        }
+
+        // フェンス: 前回転送を開始したバッファ (次の描画先) の転送完了を待つ
+        fence();
+
+        // DMA 転送を非同期に保つため、転送が終わるまでトランザクションを開いたままにする
+        m_display->startWrite();
+        m_writing = true;
+        m_display->pushImageDMA(x, y, m_back->width(), std::min(rows, m_back->height()),
+                                static_cast<const Pixel *>(m_back->getBuffer()));
+        std::swap(m_back, m_front);
+        ++m_presentCount;
+    }
+
+    // 転送中のバッファがあれば完了を待ち、バスのトランザクションを閉じる
+    void fence()
+    {
+        m_display->waitDMA();
+        if (m_writing)
+        {
+            m_display->endWrite();
+            m_writing = false;
+        }
+    }
+
+    // present() で開いたトランザクションが残っているかどうか
+    bool isWriting() const { return m_writing; }
+
+    uint32_t getPresentCount() const { return m_presentCount; }
+
+private:
+    Display *m_display;
+    Canvas m_bufferA;
+    Canvas m_bufferB;
+    Canvas *m_back = &m_bufferA;
+    Canvas *m_front = &m_bufferB;
+    bool m_created = false;
+    bool m_writing = false;
+    uint32_t m_presentCount = 0;
+
+    // コピー禁止
+    SwapChain(const SwapChain &) = delete;
+    SwapChain &operator=(const SwapChain &) = delete;
+};
@@ -1,8 +1,45 @@
 #pragma once
 
-#include <M5Unified.h>
+#include "Platform.h"
 #include "Color.h"
 #include "Input.h"
+#include "DirtyRegion.h"
+#include "SwapChain.h"
+#include "DisplayList.h"
+#include "FrameProfiler.h"
+#include "Trace.h"
+#include "FrameStream.h"
+
+// 画面への転送方法
+enum class PresentMode : uint8_t
+{
+    Full,      // 毎フレーム画面全体を転送する
+    DirtyRect, // 描画された領域 (と前フレームで描画された領域) だけを転送する
+    FrameDiff, // 前回転送したフレームとタイル単位で比較し、変化したタイルだけを転送する
+    DoubleBuffered, // 2 枚のバッファを交互に使い、転送 (DMA) と次のフレームの描画を並行させる
+    Banded,    // 描画命令を記録し、画面の一部 (帯) ずつ小さなバッファに描いて転送する (全画面のキャンバスを確保しない)
+};
+
+// フレームの描画前にキャンバスを消去する方法
+enum class ClearMode : uint8_t
+{
+    Full,         // 毎フレーム全面を背景色で塗りつぶす
+    DirtyRegions, // 前回そのバッファに描画された領域だけを背景色で塗りつぶす
+    None,         // 消去しない (前のフレームの内容を残したまま描き足す)
+};
+
+// System がフレームごとに合成する描画対象 (Layer.h の Layer が実装する)
+class LayerBase
+{
+public:
+    virtual ~LayerBase() {}
+
+    // 重ね順 (負の値はそのフレームの描画より下、0 以上は上に合成する)
+    virtual int32_t getZ() const = 0;
+
+    // 合成用の描画命令を System::Submit する
+    virtual void composite() = 0;
+};
 
 class System
 {
@@ -20,10 +57,29 @@ public:
         auto cfg = M5.config();
         M5.begin(cfg);
 
+        const int32_t width = M5.Display.width();
+        const int32_t height = M5.Display.height();
+        m_dirtyRegion.setBounds(width, height);
+        m_previousDirtyRegion.setBounds(width, height);
+        m_olderDirtyRegion.setBounds(width, height);
+        m_markedRegion.setBounds(width, height);
+        m_previousMarkedRegion.setBounds(width, height);
+        m_forceFullPresent = true;
+        m_fullClearFrames = FullClearFrames;
+
         // キャンバスを画面のサイズで初期化
-        canvas.createSprite(M5.Display.width(), M5.Display.height());
-        canvas.setTextSize(2);
-        lastDrawTime = millis();
+        // メモリが足りなければ帯単位の描画に切り替える
+        if (!createFrameBuffers(m_presentMode))
+        {
+            Serial.println("Canvas: not enough memory for a full-screen sprite, using banded rendering");
+            setPresentMode(PresentMode::Banded);
+        }
+
+        const uint64_t now = nowMicros();
+        m_previousTime = now;
+        m_nextFrameQ16 = now << 16;
+        m_frameStartMicros = micros();
+        m_drawStartMicros = m_frameStartMicros;
     }
 
     static void Init()
@@ -34,13 +90,56 @@ public:
     // 描画の開始
     void beginDraw()
     {
-        canvas.fillSprite(m_backgroundColor.toRGB565());
+        clearCanvas();
+
+        // 背面のレイヤーは、そのフレームの描画より先に合成する
+        compositeLayers(false);
     }
 
     // 描画の終了と画面更新
     void endDraw()
     {
-        canvas.pushSprite(0, 0);
+        M5SIV3D_PROFILE_SCOPE("System::endDraw");
+
+        compositeLayers(true);
+        if (m_profilerOverlay)
+        {
+            submit(DrawCommand::Callback(DirtyRect(0, 0, OverlayWidth, OverlayHeight), &System::DrawProfilerOverlay, this));
+        }
+        if (m_streamTarget)
+        {
+            streamFrame();
+        }
+        present();
+
+        m_olderDirtyRegion = m_previousDirtyRegion;
+        m_previousDirtyRegion = m_dirtyRegion;
+        m_dirtyRegion.clear();
+        m_previousMarkedRegion = m_markedRegion;
+        m_markedRegion.clear();
+
+        // 次のフレームとの比較のため、今回の記録を残す
+        m_previousFrameList.swap(m_frameList);
+        m_frameList.clear();
+    }
+
+    // レイヤーの登録 (Layer のコンストラクタ・デストラクタから呼ばれる)
+    void addLayer(LayerBase *layer)
+    {
+        m_layers.push_back(layer);
+        sortLayers();
+    }
+
+    void removeLayer(LayerBase *layer)
+    {
+        m_layers.erase(std::remove(m_layers.begin(), m_layers.end(), layer), m_layers.end());
+    }
+
+    // 重ね順の変更を反映する (同じ重ね順のレイヤーは登録順)
+    void sortLayers()
+    {
+        std::stable_sort(m_layers.begin(), m_layers.end(),
+                         [](const LayerBase *a, const LayerBase *b) { return a->getZ() < b->getZ(); });
     }
 
     static void SetBackgroundColor(const Color &color)
@@ -50,42 +149,445 @@ public:
 
     void setBackgroundColor(const Color &color)
     {
+        if (color.toRGB565() != m_backgroundColor.toRGB565())
+        {
+            m_forceFullPresent = true;
+            m_fullClearFrames = FullClearFrames;
+        }
         m_backgroundColor = color;
     }
 
+    // 転送方法の設定
+    static void SetPresentMode(PresentMode mode)
+    {
+        getInstance().setPresentMode(mode);
+    }
+
+    void setPresentMode(PresentMode mode)
+    {
+        if (mode == m_presentMode)
+        {
+            return;
+        }
+        m_forceFullPresent = true;
+        m_fullClearFrames = FullClearFrames;
+
+        if (mode != PresentMode::FrameDiff)
+        {
+            // 比較用のフレームは FrameDiff 以外では不要
+            m_presentedFrame.deleteSprite();
+        }
+
+        // 今のモードのバッファを解放してから、新しいモードのバッファを確保する
+        releaseFrameBuffers();
+        if (!createFrameBuffers(mode))
+        {
+            Serial.printf("PresentMode %d: failed to allocate frame buffers\n", int(mode));
+
+            // 全画面のキャンバス、それも無理なら帯単位の描画で続ける
+            mode = (mode != PresentMode::Full && createFrameBuffers(PresentMode::Full)) ? PresentMode::Full : PresentMode::Banded;
+            if (mode == PresentMode::Banded && !createFrameBuffers(mode))
+            {
+                Serial.println("Banded: failed to allocate band buffers");
+            }
+        }
+        m_presentMode = mode;
+    }
+
+    PresentMode getPresentMode() const { return m_presentMode; }
+
+    // DoubleBuffered の転送を次のフレームの描画と並行させるかどうか (既定は true)
+    // 転送中は LCD の SPI バスのトランザクションを開いたままにするので、
+    // 同じバスにつながる SD カード (Core / Core2) を使う前には WaitPresent() を呼ぶこと。
+    // false にすると毎フレーム転送の完了を待ってからバスを解放する (並行させない分だけ遅くなる)。
+    static void SetAsyncPresent(bool enabled)
+    {
+        getInstance().setAsyncPresent(enabled);
+    }
+
+    void setAsyncPresent(bool enabled)
+    {
+        m_asyncPresent = enabled;
+        if (!enabled)
+        {
+            waitPresent();
+        }
+    }
+
+    bool getAsyncPresent() const { return m_asyncPresent; }
+
+    // 転送中の DMA の完了を待ち、LCD のバスを解放する
+    static void WaitPresent()
+    {
+        getInstance().waitPresent();
+    }
+
+    void waitPresent()
+    {
+        m_swapChain.fence();
+        m_bandChain.fence();
+    }
+
+    // 描画前の消去方法の設定
+    // DirtyRegions / None では、getCanvas() に直接描画した領域を MarkDirty で通知すること
+    static void SetClearMode(ClearMode mode)
+    {
+        getInstance().setClearMode(mode);
+    }
+
+    void setClearMode(ClearMode mode)
+    {
+        if (mode != m_clearMode)
+        {
+            m_fullClearFrames = FullClearFrames;
+        }
+        m_clearMode = mode;
+    }
+
+    ClearMode getClearMode() const { return m_clearMode; }
+
+    // Banded で 1 回に描画する帯の高さ
+    // 帯のバッファ (幅 × 高さ × 2 バイト) を 2 枚確保する。確保できない場合は高さを半分にして再試行する
+    static void SetBandHeight(int32_t height)
+    {
+        getInstance().setBandHeight(height);
+    }
+
+    void setBandHeight(int32_t height)
+    {
+        m_bandHeight = std::max<int32_t>(height, MinBandHeight);
+        if (m_presentMode == PresentMode::Banded)
+        {
+            releaseFrameBuffers();
+            createFrameBuffers(PresentMode::Banded);
+            m_forceFullPresent = true;
+        }
+    }
+
+    int32_t getBandHeight() const
+    {
+        return (m_presentMode == PresentMode::Banded) ? m_bandChain.back().height() : m_bandHeight;
+    }
+
+    // 描画した領域を記録する (各図形の draw から呼ばれる)
+    // getCanvas() に直接描画した場合は、この関数で領域を通知する
+    static void MarkDirty(int32_t x, int32_t y, int32_t w, int32_t h)
+    {
+        getInstance().markDirty(x, y, w, h);
+    }
+
+    void markDirty(int32_t x, int32_t y, int32_t w, int32_t h)
+    {
+        m_dirtyRegion.add(x, y, w, h);
+        m_markedRegion.add(x, y, w, h);
+    }
+
+    // 描画命令の実行 (各図形の draw から呼ばれる)
+    // 通常はキャンバスにそのまま描画し、Banded では記録して endDraw でまとめて描画する
+    // 記録中 (BeginRecording) は画面には描画せず、記録先の DisplayList に追加する
+    static void Submit(const DrawCommand &command)
+    {
+        getInstance().submit(command);
+    }
+
+    void submit(const DrawCommand &command)
+    {
+        if (m_recordingList)
+        {
+            m_recordingList->append(command);
+            return;
+        }
+        if (!m_renderThisFrame)
+        {
+            return;
+        }
+        m_dirtyRegion.add(command.bounds);
+        if (m_presentMode == PresentMode::Banded || m_damageDetection)
+        {
+            m_frameList.append(command);
+        }
+        if (m_presentMode != PresentMode::Banded)
+        {
+            command.execute(getCanvas());
+        }
+    }
+
+    // 記録しておいた描画命令を、現在のフレームに描画する
+    static void Submit(const DisplayList &list)
+    {
+        getInstance().submit(list);
+    }
+
+    void submit(const DisplayList &list)
+    {
+        for (DisplayList::Iterator it = list.begin(); it != list.end(); ++it)
+        {
+            submit(*it);
+        }
+    }
+
+    // 以降の描画命令を画面に描かず list に追加する (EndRecording まで)
+    // 静的な UI を一度だけ記録しておき、毎フレーム Submit したり別のキャンバスに replay したりできる
+    // 戻り値はそれまでの記録先 (記録中でなければ nullptr)
+    static DisplayList *BeginRecording(DisplayList &list)
+    {
+        return getInstance().beginRecording(list);
+    }
+
+    // previous を渡すと、入れ子になった記録の外側の記録先に戻る
+    static void EndRecording(DisplayList *previous = nullptr)
+    {
+        getInstance().endRecording(previous);
+    }
+
+    DisplayList *beginRecording(DisplayList &list)
+    {
+        DisplayList *previous = m_recordingList;
+        m_recordingList = &list;
+        return previous;
+    }
+
+    void endRecording(DisplayList *previous = nullptr) { m_recordingList = previous; }
+    bool isRecording() const { return m_recordingList != nullptr; }
+
+    // 描画命令の差分による更新領域の検出 (DirtyRect で有効)
+    // 前フレームの描画命令と比較し、変化した命令の範囲だけを転送する。
+    // 毎フレーム同じ UI を描き直していても、変化がなければ転送しない。
+    // Banded では常に有効。getCanvas() に直接描画した領域は MarkDirty で通知すること。
+    static void SetDamageDetection(bool enabled)
+    {
+        getInstance().setDamageDetection(enabled);
+    }
+
+    void setDamageDetection(bool enabled)
+    {
+        if (enabled != m_damageDetection)
+        {
+            m_forceFullPresent = true;
+            m_frameList.clear();
+            m_previousFrameList.clear();
+        }
+        m_damageDetection = enabled;
+    }
+
+    bool isDamageDetection() const { return m_damageDetection; }
+
+    // 現在のフレームで描画された領域
+    const DirtyRegion &getDirtyRegion() const { return m_dirtyRegion; }
+
+    // 直前の画面更新で転送した画素数
+    static uint32_t PushedPixels()
+    {
+        return getInstance().getPushedPixels();
+    }
+
+    uint32_t getPushedPixels() const { return m_pushedPixels; }
+
+    // 直前の画面更新で転送したタイル数 (FrameDiff のとき)
+    static uint32_t PushedTiles()
+    {
+        return getInstance().getPushedTiles();
+    }
+
+    uint32_t getPushedTiles() const { return m_pushedTiles; }
+
+    // 現在のキャンバスの内容を圧縮して書き出す (tools/frame_stream_decode.py で画像に変換できる)
+    // Banded のときは、ここまでに描画した命令を帯ごとに描き直して書き出す
+    static bool Screenshot(Stream &stream = Serial)
+    {
+        return getInstance().screenshot(stream);
+    }
+
+    bool screenshot(Stream &stream)
+    {
+        FrameStreamEncoder encoder;
+        const bool written = writeFrame(encoder, stream, FrameStreamEncoder::FrameType::Key);
+        if (!m_streamTarget)
+        {
+            m_captureStrip.deleteSprite();
+        }
+        return written;
+    }
+
+    // 画面更新のたびに、フレームを圧縮して書き出す
+    // frameInterval フレームごとに送り、前回から変化した 16x16 のタイルだけを送る。
+    // 途中から受信しても表示できるよう、keyFrameInterval 回ごとに画面全体を送る (0 なら最初だけ)。
+    // シリアルへの書き込みが終わるまで次のフレームに進まないので、転送量に応じてフレームレートが下がる。
+    static void StartFrameStreaming(Stream &stream = Serial, uint32_t frameInterval = 1, uint32_t keyFrameInterval = 120)
+    {
+        getInstance().startFrameStreaming(stream, frameInterval, keyFrameInterval);
+    }
+
+    static void StopFrameStreaming()
+    {
+        getInstance().stopFrameStreaming();
+    }
+
+    static bool IsFrameStreaming()
+    {
+        return getInstance().isFrameStreaming();
+    }
+
+    void startFrameStreaming(Stream &stream, uint32_t frameInterval, uint32_t keyFrameInterval)
+    {
+        m_streamTarget = &stream;
+        m_streamFrameInterval = std::max<uint32_t>(frameInterval, 1);
+        m_streamKeyFrameInterval = keyFrameInterval;
+        m_streamFrames = 0;
+        m_streamedBytes = 0;
+        m_streamEncoder.reset();
+    }
+
+    void stopFrameStreaming()
+    {
+        m_streamTarget = nullptr;
+        m_captureStrip.deleteSprite();
+    }
+
+    bool isFrameStreaming() const { return m_streamTarget != nullptr; }
+
+    // 直前の画面更新でストリーミングに書き出したバイト数 (送らなかったフレームは 0)
+    static size_t StreamedBytes()
+    {
+        return getInstance().getStreamedBytes();
+    }
+
+    size_t getStreamedBytes() const { return m_streamedBytes; }
+
     static bool Update()
     {
         return getInstance().update();
     }
 
     // メインループの更新処理
+    // 予定時刻まで待ってから描画内容を転送し、入力を更新して次のフレームの描画を始める
     bool update()
     {
-        uint32_t currentTime = millis();
-        uint32_t elapsedTime = currentTime - lastDrawTime;
+        // 各区間の境界で時刻を取り、フレームごとの内訳を記録する
+        FrameTiming timing;
+        const uint32_t drawEnd = micros();
+        timing[FramePhase::Draw] = drawEnd - m_drawStartMicros;
 
-        if (elapsedTime >= FRAME_INTERVAL)
+        waitForNextFrame();
+        const uint32_t presentStart = micros();
+        timing[FramePhase::Idle] = presentStart - drawEnd;
+
+        if (m_renderThisFrame)
         {
             endDraw();
-            updateTime();
-            lastDrawTime = currentTime;
+        }
+        else
+        {
+            // 描画を省略したフレームの記録は破棄する
+            m_dirtyRegion.clear();
+            m_frameList.clear();
+            getCanvas().clearClipRect();
+        }
+        const uint32_t inputStart = micros();
+        timing[FramePhase::Present] = inputStart - presentStart;
 
-            int32_t remaining = FRAME_INTERVAL - (millis() - currentTime);
-            if (remaining > 0)
-            {
-                M5.delay(remaining);
-            }
+        // リプレイ中は記録した経過時間で DeltaTime を進める
+        const uint64_t currentTime = nowMicros();
+        Input::InputManager &input = Input::InputManager::getInstance();
+        input.update(uint32_t(currentTime - m_previousTime));
+        updateTime(currentTime, input.frameMicros());
+        const uint32_t inputEnd = micros();
+        timing[FramePhase::Input] = inputEnd - inputStart;
+        timing[FramePhase::Total] = inputEnd - m_frameStartMicros;
+        m_profiler.record(timing);
+        m_frameStartMicros = inputEnd;
+        m_drawStartMicros = inputEnd;
 
-            Input::InputManager::getInstance().update();
+        m_renderThisFrame = !shouldSkipRender();
+        if (m_renderThisFrame)
+        {
             beginDraw();
         }
+        else
+        {
+            // 空のクリップ領域を設定し、このフレームの描画をほぼ何もしないようにする
+            getCanvas().setClipRect(0, 0, 0, 0);
+            ++m_skippedFrameCount;
+        }
         return true;
     }
 
+    // フレームごとの処理時間の記録 (描画・転送・入力・待機の内訳)
+    static FrameProfiler &Profiler()
+    {
+        return getInstance().getProfiler();
+    }
+
+    FrameProfiler &getProfiler() { return m_profiler; }
+
+    // 処理時間の内訳を画面の左上に重ねて表示する
+    static void SetProfilerOverlay(bool enabled)
+    {
+        getInstance().setProfilerOverlay(enabled);
+    }
+
+    void setProfilerOverlay(bool enabled)
+    {
+        if (m_profilerOverlay && !enabled)
+        {
+            m_forceFullPresent = true;
+        }
+        m_profilerOverlay = enabled;
+    }
+
+    // 目標フレームレートの設定 (0 以下で上限なし)
+    static void SetTargetFPS(float fps)
+    {
+        getInstance().setTargetFPS(fps);
+    }
+
+    void setTargetFPS(float fps)
+    {
+        m_frameIntervalQ16 = (fps > 0.0f) ? uint64_t(65536.0 * 1000000.0 / fps) : 0;
+        m_nextFrameQ16 = nowMicros() << 16;
+    }
+
+    float getTargetFPS() const
+    {
+        return m_frameIntervalQ16 ? float(65536.0 * 1000000.0 / m_frameIntervalQ16) : 0.0f;
+    }
+
+    // 固定タイムステップ: DeltaTime() は常に 1 / 目標フレームレートになり、
+    // 処理が遅れているときは描画 (と転送) を省略して更新処理だけを進める
+    static void SetFixedTimestep(bool enabled)
+    {
+        getInstance().setFixedTimestep(enabled);
+    }
+
+    void setFixedTimestep(bool enabled) { m_fixedTimestep = enabled; }
+    bool isFixedTimestep() const { return m_fixedTimestep; }
+
+    // 描画を連続して省略できるフレーム数の上限
+    static void SetMaxFrameSkip(uint32_t frames)
+    {
+        getInstance().setMaxFrameSkip(frames);
+    }
+
+    void setMaxFrameSkip(uint32_t frames) { m_maxFrameSkip = frames; }
+
+    // 現在のフレームが描画・転送されるかどうか
+    // false のフレームでは描画が省略されるので、重い描画処理を飛ばしてよい
+    static bool IsRenderFrame()
+    {
+        return getInstance().isRenderFrame();
+    }
+
+    bool isRenderFrame() const { return m_renderThisFrame; }
+
+    // 描画を省略したフレームの累計
+    uint64_t getSkippedFrameCount() const { return m_skippedFrameCount; }
+
     // キャンバスへのアクセス
+    // DoubleBuffered のときは、フレームごとに入れ替わる描画先のバッファを返す
+    // Banded のときは帯のバッファを返す (文字幅の計算などには使えるが、直接描画した内容は表示されない)
     M5Canvas &getCanvas()
     {
-        return canvas;
+        return *m_target;
     }
 
     // 画面の幅と高さの取得
@@ -139,9 +641,9 @@ private:
     System() {} // プライベートコンストラクタ
 
     // システム変数
-    static constexpr int FRAME_INTERVAL = 16; // 約60FPS
-    uint32_t lastDrawTime = 0;
+    static constexpr float DefaultTargetFPS = 60.0f;
     M5Canvas canvas{&M5.Display};
+    M5Canvas *m_target = &canvas;
 
     // コピー禁止
     System(const System &) = delete;
@@ -149,22 +651,668 @@ private:
 
     Color m_backgroundColor = Palette::Black;
 
+    // 差分転送用
+    PresentMode m_presentMode = PresentMode::Full;
+    bool m_asyncPresent = true; // DoubleBuffered の転送をフレームをまたいで続けるか
+    DirtyRegion m_dirtyRegion;
+    DirtyRegion m_previousDirtyRegion;
+    DirtyRegion m_olderDirtyRegion;
+    bool m_forceFullPresent = true;
+
+    // 部分消去用
+    // 全面消去が必要なときは、ダブルバッファの両方が消去されるよう 2 フレーム続けて全面を塗りつぶす
+    static constexpr uint8_t FullClearFrames = 2;
+    ClearMode m_clearMode = ClearMode::Full;
+    uint8_t m_fullClearFrames = FullClearFrames;
+    uint32_t m_pushedPixels = 0;
+
+    // フレーム差分転送用
+    static constexpr int32_t DiffTileSize = 16;
+    M5Canvas m_presentedFrame{&M5.Display};
+    uint32_t m_pushedTiles = 0;
+
+    // 画面の圧縮転送用
+    Stream *m_streamTarget = nullptr;
+    FrameStreamEncoder m_streamEncoder;
+    uint32_t m_streamFrameInterval = 1;
+    uint32_t m_streamKeyFrameInterval = 0;
+    uint32_t m_streamFrames = 0;
+    size_t m_streamedBytes = 0;
+    M5Canvas m_captureStrip{&M5.Display}; // Banded のときに描画命令を描き直す帯
+
+    // ダブルバッファ転送用
+    SwapChain<M5Canvas, M5GFX, lgfx::swap565_t> m_swapChain{&M5.Display};
+
+    // 帯単位の描画用
+    static constexpr int32_t DefaultBandHeight = 40;
+    static constexpr int32_t MinBandHeight = 8;
+    int32_t m_bandHeight = DefaultBandHeight;
+    SwapChain<M5Canvas, M5GFX, lgfx::swap565_t> m_bandChain{&M5.Display};
+
+    // 描画命令の記録 (Banded と差分検出で使う)
+    DisplayList m_frameList;
+    DisplayList m_previousFrameList;
+    DirtyRegion m_markedRegion;
+    DirtyRegion m_previousMarkedRegion;
+    bool m_damageDetection = false;
+    DisplayList *m_recordingList = nullptr;
+
+    // 合成するレイヤー (重ね順に並べる)
+    std::vector<LayerBase *> m_layers;
+
+    // 転送方法に応じた描画先のバッファを確保する
+    bool createFrameBuffers(PresentMode mode)
+    {
+        const int32_t width = getWidth();
+        const int32_t height = getHeight();
+
+        if (mode == PresentMode::DoubleBuffered)
+        {
+            if (!m_swapChain.create(width, height))
+            {
+                return false;
+            }
+            m_swapChain.back().setTextSize(2);
+            m_swapChain.front().setTextSize(2);
+            m_target = &m_swapChain.back();
+            return true;
+        }
+
+        if (mode == PresentMode::Banded)
+        {
+            // 2 枚の帯を交互に使い、転送中に次の帯を描画する
+            for (int32_t bandHeight = std::min(m_bandHeight, height); bandHeight >= MinBandHeight; bandHeight /= 2)
+            {
+                if (m_bandChain.create(width, bandHeight))
+                {
+                    m_bandChain.back().setTextSize(2);
+                    m_bandChain.front().setTextSize(2);
+                    m_target = &m_bandChain.back();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        canvas.setColorDepth(16);
+        if (!canvas.createSprite(width, height))
+        {
+            return false;
+        }
+        canvas.setTextSize(2);
+        m_target = &canvas;
+        return true;
+    }
+
+    // 描画先のバッファをすべて解放する (転送中のものは完了を待つ)
+    void releaseFrameBuffers()
+    {
+        m_swapChain.release();
+        m_bandChain.release();
+        canvas.deleteSprite();
+        m_frameList.clear();
+        m_previousFrameList.clear();
+        m_target = &canvas;
+    }
+
+    // 描画前のキャンバスの消去
+    void clearCanvas()
+    {
+        if (m_presentMode == PresentMode::Banded)
+        {
+            // 帯ごとに消去するので、ここでは記録を空にするだけ
+            m_frameList.clear();
+            return;
+        }
+
+        auto &target = getCanvas();
+        const uint16_t background = m_backgroundColor.toRGB565();
+
+        // 背景色や描画先が変わった直後は、消去方法によらず全面を塗りつぶす
+        if (m_fullClearFrames > 0)
+        {
+            --m_fullClearFrames;
+            target.fillSprite(background);
+            return;
+        }
+
+        if (m_clearMode == ClearMode::Full)
+        {
+            target.fillSprite(background);
+        }
+        else if (m_clearMode == ClearMode::DirtyRegions)
+        {
+            // DoubleBuffered では描画先のバッファに最後に描画したのは 2 フレーム前
+            const DirtyRegion &drawn = (m_presentMode == PresentMode::DoubleBuffered) ? m_olderDirtyRegion : m_previousDirtyRegion;
+            if (drawn.isFull())
+            {
+                target.fillSprite(background);
+                return;
+            }
+            for (const auto &rect : drawn)
+            {
+                target.fillRect(rect.x, rect.y, rect.w, rect.h, background);
+            }
+        }
+    }
+
+    // 転送方法に応じて画面を更新する
+    void present()
+    {
+        if (m_presentMode == PresentMode::DoubleBuffered)
+        {
+            presentDoubleBuffered();
+        }
+        else if (m_presentMode == PresentMode::Banded)
+        {
+            presentBanded();
+        }
+        else if (m_presentMode == PresentMode::FrameDiff)
+        {
+            presentFrameDiff();
+        }
+        else if (m_presentMode == PresentMode::DirtyRect && !m_forceFullPresent)
+        {
+            presentDirtyRegions();
+        }
+        else
+        {
+            presentFull();
+        }
+        m_forceFullPresent = false;
+    }
+
+    // ストリーミングの間隔に合わせてフレームを書き出す
+    void streamFrame()
+    {
+        m_streamedBytes = 0;
+        const uint32_t frame = m_streamFrames++;
+        if (frame % m_streamFrameInterval)
+        {
+            return;
+        }
+        const uint32_t sent = frame / m_streamFrameInterval;
+        const bool key = m_streamKeyFrameInterval && (sent % m_streamKeyFrameInterval == 0);
+        if (writeFrame(m_streamEncoder, *m_streamTarget, key ? FrameStreamEncoder::FrameType::Key : FrameStreamEncoder::FrameType::Delta))
+        {
+            m_streamedBytes = m_streamEncoder.lastFrameBytes();
+        }
+    }
+
+    // 現在のフレームをタイルの行ごとに encoder に渡す
+    bool writeFrame(FrameStreamEncoder &encoder, Stream &stream, FrameStreamEncoder::FrameType type)
+    {
+        M5SIV3D_PROFILE_SCOPE("System::writeFrame");
+
+        const int32_t width = getWidth();
+        const int32_t height = getHeight();
+        const int32_t tileSize = FrameStreamEncoder::TileSize;
+        const bool banded = (m_presentMode == PresentMode::Banded);
+
+        const uint16_t *frame = nullptr;
+        if (!banded)
+        {
+            frame = static_cast<const uint16_t *>(getCanvas().getBuffer());
+            if (!frame)
+            {
+                Serial.println("FrameStream: canvas is not allocated");
+                return false;
+            }
+        }
+        else if (!m_captureStrip.getBuffer())
+        {
+            m_captureStrip.setColorDepth(16);
+            if (!m_captureStrip.createSprite(width, tileSize))
+            {
+                Serial.println("FrameStream: failed to allocate capture strip");
+                return false;
+            }
+        }
+
+        encoder.setSize(width, height);
+        encoder.beginFrame(stream, type, uint32_t(m_frameCount));
+        for (int32_t y = 0; y < height; y += tileSize)
+        {
+            const int32_t rows = std::min(tileSize, height - y);
+            if (banded)
+            {
+                m_captureStrip.fillSprite(m_backgroundColor.toRGB565());
+                m_frameList.replay(m_captureStrip, 0, -y);
+                encoder.addTileRow(y, static_cast<const uint16_t *>(m_captureStrip.getBuffer()), width, rows);
+            }
+            else
+            {
+                encoder.addTileRow(y, frame + size_t(y) * size_t(width), width, rows);
+            }
+        }
+        encoder.endFrame();
+        return true;
+    }
+
+    // 登録されたレイヤーのうち、背面 (z < 0) または前面 (z >= 0) のものを重ね順に合成する
+    void compositeLayers(bool front)
+    {
+        for (LayerBase *layer : m_layers)
+        {
+            if ((layer->getZ() >= 0) == front)
+            {
+                layer->composite();
+            }
+        }
+    }
+
+    // 記録した描画命令を帯ごとに再生して転送する
+    // 画面は前回の内容を保持しているので、前フレームの記録から変化した領域に掛かる帯だけを描き直す
+    void presentBanded()
+    {
+        M5SIV3D_PROFILE_SCOPE("System::presentBanded");
+
+        if (!m_bandChain.isCreated())
+        {
+            return;
+        }
+
+        DirtyRegion region = detectDamage();
+        if (m_forceFullPresent)
+        {
+            region.addAll();
+        }
+
+        const int32_t width = getWidth();
+        const int32_t height = getHeight();
+        const int32_t bandHeight = m_bandChain.back().height();
+        const uint16_t background = m_backgroundColor.toRGB565();
+
+        m_pushedPixels = 0;
+        m_pushedTiles = 0;
+        for (int32_t y = 0; y < height; y += bandHeight)
+        {
+            const DirtyRect band(0, y, width, std::min(bandHeight, height - y));
+            if (!region.intersects(band))
+            {
+                continue;
+            }
+
+            M5Canvas &strip = m_bandChain.back();
+            strip.fillSprite(background);
+            m_frameList.replay(strip, 0, -y);
+            m_bandChain.present(0, y, band.h);
+            m_pushedPixels += band.area();
+        }
+
+        // 帯の転送はフレームの中で次の帯の描画と並行させ、フレームの終わりにはバスを解放する
+        // (Banded を使うメモリの少ない Core では SD カードが LCD とバスを共有している)
+        m_bandChain.fence();
+        m_target = &m_bandChain.back();
+    }
+
+    // 前フレームとの描画命令の差分と、MarkDirty で通知された領域
+    DirtyRegion detectDamage() const
+    {
+        DirtyRegion region = m_markedRegion;
+        region.add(m_previousMarkedRegion);
+        DisplayList::Diff(m_previousFrameList, m_frameList, region);
+        return region;
+    }
+
+    // 描画済みのバッファの DMA 転送を開始し、転送の終わったもう一方のバッファを次の描画先にする
+    // 転送は次のフレームの描画と並行して続け、バスは次の present() か WaitPresent() で解放する
+    // SetAsyncPresent(false) の場合は、転送の完了を待ってから戻る
+    void presentDoubleBuffered()
+    {
+        m_swapChain.present();
+        if (!m_asyncPresent)
+        {
+            // バスを共有する SD カードなどが使えるよう、フレームの終わりにはバスを解放する
+            m_swapChain.fence();
+        }
+        m_target = &m_swapChain.back();
+        m_pushedPixels = uint32_t(m_target->width()) * uint32_t(m_target->height());
+        m_pushedTiles = 0;
+    }
+
+    void presentFull()
+    {
+        canvas.pushSprite(0, 0);
+        m_pushedPixels = uint32_t(canvas.width()) * uint32_t(canvas.height());
+        m_pushedTiles = 0;
+    }
+
+    // 今回と前回のフレームで描画された領域だけを転送する
+    // (前回描画した内容は beginDraw の全面クリアで消えているため、その領域も転送が必要)
+    void presentDirtyRegions()
+    {
+        DirtyRegion region = m_dirtyRegion;
+        if (m_damageDetection)
+        {
+            region = detectDamage();
+        }
+        else
+        {
+            region.add(m_previousDirtyRegion);
+        }
+
+        m_pushedPixels = 0;
+        if (region.isEmpty())
+        {
+            return;
+        }
+
+        auto &display = M5.Display;
+        display.startWrite();
+        for (const auto &rect : region)
+        {
+            display.setClipRect(rect.x, rect.y, rect.w, rect.h);
+            canvas.pushSprite(0, 0);
+            m_pushedPixels += rect.area();
+        }
+        display.clearClipRect();
+        display.endWrite();
+    }
+
+    // 前回転送したフレームのコピーとタイル単位で比較し、変化したタイルだけを転送する
+    // 横に連続する変化タイルはまとめて 1 回で転送する
+    void presentFrameDiff()
+    {
+        const int32_t width = canvas.width();
+        const int32_t height = canvas.height();
+        const size_t frameBytes = size_t(width) * size_t(height) * sizeof(uint16_t);
+
+        if (!m_presentedFrame.getBuffer())
+        {
+            m_presentedFrame.setColorDepth(16);
+            m_presentedFrame.setPsram(true);
+            if (!m_presentedFrame.createSprite(width, height))
+            {
+                Serial.println("FrameDiff: failed to allocate comparison frame");
+                m_presentMode = PresentMode::Full;
+                presentFull();
+                return;
+            }
+            m_forceFullPresent = true;
+        }
+
+        const uint16_t *current = static_cast<const uint16_t *>(canvas.getBuffer());
+        uint16_t *presented = static_cast<uint16_t *>(m_presentedFrame.getBuffer());
+
+        if (m_forceFullPresent)
+        {
+            memcpy(presented, current, frameBytes);
+            presentFull();
+            m_pushedTiles = uint32_t((width + DiffTileSize - 1) / DiffTileSize) * uint32_t((height + DiffTileSize - 1) / DiffTileSize);
+            return;
+        }
+
+        m_pushedPixels = 0;
+        m_pushedTiles = 0;
+
+        auto &display = M5.Display;
+        bool writing = false;
+
+        for (int32_t ty = 0; ty < height; ty += DiffTileSize)
+        {
+            const int32_t th = std::min(int32_t(DiffTileSize), height - ty);
+            int32_t runStart = -1;
+
+            // 最後に画面の外の位置を 1 回通り、行の右端まで続く変化タイルも転送する
+            // (幅が DiffTileSize の倍数でない画面でも最後の位置は width 以上になる)
+            for (int32_t tx = 0; tx < width + DiffTileSize; tx += DiffTileSize)
+            {
+                const int32_t tw = std::min(int32_t(DiffTileSize), width - tx);
+                const bool changed = (tx < width) && tileChanged(current, presented, width, tx, ty, tw, th);
+
+                if (changed)
+                {
+                    for (int32_t y = ty; y < ty + th; ++y)
+                    {
+                        const size_t offset = size_t(y) * width + tx;
+                        memcpy(presented + offset, current + offset, tw * sizeof(uint16_t));
+                    }
+                    ++m_pushedTiles;
+                    if (runStart < 0)
+                    {
+                        runStart = tx;
+                    }
+                    continue;
+                }
+
+                if (runStart >= 0)
+                {
+                    if (!writing)
+                    {
+                        display.startWrite();
+                        writing = true;
+                    }
+                    const int32_t runWidth = std::min(tx, width) - runStart;
+                    display.setClipRect(runStart, ty, runWidth, th);
+                    canvas.pushSprite(0, 0);
+                    m_pushedPixels += uint32_t(runWidth) * uint32_t(th);
+                    runStart = -1;
+                }
+            }
+        }
+
+        if (writing)
+        {
+            display.clearClipRect();
+            display.endWrite();
+        }
+    }
+
+    // タイルが前回のフレームから変化したかどうか
+    static bool tileChanged(const uint16_t *current, const uint16_t *presented, int32_t stride,
+                            int32_t tx, int32_t ty, int32_t tw, int32_t th)
+    {
+        for (int32_t y = ty; y < ty + th; ++y)
+        {
+            const size_t offset = size_t(y) * stride + tx;
+            if (!rowEquals(current + offset, presented + offset, tw))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 32bit 単位で 2 画素ずつ比較する (境界が揃っていない場合は memcmp)
+    static bool rowEquals(const uint16_t *a, const uint16_t *b, int32_t count)
+    {
+        if (((reinterpret_cast<uintptr_t>(a) | reinterpret_cast<uintptr_t>(b)) & 3) != 0)
+        {
+            return memcmp(a, b, count * sizeof(uint16_t)) == 0;
+        }
+
+        const uint32_t *wa = reinterpret_cast<const uint32_t *>(a);
+        const uint32_t *wb = reinterpret_cast<const uint32_t *>(b);
+        const int32_t words = count / 2;
+        for (int32_t i = 0; i < words; ++i)
+        {
+            if (wa[i] != wb[i])
+            {
+                return false;
+            }
+        }
+        return (count & 1) == 0 || a[count - 1] == b[count - 1];
+    }
+
+    // 処理時間の計測用
+    FrameProfiler m_profiler;
+    uint32_t m_frameStartMicros = 0;
+    uint32_t m_drawStartMicros = 0;
+    bool m_profilerOverlay = false;
+
+    // 表示の大きさ (Font0 の 6x8 ドットの文字で 25 文字 × 6 行)
+    static constexpr int32_t OverlayWidth = 25 * 6 + 4;
+    static constexpr int32_t OverlayHeight = int32_t(FrameTiming::PhaseCount + 1) * 8 + 4;
+
+    // 各区間の平均・最大・99 パーセンタイル (ms) を表示する
+    static void DrawProfilerOverlay(lgfx::LovyanGFX &target, int32_t dx, int32_t dy, void *context)
+    {
+        const System &system = *static_cast<const System *>(context);
+        const auto *font = target.getFont();
+        const auto style = target.getTextStyle();
+
+        target.setFont(&fonts::Font0);
+        target.setTextSize(1);
+        target.setTextColor(TFT_WHITE, TFT_BLACK);
+        target.fillRect(dx, dy, OverlayWidth, OverlayHeight, TFT_BLACK);
+
+        const int32_t lineHeight = target.fontHeight();
+        char line[40];
+        target.drawString("ms        avg   max   p99", dx + 2, dy + 2);
+        for (size_t i = 0; i < FrameTiming::PhaseCount; ++i)
+        {
+            const FramePhase phase = static_cast<FramePhase>(i);
+            const PhaseStats s = system.m_profiler.stats(phase);
+            snprintf(line, sizeof(line), "%-7s %5.1f %5.1f %5.1f", FrameProfiler::PhaseName(phase),
+                     s.avg / 1000.0f, s.max / 1000.0f, s.p99 / 1000.0f);
+            target.drawString(line, dx + 2, dy + 2 + lineHeight * int32_t(i + 1));
+        }
+
+        target.setFont(font);
+        target.setTextStyle(style);
+    }
+
     // 時間管理用メンバ変数
     float m_deltaTime = 0.0f;
-    float m_averageFrameTime = FRAME_INTERVAL;
+    float m_averageFrameTime = 1000.0f / DefaultTargetFPS;
     uint64_t m_frameCount = 0;
-    uint32_t m_previousTime = 0;
+    uint64_t m_previousTime = 0;
+
+    // フレームの予定時刻 (μs を 16bit 左シフトした固定小数点)
+    // 間隔の端数も積算するので、平均フレームレートが目標値に一致する
+    uint64_t m_frameIntervalQ16 = uint64_t(65536.0 * 1000000.0 / DefaultTargetFPS);
+    uint64_t m_nextFrameQ16 = 0;
+    bool m_fixedTimestep = false;
+    uint32_t m_maxFrameSkip = 4;
+    uint32_t m_consecutiveSkips = 0;
+    bool m_behind = false;
+    bool m_renderThisFrame = true;
+    uint64_t m_skippedFrameCount = 0;
+
+    // micros() の桁あふれ (約71分) を補正した 64bit の時刻
+    uint32_t m_lastMicros = 0;
+    uint64_t m_microsHigh = 0;
+
+    uint64_t nowMicros()
+    {
+        const uint32_t now = micros();
+        if (now < m_lastMicros)
+        {
+            m_microsHigh += uint64_t(1) << 32;
+        }
+        m_lastMicros = now;
+        return m_microsHigh | now;
+    }
+
+    // 次のフレームの予定時刻まで待つ
+    void waitForNextFrame()
+    {
+        const uint64_t now = nowMicros();
+        if (m_frameIntervalQ16 == 0)
+        {
+            m_behind = false;
+            return;
+        }
+
+        m_nextFrameQ16 += m_frameIntervalQ16;
+        const uint64_t deadline = m_nextFrameQ16 >> 16;
+        if (now < deadline)
+        {
+            sleepUntil(deadline);
+            m_behind = false;
+            return;
+        }
+
+        // 予定時刻を過ぎている場合は待たずに進める
+        // 遅れが 1 フレームに満たなければ以降のフレームで取り戻し、
+        // 大きく遅れたときは予定を組み直す (固定タイムステップでは描画の省略で追いつける分まで許す)
+        const uint64_t lag = now - deadline;
+        const uint64_t interval = m_frameIntervalQ16 >> 16;
+        const uint64_t tolerance = m_fixedTimestep ? interval * (m_maxFrameSkip + 1) : interval;
+        if (lag > tolerance)
+        {
+            m_nextFrameQ16 = now << 16;
+            m_behind = false;
+            return;
+        }
+        m_behind = lag >= interval;
+    }
+
+    // ミリ秒単位の待機は RTOS に譲り、残りをμs単位で待つ
+    void sleepUntil(uint64_t deadline)
+    {
+        uint64_t now = nowMicros();
+        if (deadline > now + 2000)
+        {
+            M5.delay(uint32_t((deadline - now - 1000) / 1000));
+            now = nowMicros();
+        }
+        if (deadline > now)
+        {
+            delayMicroseconds(uint32_t(deadline - now));
+        }
+    }
+
+    // 次のフレームの描画を省略するかどうか
+    bool shouldSkipRender()
+    {
+        if (m_fixedTimestep && m_behind && m_consecutiveSkips < m_maxFrameSkip)
+        {
+            ++m_consecutiveSkips;
+            return true;
+        }
+        m_consecutiveSkips = 0;
+        return false;
+    }
 
     // Update内で呼び出す時間更新処理
-    void updateTime()
+    // deltaMicros は DeltaTime に使う経過時間 (FPS は実際の経過時間で計算する)
+    void updateTime(uint64_t currentTime, uint32_t deltaMicros)
     {
-        uint32_t currentTime = millis();
-        m_deltaTime = (currentTime - m_previousTime) / 1000.0f;
+        const float frameTimeMs = (currentTime - m_previousTime) / 1000.0f;
+
+        if (m_fixedTimestep && m_frameIntervalQ16)
+        {
+            m_deltaTime = float(m_frameIntervalQ16 / 65536.0 / 1000000.0);
+        }
+        else
+        {
+            m_deltaTime = deltaMicros / 1000000.0f;
+        }
 
         // 移動平均でFPSを計算
-        m_averageFrameTime = m_averageFrameTime * 0.9f + (currentTime - m_previousTime) * 0.1f;
+        m_averageFrameTime = m_averageFrameTime * 0.9f + frameTimeMs * 0.1f;
 
         m_previousTime = currentTime;
         m_frameCount++;
     }
-}; 
\ No newline at end of file
+}; 
+// スコープの間の描画命令を DisplayList に記録する
+//
+//   DisplayList background;
+//   {
+//       RecordingScope recording(background);
+//       Rect(0, 0, 320, 40).draw(Palette::Gray);
+//   }
+//   System::Submit(background); // 毎フレーム描画する
+class RecordingScope
+{
+public:
+    explicit RecordingScope(DisplayList &list)
+        : m_previous(System::BeginRecording(list))
+    {
+    }
+
+    ~RecordingScope()
+    {
+        System::EndRecording(m_previous);
+    }
+
+private:
+    DisplayList *m_previous;
+
+    // コピー禁止
+    RecordingScope(const RecordingScope &) = delete;
+    RecordingScope &operator=(const RecordingScope &) = delete;
+};
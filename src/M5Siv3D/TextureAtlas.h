@@ -0,0 +1,206 @@
+#pragma once
+
+#include "Platform.h"
+#include "Image.h"
+#include "ImageData.h"
+#include "Base64Stream.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <algorithm>
+#include <vector>
+
+// TextureAtlas の中の 1 枚の画像
+class AtlasRegion
+{
+public:
+    AtlasRegion() : m_image(nullptr) {}
+    AtlasRegion(const Image &image, const ImageRegion &region) : m_image(&image), m_region(region) {}
+
+    void draw(int32_t x, int32_t y) const
+    {
+        if (m_image)
+        {
+            m_image->drawRegion(x, y, m_region);
+        }
+    }
+
+    int32_t width() const { return m_region.w; }
+    int32_t height() const { return m_region.h; }
+    const ImageRegion &region() const { return m_region; }
+    bool isEmpty() const { return !m_image || m_region.isEmpty(); }
+
+private:
+    const Image *m_image;
+    ImageRegion m_region;
+};
+
+// 複数の画像を 1 つのスプライトに詰めたもの
+//
+// 画像ごとに M5Canvas を持つ代わりに、小さな画像をまとめて 1 回で確保する。
+// 実行時に詰める場合は add() で画像を登録してから build() を呼ぶ。
+//
+//   TextureAtlas atlas;
+//   const size_t coin = atlas.add(coinData);        // ImageData (フラッシュ)
+//   const size_t heart = atlas.addBase64(heartPng); // base64 の PNG
+//   atlas.build();
+//   atlas[coin].draw(10, 10);
+//
+// tools/image_to_rgb565.py --atlas でビルド時に詰めた画像は、領域の表と一緒に渡す。
+//
+//   const TextureAtlas icons(icons_atlas, icons_regions, icons_count);
+class TextureAtlas
+{
+public:
+    TextureAtlas() = default;
+
+    // ビルド時に詰めた画像 (data と regions は TextureAtlas より長く存在する必要がある)
+    TextureAtlas(const ImageData &data, const ImageRegion *regions, size_t count)
+        : m_image(data), m_regions(regions, regions + count) {}
+
+    TextureAtlas(const TextureAtlas &) = delete;
+    TextureAtlas &operator=(const TextureAtlas &) = delete;
+
+    // 詰める画像を登録する (返り値は operator[] で使う番号)
+    // data は build() まで存在する必要がある
+    size_t add(const ImageData &data)
+    {
+        m_sources.push_back(Source{&data, nullptr});
+        m_regions.push_back(ImageRegion(0, 0, data.width, data.height));
+        return m_regions.size() - 1;
+    }
+
+    // base64 の PNG を登録する (build() のときにデコードする)
+    size_t addBase64(const char *base64Data)
+    {
+        m_sources.push_back(Source{nullptr, base64Data});
+        m_regions.push_back(ImageRegion());
+        return m_regions.size() - 1;
+    }
+
+    // 登録した画像を幅 maxWidth 以内に詰め、1 つのスプライトに描き込む
+    bool build(int32_t maxWidth = 256)
+    {
+        if (m_sources.size() != m_regions.size())
+        {
+            Serial.println("TextureAtlas: already built");
+            return false;
+        }
+
+        for (size_t i = 0; i < m_sources.size(); ++i)
+        {
+            if (m_sources[i].base64 && !ReadPngSize(m_sources[i].base64, m_regions[i]))
+            {
+                Serial.printf("TextureAtlas: image %u is not a PNG\n", unsigned(i));
+                return false;
+            }
+        }
+
+        const int32_t height = Pack(m_regions, maxWidth);
+        if (height < 0)
+        {
+            Serial.println("TextureAtlas: an image is wider than the atlas");
+            return false;
+        }
+        int32_t width = 0;
+        for (const ImageRegion &region : m_regions)
+        {
+            width = std::max(width, region.x + region.w);
+        }
+        if (!m_image.create(std::max<int32_t>(1, width), std::max<int32_t>(1, height)))
+        {
+            return false;
+        }
+
+        M5Canvas &canvas = *m_image.m_canvas;
+        for (size_t i = 0; i < m_sources.size(); ++i)
+        {
+            const ImageRegion &region = m_regions[i];
+            if (m_sources[i].data)
+            {
+                ImageBlit::Draw(canvas, *m_sources[i].data, region.x, region.y);
+                continue;
+            }
+            Base64Stream stream(m_sources[i].base64);
+            if (!canvas.drawPng(&stream, region.x, region.y))
+            {
+                Serial.printf("TextureAtlas: failed to draw image %u\n", unsigned(i));
+                return false;
+            }
+        }
+
+        // 詰め終わったら元の画像は参照しない
+        std::vector<Source>().swap(m_sources);
+        ++m_image.m_revision;
+        return true;
+    }
+
+    AtlasRegion operator[](size_t index) const
+    {
+        return (index < m_regions.size()) ? AtlasRegion(m_image, m_regions[index]) : AtlasRegion();
+    }
+
+    size_t size() const { return m_regions.size(); }
+
+    // 詰めた後の画像全体
+    const Image &image() const { return m_image; }
+
+    // 棚詰め: 高い順に、幅 maxWidth の棚へ左から並べる
+    // regions の w, h から x, y を決め、全体の高さを返す (幅が maxWidth を超える画像がある場合は -1)
+    static int32_t Pack(std::vector<ImageRegion> &regions, int32_t maxWidth)
+    {
+        std::vector<size_t> order(regions.size());
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&regions](size_t a, size_t b) {
+            return regions[a].h > regions[b].h;
+        });
+
+        int32_t x = 0, y = 0, shelfHeight = 0;
+        for (size_t index : order)
+        {
+            ImageRegion &region = regions[index];
+            if (region.w > maxWidth)
+            {
+                return -1;
+            }
+            if (x + region.w > maxWidth)
+            {
+                y += shelfHeight;
+                x = 0;
+                shelfHeight = 0;
+            }
+            region.x = x;
+            region.y = y;
+            x += region.w;
+            shelfHeight = std::max(shelfHeight, region.h);
+        }
+        return y + shelfHeight;
+    }
+
+private:
+    struct Source
+    {
+        const ImageData *data;
+        const char *base64;
+    };
+
+    Image m_image;
+    std::vector<ImageRegion> m_regions;
+    std::vector<Source> m_sources; // build() するまでの登録内容
+
+    // PNG の IHDR から大きさを読む
+    static bool ReadPngSize(const char *base64Data, ImageRegion &region)
+    {
+        Base64Stream stream(base64Data);
+        uint8_t header[24];
+        if (stream.read(header, sizeof(header)) != int(sizeof(header)) || header[0] != 0x89 || header[1] != 'P')
+        {
+            return false;
+        }
+        region.w = (header[16] << 24) | (header[17] << 16) | (header[18] << 8) | header[19];
+        region.h = (header[20] << 24) | (header[21] << 16) | (header[22] << 8) | header[23];
+        return true;
+    }
+};
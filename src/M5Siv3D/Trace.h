@@ -0,0 +1,219 @@
+#pragma once
+
+#include "Platform.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+
+// 区間計測 (トレース)
+//
+// M5SIV3D_PROFILE_SCOPE("name") を置いたスコープの開始・終了時刻を固定長の
+// リングバッファに記録し、TraceBuffer::Dump() でバイナリとしてシリアルに出力する。
+// 出力は tools/trace_to_chrome.py で Chrome のトレース形式 (JSON) に変換できる。
+//
+// M5SIV3D_ENABLE_PROFILING を定義しない場合、マクロは何も生成しない。
+
+// 1 区間分の記録
+struct TraceEvent
+{
+    const char *name; // 文字列リテラル (ポインタのみ保持する)
+    uint32_t beginMicros;
+    uint32_t durationMicros;
+    uint8_t core;
+};
+
+// 区間の記録を保持するリングバッファ
+// 書き込み位置を atomic に確保するので、割り込みや別コアから同時に記録しても
+// 同じ要素を取り合わない (古い記録は上書きされる)
+class TraceBuffer
+{
+public:
+    static constexpr uint32_t Capacity = 512; // 2 の累乗
+
+    // ダンプ形式の識別子とバージョン
+    static constexpr uint8_t FormatVersion = 1;
+
+    static TraceBuffer &getInstance()
+    {
+        static TraceBuffer instance;
+        return instance;
+    }
+
+    void record(const char *name, uint32_t beginMicros, uint32_t endMicros)
+    {
+        if (!m_enabled)
+        {
+            return;
+        }
+        const uint32_t index = m_writeIndex.fetch_add(1, std::memory_order_relaxed) & (Capacity - 1);
+        TraceEvent &event = m_events[index];
+        event.name = name;
+        event.beginMicros = beginMicros;
+        event.durationMicros = endMicros - beginMicros;
+        event.core = currentCore();
+    }
+
+    // 記録の一時停止・再開
+    static void SetEnabled(bool enabled)
+    {
+        getInstance().m_enabled = enabled;
+    }
+
+    bool isEnabled() const { return m_enabled; }
+
+    void clear()
+    {
+        m_writeIndex.store(0, std::memory_order_relaxed);
+    }
+
+    // 保持している記録の数
+    uint32_t size() const
+    {
+        const uint32_t written = m_writeIndex.load(std::memory_order_relaxed);
+        return written < Capacity ? written : Capacity;
+    }
+
+    // 古い順に index 番目の記録
+    const TraceEvent &operator[](uint32_t index) const
+    {
+        const uint32_t written = m_writeIndex.load(std::memory_order_relaxed);
+        return m_events[(written - size() + index) & (Capacity - 1)];
+    }
+
+    static void Dump(Stream &stream = Serial)
+    {
+        getInstance().dump(stream);
+    }
+
+    // 記録をバイナリで出力する (値はすべてリトルエンディアン)
+    //
+    //   "M5TR" u8:version u8:0 u16:nameCount
+    //   nameCount × { u8:length, char[length] }
+    //   u32:eventCount
+    //   eventCount × { u16:nameIndex u8:core u8:0 u32:beginMicros u32:durationMicros }
+    //
+    // ダンプ中の記録を避けるため、出力の間は記録を止める
+    void dump(Stream &stream)
+    {
+        const bool wasEnabled = m_enabled;
+        m_enabled = false;
+
+        // 名前はポインタで区別し、出現順に番号を振る
+        const char *names[MaxNames];
+        uint16_t nameCount = 0;
+        const uint32_t count = size();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (findName(names, nameCount, (*this)[i].name) == UnknownName && nameCount < MaxNames)
+            {
+                names[nameCount++] = (*this)[i].name;
+            }
+        }
+
+        const uint8_t header[8] = {'M', '5', 'T', 'R', FormatVersion, 0,
+                                   uint8_t(nameCount), uint8_t(nameCount >> 8)};
+        stream.write(header, sizeof(header));
+        for (uint16_t i = 0; i < nameCount; ++i)
+        {
+            const size_t length = std::min<size_t>(strlen(names[i]), 255);
+            stream.write(uint8_t(length));
+            stream.write(reinterpret_cast<const uint8_t *>(names[i]), length);
+        }
+
+        uint8_t buffer[12];
+        writeU32(buffer, count);
+        stream.write(buffer, 4);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const TraceEvent &event = (*this)[i];
+            const uint16_t nameIndex = findName(names, nameCount, event.name);
+            buffer[0] = uint8_t(nameIndex);
+            buffer[1] = uint8_t(nameIndex >> 8);
+            buffer[2] = event.core;
+            buffer[3] = 0;
+            writeU32(buffer + 4, event.beginMicros);
+            writeU32(buffer + 8, event.durationMicros);
+            stream.write(buffer, sizeof(buffer));
+        }
+        stream.flush();
+
+        m_enabled = wasEnabled;
+    }
+
+private:
+    TraceBuffer() {}
+
+    // コピー禁止
+    TraceBuffer(const TraceBuffer &) = delete;
+    TraceBuffer &operator=(const TraceBuffer &) = delete;
+
+    static constexpr uint16_t MaxNames = 128;
+    static constexpr uint16_t UnknownName = 0xFFFF;
+
+    TraceEvent m_events[Capacity];
+    std::atomic<uint32_t> m_writeIndex{0};
+    volatile bool m_enabled = true;
+
+    static uint16_t findName(const char *const *names, uint16_t count, const char *name)
+    {
+        for (uint16_t i = 0; i < count; ++i)
+        {
+            if (names[i] == name)
+            {
+                return i;
+            }
+        }
+        return UnknownName;
+    }
+
+    static void writeU32(uint8_t *out, uint32_t value)
+    {
+        out[0] = uint8_t(value);
+        out[1] = uint8_t(value >> 8);
+        out[2] = uint8_t(value >> 16);
+        out[3] = uint8_t(value >> 24);
+    }
+
+    static uint8_t currentCore()
+    {
+#if defined(ESP_PLATFORM)
+        return uint8_t(xPortGetCoreID());
+#else
+        return 0;
+#endif
+    }
+};
+
+// スコープの開始から終了までを 1 区間として記録する
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char *name)
+        : m_name(name), m_begin(micros())
+    {
+    }
+
+    ~ProfileScope()
+    {
+        TraceBuffer::getInstance().record(m_name, m_begin, micros());
+    }
+
+private:
+    const char *m_name;
+    uint32_t m_begin;
+
+    // コピー禁止
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+};
+
+#define M5SIV3D_PROFILE_CONCAT_IMPL(a, b) a##b
+#define M5SIV3D_PROFILE_CONCAT(a, b) M5SIV3D_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef M5SIV3D_ENABLE_PROFILING
+#define M5SIV3D_PROFILE_SCOPE(name) ProfileScope M5SIV3D_PROFILE_CONCAT(m5siv3dProfileScope, __LINE__)(name)
+#else
+#define M5SIV3D_PROFILE_SCOPE(name) ((void)0)
+#endif
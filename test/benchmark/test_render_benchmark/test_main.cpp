@@ -0,0 +1,334 @@
+#include <unity.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include "M5Siv3D.h"
+
+// 描画命令ごとのスループット計測
+//
+//   pio test -e native-benchmark            (ホスト)
+//   pio test -e m5stack-core2 -f "benchmark/*" (実機)
+//
+// 結果は "M5SIV3D_BENCH " に続く 1 行の JSON として出力する。
+// tools/bench_compare.py で前回の結果と比較できる。
+//
+// 計測するのは System::Submit からキャンバスへの描画まで (PresentMode::Full)。
+// 画面への転送は present/Full として別に計測する。
+// pixels は図形の大きさから求めた理論上の画素数で、描画された画素を数えたものではない。
+// ホストの結果は Host/ の描画実装の速度なので、実機との比較ではなく回帰の検出に使う。
+namespace
+{
+    // 1 ケースあたりの計測時間
+    constexpr uint32_t TargetMicros = 200000;
+    constexpr uint32_t WarmupCalls = 8;
+
+    struct BenchCase
+    {
+        std::string name;
+        double pixelsPerCall;
+        std::function<void(uint32_t)> draw; // 引数は呼び出し回数 (位置をずらすのに使う)
+    };
+
+    struct BenchResult
+    {
+        std::string name;
+        uint32_t calls;
+        uint32_t micros;
+        double pixelsPerCall;
+    };
+
+    const char *PlatformName()
+    {
+#if defined(M5SIV3D_HOST)
+        return "native";
+#elif defined(ARDUINO_BOARD)
+        return ARDUINO_BOARD;
+#else
+        return "esp32";
+#endif
+    }
+
+    // i から画面内の位置を作る (毎回同じ画素に描かないようにする)
+    int32_t offsetX(uint32_t i) { return int32_t(i % 7) * 20; }
+    int32_t offsetY(uint32_t i) { return int32_t(i % 5) * 20; }
+
+    Image g_image;
+    Font g_font(fonts::Font0);
+
+    // フラッシュの画像の計測用 (32x32、RLE は 1 行 4 つの組)
+    uint16_t g_flashPixels[32 * 32];
+    uint16_t g_flashRuns[32 * 8];
+    uint32_t g_flashRows[32];
+    const ImageData g_flashData = ImageData::RGB565(32, 32, g_flashPixels);
+    const Image g_flashImage(g_flashData);
+    const ImageData g_flashRLEData = ImageData::RLE(32, 32, g_flashRuns, g_flashRows);
+    const Image g_flashRLE(g_flashRLEData);
+
+    // 色変換の計測用 (1 回の呼び出しで変換する色の数)
+    constexpr size_t ColorBatch = 1024;
+    std::vector<Color> g_colors;
+    std::vector<uint16_t> g_packed;
+
+    const char *AlignName(Font::HorizontalAlign align)
+    {
+        return align == Font::HorizontalAlign::Left ? "Left" : align == Font::HorizontalAlign::Center ? "Center" : "Right";
+    }
+
+    const char *AlignName(Font::VerticalAlign align)
+    {
+        return align == Font::VerticalAlign::Top ? "Top" : align == Font::VerticalAlign::Center ? "Center"
+                                                     : align == Font::VerticalAlign::Bottom ? "Bottom" : "Baseline";
+    }
+
+    std::vector<BenchCase> makeCases()
+    {
+        const double pi = 3.14159265358979;
+        std::vector<BenchCase> cases;
+
+        // Shapes.h
+        cases.push_back({"Circle::draw", pi * 20 * 20, [](uint32_t i) { Circle(60 + offsetX(i), 60 + offsetY(i), 20).draw(Palette::Red); }});
+        cases.push_back({"Circle::drawFrame", 2 * pi * 20, [](uint32_t i) { Circle(60 + offsetX(i), 60 + offsetY(i), 20).drawFrame(Palette::Red); }});
+        cases.push_back({"Circle::fillArc", pi * (30 * 30 - 20 * 20) / 2, [](uint32_t i) { Circle(60 + offsetX(i), 60 + offsetY(i), 30).fillArc(20, 0, 180, Palette::Red); }});
+        cases.push_back({"Circle::drawArc", pi * (30 + 20) + 20, [](uint32_t i) { Circle(60 + offsetX(i), 60 + offsetY(i), 30).drawArc(20, 0, 180, Palette::Red); }});
+        cases.push_back({"Rect::draw", 40 * 30, [](uint32_t i) { Rect(20 + offsetX(i), 20 + offsetY(i), 40, 30).draw(Palette::Green); }});
+        cases.push_back({"Rect::drawFrame", 2 * (40 + 30) - 4, [](uint32_t i) { Rect(20 + offsetX(i), 20 + offsetY(i), 40, 30).drawFrame(Palette::Green); }});
+        cases.push_back({"Rect::drawRound", 40 * 30 - (4 - pi) * 6 * 6, [](uint32_t i) { Rect(20 + offsetX(i), 20 + offsetY(i), 40, 30).drawRound(6, Palette::Green); }});
+        cases.push_back({"Rect::drawRoundFrame", 2 * (40 + 30) - 8 * 6 + 2 * pi * 6, [](uint32_t i) { Rect(20 + offsetX(i), 20 + offsetY(i), 40, 30).drawRoundFrame(6, Palette::Green); }});
+        cases.push_back({"Triangle::draw", 40 * 30 / 2, [](uint32_t i) {
+                             const int32_t x = 20 + offsetX(i), y = 20 + offsetY(i);
+                             Triangle(x, y + 30, x + 40, y + 30, x + 20, y).draw(Palette::Blue);
+                         }});
+        cases.push_back({"Triangle::drawFrame", 40 + 2 * 36, [](uint32_t i) {
+                             const int32_t x = 20 + offsetX(i), y = 20 + offsetY(i);
+                             Triangle(x, y + 30, x + 40, y + 30, x + 20, y).drawFrame(Palette::Blue);
+                         }});
+        cases.push_back({"Line::draw", 61, [](uint32_t i) {
+                             const int32_t x = 20 + offsetX(i), y = 20 + offsetY(i);
+                             Line(x, y, x + 60, y + 40).draw(Palette::White);
+                         }});
+        cases.push_back({"Bezier3::draw", 80, [](uint32_t i) {
+                             const int32_t x = 20 + offsetX(i), y = 60 + offsetY(i);
+                             Bezier::create3Point(x, y, x + 30, y - 40, x + 60, y).draw(Palette::White);
+                         }});
+        cases.push_back({"Bezier4::draw", 110, [](uint32_t i) {
+                             const int32_t x = 20 + offsetX(i), y = 60 + offsetY(i);
+                             Bezier::create4Point(x, y, x + 20, y - 40, x + 40, y + 40, x + 60, y).draw(Palette::White);
+                         }});
+
+        // 同じ色のまま、変換済みの Color565 で描画した場合
+        cases.push_back({"Rect::draw/Color565", 40 * 30, [](uint32_t i) {
+                             static const Color565 color = Palette::Green;
+                             Rect(20 + offsetX(i), 20 + offsetY(i), 40, 30).draw(color);
+                         }});
+
+        // 描画先との合成
+        cases.push_back({"Rect::draw/alpha", 40 * 30, [](uint32_t i) { Rect(20 + offsetX(i), 20 + offsetY(i), 40, 30).draw(ColorA(Palette::Green, 128)); }});
+        cases.push_back({"Rect::draw/additive", 40 * 30, [](uint32_t i) { Rect(20 + offsetX(i), 20 + offsetY(i), 40, 30).draw(ColorA(Palette::Green, 128), BlendMode::Additive); }});
+        cases.push_back({"Rect::draw/multiply", 40 * 30, [](uint32_t i) { Rect(20 + offsetX(i), 20 + offsetY(i), 40, 30).draw(ColorA(Palette::Green, 128), BlendMode::Multiply); }});
+        cases.push_back({"Circle::draw/alpha", pi * 20 * 20, [](uint32_t i) { Circle(60 + offsetX(i), 60 + offsetY(i), 20).draw(ColorA(Palette::Red, 128)); }});
+        cases.push_back({"Triangle::draw/alpha", 40 * 30 / 2, [](uint32_t i) {
+                             const int32_t x = 20 + offsetX(i), y = 20 + offsetY(i);
+                             Triangle(x, y + 30, x + 40, y + 30, x + 20, y).draw(ColorA(Palette::Blue, 128));
+                         }});
+
+        // グラデーション (細い矩形を並べる従来の方法と比べる)
+        cases.push_back({"Rect::draw/gradient", 40 * 30, [](uint32_t i) { Rect(20 + offsetX(i), 20 + offsetY(i), 40, 30).draw(Gradient::Horizontal(Palette::Green, Palette::Red)); }});
+        cases.push_back({"Rect::draw/gradient-strips", 40 * 30, [](uint32_t i) {
+                             for (int32_t x = 0; x < 40; ++x)
+                             {
+                                 Rect(20 + offsetX(i) + x, 20 + offsetY(i), 1, 30).draw(Palette::Green.lerp(Palette::Red, x / 39.0f));
+                             }
+                         }});
+        cases.push_back({"Circle::draw/radial", pi * 20 * 20, [](uint32_t i) { Circle(60 + offsetX(i), 60 + offsetY(i), 20).draw(Gradient::Radial(Palette::White, Palette::Blue)); }});
+        cases.push_back({"Triangle::draw/gradient", 40 * 30 / 2, [](uint32_t i) {
+                             const int32_t x = 20 + offsetX(i), y = 20 + offsetY(i);
+                             Triangle(x, y + 30, x + 40, y + 30, x + 20, y).draw(Gradient::Linear(Palette::Blue, Palette::Cyan, 60.0f));
+                         }});
+
+        // 色変換 (pixels は変換した色の数)
+        cases.push_back({"Color::toRGB565/loop", double(ColorBatch), [](uint32_t) {
+                             for (size_t j = 0; j < ColorBatch; ++j)
+                             {
+                                 g_packed[j] = g_colors[j].toRGB565();
+                             }
+                         }});
+        cases.push_back({"Color::ToRGB565/batch", double(ColorBatch), [](uint32_t) { Color::ToRGB565(g_colors.data(), g_packed.data(), ColorBatch); }});
+        cases.push_back({"Color::FromRGB565/batch", double(ColorBatch), [](uint32_t) { Color::FromRGB565(g_packed.data(), g_colors.data(), ColorBatch); }});
+
+        // 虹色 (pixels は求めた色の数)
+        cases.push_back({"Color::FromHSV", 1, [](uint32_t i) { g_packed[0] = Color::FromHSV(float(i % 360), 0.8f, 1.0f).toRGB565(); }});
+        cases.push_back({"Color::FromHSVFixed", 1, [](uint32_t i) { g_packed[0] = Color::FromHSVFixed(i, 204, 255).toRGB565(); }});
+        cases.push_back({"HueWheel", 1, [](uint32_t i) { g_packed[0] = HueWheel::Default()[int32_t(i)].value; }});
+
+        // Font::draw (文字列の大きさはキャンバスのフォント情報から求める)
+        static const char *const text = "M5Siv3D 12345";
+        auto &canvas = System::getInstance().getCanvas();
+        canvas.setFont(&fonts::Font0);
+        canvas.setTextSize(2);
+        const double textPixels = double(canvas.textWidth(text)) * canvas.fontHeight();
+
+        const Font::HorizontalAlign hAligns[] = {Font::HorizontalAlign::Left, Font::HorizontalAlign::Center, Font::HorizontalAlign::Right};
+        const Font::VerticalAlign vAligns[] = {Font::VerticalAlign::Top, Font::VerticalAlign::Center, Font::VerticalAlign::Bottom, Font::VerticalAlign::Baseline};
+        for (Font::HorizontalAlign h : hAligns)
+        {
+            for (Font::VerticalAlign v : vAligns)
+            {
+                cases.push_back({std::string("Font::draw/") + AlignName(h) + "-" + AlignName(v), textPixels, [h, v](uint32_t i) {
+                                     g_font.setSize(2).setHorizontalAlign(h).setVerticalAlign(v);
+                                     g_font.draw(text, 160 + offsetX(i) / 2, 120 + offsetY(i), Palette::White);
+                                 }});
+            }
+        }
+
+        // Image::draw
+        cases.push_back({"Image::draw", 32 * 32, [](uint32_t i) { g_image.draw(20 + offsetX(i), 20 + offsetY(i)); }});
+        cases.push_back({"Image::draw/x2", 64 * 64, [](uint32_t i) { g_image.draw(20 + offsetX(i), 20 + offsetY(i), 2.0f); }});
+        cases.push_back({"Image::draw/x0.5", 16 * 16, [](uint32_t i) { g_image.draw(20 + offsetX(i), 20 + offsetY(i), 0.5f); }});
+        cases.push_back({"Image::draw/x1.5x0.75", 48 * 24, [](uint32_t i) { g_image.draw(20 + offsetX(i), 20 + offsetY(i), 1.5f, 0.75f); }});
+        cases.push_back({"Image::draw/flash", 32 * 32, [](uint32_t i) { g_flashImage.draw(20 + offsetX(i), 20 + offsetY(i)); }});
+        cases.push_back({"Image::draw/flash-rle", 32 * 32, [](uint32_t i) { g_flashRLE.draw(20 + offsetX(i), 20 + offsetY(i)); }});
+        cases.push_back({"Image::drawRegion", 16 * 16, [](uint32_t i) { g_image.drawRegion(20 + offsetX(i), 20 + offsetY(i), 8, 8, 16, 16); }});
+        cases.push_back({"Image::drawRegion/flash", 16 * 16, [](uint32_t i) { g_flashImage.drawRegion(20 + offsetX(i), 20 + offsetY(i), 8, 8, 16, 16); }});
+        cases.push_back({"Image::draw/flash-x2", 64 * 64, [](uint32_t i) { g_flashImage.draw(20 + offsetX(i), 20 + offsetY(i), 2.0f); }});
+        cases.push_back({"Image::draw/x2-bilinear", 64 * 64, [](uint32_t i) { g_image.draw(20 + offsetX(i), 20 + offsetY(i), 2.0f, ImageFilter::Bilinear); }});
+        cases.push_back({"Image::draw/flash-x2-bilinear", 64 * 64, [](uint32_t i) { g_flashImage.draw(20 + offsetX(i), 20 + offsetY(i), 2.0f, ImageFilter::Bilinear); }});
+        cases.push_back({"Image::drawRotated", 32 * 32, [](uint32_t i) { g_image.drawRotated(20 + offsetX(i), 20 + offsetY(i), 0.3f + i * 0.01f); }});
+        cases.push_back({"Image::drawRotated/bilinear", 32 * 32, [](uint32_t i) {
+                             g_image.drawRotated(20 + offsetX(i), 20 + offsetY(i), 0.3f + i * 0.01f, ImageFilter::Bilinear);
+                         }});
+        cases.push_back({"Image::drawRotated/flash", 32 * 32, [](uint32_t i) { g_flashImage.drawRotated(20 + offsetX(i), 20 + offsetY(i), 0.3f + i * 0.01f); }});
+        cases.push_back({"Image::draw/x2-bilinear-cached", 64 * 64, [](uint32_t i) {
+                             ScaledImageCache::SetBudget(64 * 64 * 2);
+                             g_image.draw(20 + offsetX(i), 20 + offsetY(i), 2.0f, ImageFilter::Bilinear);
+                         }});
+
+        // SimpleGUI (タッチなしの状態。画素数はウィジェットの範囲)
+        const int32_t h = SimpleGUI::Style::DefaultHeight;
+        const int32_t w = SimpleGUI::Style::DefaultWidth;
+        cases.push_back({"SimpleGUI::Button", double(w) * h, [](uint32_t i) { SimpleGUI::Button("OK", Math::Vec2i(20 + offsetX(i), 20 + offsetY(i))); }});
+        cases.push_back({"SimpleGUI::Slider", double(w) * h, [](uint32_t i) {
+                             static double value = 0.5;
+                             SimpleGUI::Slider(value, Math::Vec2i(20 + offsetX(i), 20 + offsetY(i)), 0.0, 1.0);
+                         }});
+        cases.push_back({"SimpleGUI::CheckBox", double(w) * h, [](uint32_t i) {
+                             static bool checked = true;
+                             SimpleGUI::CheckBox(checked, "Check", Math::Vec2i(20 + offsetX(i), 20 + offsetY(i)));
+                         }});
+        cases.push_back({"SimpleGUI::RadioButtons", double(w) * h * 3, [](uint32_t i) {
+                             static size_t index = 1;
+                             static const std::vector<String> options = {"A", "B", "C"};
+                             SimpleGUI::RadioButtons(index, options, Math::Vec2i(20 + offsetX(i), 20 + offsetY(i)));
+                         }});
+
+        // 画面への転送
+        cases.push_back({"present/Full", double(System::Width()) * System::Height(), [](uint32_t) { System::Update(); }});
+        return cases;
+    }
+
+    BenchResult run(const BenchCase &benchCase)
+    {
+        // 前のケースの描画を転送して消し、拡大縮小した画像のキャッシュも捨てておく
+        System::Update();
+        ScaledImageCache::SetBudget(0);
+        for (uint32_t i = 0; i < WarmupCalls; ++i)
+        {
+            benchCase.draw(i);
+        }
+
+        // 計測時間に達するまで、呼び出し回数を倍にしながら繰り返す
+        BenchResult result = {benchCase.name, 0, 0, benchCase.pixelsPerCall};
+        uint32_t batch = 1;
+        while (result.micros < TargetMicros)
+        {
+            const uint32_t start = micros();
+            for (uint32_t i = 0; i < batch; ++i)
+            {
+                benchCase.draw(result.calls + i);
+            }
+            result.micros += micros() - start;
+            result.calls += batch;
+            batch = std::min<uint32_t>(batch * 2, 4096);
+        }
+        return result;
+    }
+
+    void report(const std::vector<BenchResult> &results)
+    {
+        Serial.printf("M5SIV3D_BENCH {\"suite\":\"render\",\"version\":1,\"platform\":\"%s\",\"width\":%d,\"height\":%d,\"results\":[",
+                      PlatformName(), System::Width(), System::Height());
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const BenchResult &r = results[i];
+            const double seconds = r.micros / 1000000.0;
+            Serial.printf("%s{\"name\":\"%s\",\"calls\":%u,\"micros\":%u,\"calls_per_sec\":%.1f,\"pixels_per_sec\":%.0f}",
+                          i ? "," : "", r.name.c_str(), unsigned(r.calls), unsigned(r.micros),
+                          r.calls / seconds, r.calls * r.pixelsPerCall / seconds);
+        }
+        Serial.printf("]}\n");
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_render_benchmark()
+{
+    System::SetPresentMode(PresentMode::Full);
+    System::SetTargetFPS(0.0f);
+    TEST_ASSERT_TRUE(g_image.create(32, 32, Palette::Orange));
+    for (uint32_t i = 0; i < 32 * 32; ++i)
+    {
+        g_flashPixels[i] = Color::SwapBytes(Color(uint8_t(i), uint8_t(i >> 2), 128).toRGB565());
+    }
+    for (uint32_t row = 0; row < 32; ++row)
+    {
+        g_flashRows[row] = row * 8;
+        for (uint32_t run = 0; run < 4; ++run)
+        {
+            g_flashRuns[row * 8 + run * 2] = 8;
+            g_flashRuns[row * 8 + run * 2 + 1] = Color::SwapBytes(Color(uint8_t(run * 60), uint8_t(row * 8), 200).toRGB565());
+        }
+    }
+    for (size_t i = 0; i < ColorBatch; ++i)
+    {
+        g_colors.push_back(Color(uint8_t(i), uint8_t(i * 3), uint8_t(i * 7)));
+    }
+    g_packed.resize(ColorBatch);
+
+    std::vector<BenchResult> results;
+    for (const BenchCase &benchCase : makeCases())
+    {
+        results.push_back(run(benchCase));
+        TEST_ASSERT_TRUE(results.back().calls > 0);
+    }
+    report(results);
+}
+
+void runBenchmarks()
+{
+    System::Init();
+    UNITY_BEGIN();
+    RUN_TEST(test_render_benchmark);
+    UNITY_END();
+}
+
+#if defined(M5SIV3D_HOST)
+
+int main()
+{
+    runBenchmarks();
+    return 0;
+}
+
+#else
+
+void setup()
+{
+    // シリアルモニタの接続を待つ
+    delay(2000);
+    runBenchmarks();
+}
+
+void loop() {}
+
+#endif
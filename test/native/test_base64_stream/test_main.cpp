@@ -0,0 +1,128 @@
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "M5Siv3D.h"
+
+// base64 のストリームデコード (Base64Stream / Image::loadBase64)
+namespace
+{
+    std::string Encode(const std::vector<uint8_t> &data)
+    {
+        static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string text;
+        for (size_t i = 0; i < data.size(); i += 3)
+        {
+            const uint32_t n = (uint32_t(data[i]) << 16) | ((i + 1 < data.size()) ? uint32_t(data[i + 1]) << 8 : 0) |
+                               ((i + 2 < data.size()) ? uint32_t(data[i + 2]) : 0);
+            text += table[(n >> 18) & 63];
+            text += table[(n >> 12) & 63];
+            text += (i + 1 < data.size()) ? table[(n >> 6) & 63] : '=';
+            text += (i + 2 < data.size()) ? table[n & 63] : '=';
+        }
+        return text;
+    }
+
+    std::vector<uint8_t> Pattern(size_t size)
+    {
+        std::vector<uint8_t> data(size);
+        uint32_t state = 12345;
+        for (uint8_t &value : data)
+        {
+            state = state * 1103515245u + 12345u;
+            value = uint8_t(state >> 16);
+        }
+        return data;
+    }
+
+    // 8x4 の PNG の先頭 (シグネチャと IHDR)
+    std::vector<uint8_t> PngHeader()
+    {
+        const uint8_t header[] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A, 0, 0, 0, 13, 'I', 'H', 'D', 'R',
+                                  0, 0, 0, 8, 0, 0, 0, 4, 8, 2, 0, 0, 0};
+        return std::vector<uint8_t>(header, header + sizeof(header));
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_stream_matches_full_decode()
+{
+    // 窓の境界の前後と、'=' の付く長さを含める
+    const size_t sizes[] = {0, 1, 2, 3, 191, 192, 193, 500, 1000};
+    for (size_t size : sizes)
+    {
+        const std::vector<uint8_t> data = Pattern(size);
+        const std::string text = Encode(data);
+        Base64Stream stream(text.c_str());
+        TEST_ASSERT_EQUAL_UINT32(size, stream.size());
+
+        // 窓の大きさと揃わない量ずつ読む
+        std::vector<uint8_t> decoded;
+        uint8_t chunk[37];
+        int count;
+        while ((count = stream.read(chunk, sizeof(chunk))) > 0)
+        {
+            decoded.insert(decoded.end(), chunk, chunk + count);
+        }
+        TEST_ASSERT_TRUE(decoded == data);
+        TEST_ASSERT_EQUAL_INT32(int32_t(size), stream.tell());
+    }
+}
+
+void test_seek_and_skip()
+{
+    const std::vector<uint8_t> data = Pattern(1000);
+    const std::string text = Encode(data);
+    Base64Stream stream(text.c_str());
+
+    uint8_t value = 0;
+    const uint32_t positions[] = {700, 5, 191, 192, 999, 0, 384};
+    for (uint32_t position : positions)
+    {
+        TEST_ASSERT_TRUE(stream.seek(position));
+        TEST_ASSERT_EQUAL_INT(1, stream.read(&value, 1));
+        TEST_ASSERT_EQUAL_UINT8(data[position], value);
+    }
+
+    stream.seek(100);
+    stream.skip(250);
+    TEST_ASSERT_EQUAL_INT32(350, stream.tell());
+    stream.read(&value, 1);
+    TEST_ASSERT_EQUAL_UINT8(data[350], value);
+    stream.skip(-300);
+    stream.read(&value, 1);
+    TEST_ASSERT_EQUAL_UINT8(data[51], value);
+
+    // 末尾より後ろには進まない
+    TEST_ASSERT_FALSE(stream.seek(1001));
+    TEST_ASSERT_EQUAL_INT32(1000, stream.tell());
+    TEST_ASSERT_EQUAL_INT(0, stream.read(&value, 1));
+}
+
+void test_load_base64_reads_header_from_stream()
+{
+    Image image;
+    const std::string png = Encode(PngHeader());
+    // ホストには PNG デコーダがないので、描画は失敗するがヘッダーのサイズは読める
+    image.loadBase64(png.c_str());
+    TEST_ASSERT_EQUAL_INT32(8, image.width());
+    TEST_ASSERT_EQUAL_INT32(4, image.height());
+
+    Image invalid;
+    TEST_ASSERT_FALSE(invalid.loadBase64(Encode(Pattern(64)).c_str()));
+    TEST_ASSERT_FALSE(invalid.loadBase64("iVBO"));
+    TEST_ASSERT_FALSE(invalid.loadBase64(""));
+    TEST_ASSERT_TRUE(invalid.isEmpty());
+}
+
+int main()
+{
+    System::Init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_stream_matches_full_decode);
+    RUN_TEST(test_seek_and_skip);
+    RUN_TEST(test_load_base64_reads_header_from_stream);
+    return UNITY_END();
+}
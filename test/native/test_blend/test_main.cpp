@@ -0,0 +1,215 @@
+#include <unity.h>
+#include <cstdlib>
+#include <vector>
+#include "M5Siv3D.h"
+#include "M5Siv3D/Host/TestSupport.h"
+
+// 不透明度付きの色と合成方法 (Alpha / Additive / Multiply)
+namespace
+{
+    struct Channels
+    {
+        int32_t r, g, b; // RGB565 の各成分 (5 / 6 / 5 ビット)
+    };
+
+    Channels Split(uint16_t c)
+    {
+        return {c >> 11, (c >> 5) & 0x3F, c & 0x1F};
+    }
+
+    // 成分ごとの差が 1 以下
+    void AssertNear(uint16_t expected, uint16_t actual)
+    {
+        const Channels e = Split(expected);
+        const Channels a = Split(actual);
+        char message[64];
+        snprintf(message, sizeof(message), "expected %04X, actual %04X", expected, actual);
+        TEST_ASSERT_TRUE_MESSAGE(std::abs(e.r - a.r) <= 1 && std::abs(e.g - a.g) <= 1 && std::abs(e.b - a.b) <= 1, message);
+    }
+
+    // 浮動小数点で計算した期待値
+    uint16_t Reference(uint16_t dst, uint16_t src, uint8_t alpha, BlendMode mode)
+    {
+        const Channels d = Split(dst);
+        const Channels s = Split(src);
+        const int32_t dv[3] = {d.r, d.g, d.b};
+        const int32_t sv[3] = {s.r, s.g, s.b};
+        const int32_t maxValue[3] = {31, 63, 31};
+        const double a = alpha / 255.0;
+        int32_t out[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            double value;
+            if (mode == BlendMode::Alpha)
+            {
+                value = sv[i] * a + dv[i] * (1.0 - a);
+            }
+            else if (mode == BlendMode::Additive)
+            {
+                value = std::min<double>(maxValue[i], dv[i] + sv[i] * a);
+            }
+            else
+            {
+                const double product = double(dv[i]) * sv[i] / maxValue[i];
+                value = product * a + dv[i] * (1.0 - a);
+            }
+            out[i] = int32_t(value + 0.5);
+        }
+        return uint16_t((out[0] << 11) | (out[1] << 5) | out[2]);
+    }
+
+    uint16_t ScreenPixel(int32_t x, int32_t y)
+    {
+        M5.Display.waitDMA();
+        return uint16_t(M5.Display.readPixel(x, y));
+    }
+
+    void SceneAllPrimitives()
+    {
+        Rect(10, 10, 200, 120).draw(Palette::Blue);
+        Rect(40, 30, 200, 120).draw(ColorA(Palette::Red, 100));
+        Circle(160, 120, 60).draw(ColorA(Palette::Green, 180), BlendMode::Additive);
+        Triangle(20, 230, 300, 200, 150, 60).draw(ColorA(200, 100, 50, 200), BlendMode::Multiply);
+        Font font(fonts::Font0);
+        font.setSize(2);
+        font.draw("Blend", 100, 100, ColorA(Palette::White, 160));
+    }
+}
+
+void setUp()
+{
+    System::SetPresentMode(PresentMode::Full);
+    System::SetBackgroundColor(Palette::Black);
+}
+
+void tearDown()
+{
+    System::SetPresentMode(PresentMode::Full);
+    System::SetBackgroundColor(Palette::Black);
+}
+
+void test_kernels_match_reference_within_one_step()
+{
+    const uint16_t samples[] = {0x0000, 0xFFFF, 0xF800, 0x07E0, 0x001F, 0x8410, 0x1234, 0xBEEF, 0x7BEF, 0x4A69};
+    const uint8_t alphas[] = {1, 8, 64, 127, 128, 200, 254, 255};
+    const BlendMode modes[] = {BlendMode::Alpha, BlendMode::Additive, BlendMode::Multiply};
+    for (BlendMode mode : modes)
+    {
+        for (uint8_t alpha : alphas)
+        {
+            for (uint16_t src : samples)
+            {
+                // 端数の処理を確かめるため、奇数個の画素を並べる
+                lgfx::swap565_t pixels[11];
+                const size_t count = sizeof(pixels) / sizeof(pixels[0]);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    pixels[i].raw = Blend::Swap(samples[i % 10]);
+                }
+                Blend::Blender(src, alpha, mode).apply(pixels, int32_t(count));
+                for (size_t i = 0; i < count; ++i)
+                {
+                    AssertNear(Reference(samples[i % 10], src, alpha, mode), Blend::Swap(pixels[i].raw));
+                }
+            }
+        }
+    }
+}
+
+void test_alpha_rect_blends_with_background()
+{
+    System::SetBackgroundColor(Palette::Blue);
+    System::Update();
+    Rect(20, 20, 50, 30).draw(ColorA(Palette::Red, 128));
+    System::Update();
+
+    AssertNear(Reference(Palette::Blue.toRGB565(), Palette::Red.toRGB565(), 128, BlendMode::Alpha), ScreenPixel(20, 20));
+    AssertNear(Reference(Palette::Blue.toRGB565(), Palette::Red.toRGB565(), 128, BlendMode::Alpha), ScreenPixel(69, 49));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Blue.toRGB565(), ScreenPixel(70, 20));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Blue.toRGB565(), ScreenPixel(20, 50));
+}
+
+void test_additive_saturates_and_multiply_darkens()
+{
+    System::SetBackgroundColor(Color(200, 200, 200));
+    System::Update();
+    Rect(0, 0, 40, 40).draw(ColorA(100, 100, 100), BlendMode::Additive);
+    Rect(40, 0, 40, 40).draw(ColorA(128, 255, 0), BlendMode::Multiply);
+    System::Update();
+
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, ScreenPixel(10, 10));
+    AssertNear(Reference(Color(200, 200, 200).toRGB565(), Color(128, 255, 0).toRGB565(), 255, BlendMode::Multiply),
+               ScreenPixel(50, 10));
+}
+
+void test_shapes_blend_each_pixel_once()
+{
+    // 同じ画素を 2 回合成すると色が変わるので、図形の内側がすべて同じ色になることを確かめる
+    System::Update();
+    Circle(80, 120, 50).draw(ColorA(Palette::White, 100));
+    Triangle(150, 200, 310, 180, 200, 20).draw(ColorA(Palette::White, 100));
+    System::Update();
+
+    const uint16_t expected = Reference(0, Palette::White.toRGB565(), 100, BlendMode::Alpha);
+    uint32_t covered = 0;
+    for (int32_t y = 0; y < M5.Display.height(); ++y)
+    {
+        for (int32_t x = 0; x < M5.Display.width(); ++x)
+        {
+            const uint16_t pixel = ScreenPixel(x, y);
+            if (pixel != 0)
+            {
+                AssertNear(expected, pixel);
+                TEST_ASSERT_EQUAL_UINT16(ScreenPixel(80, 120), pixel);
+                ++covered;
+            }
+        }
+    }
+    TEST_ASSERT_TRUE(covered > 0);
+}
+
+void test_text_is_blended_with_coverage()
+{
+    System::SetBackgroundColor(Palette::Blue);
+    System::Update();
+    Font font(fonts::Font0);
+    font.setVerticalAlign(Font::VerticalAlign::Top);
+    font.draw("Hello", 10, 10, ColorA(Palette::White, 128));
+    System::Update();
+
+    const uint16_t blue = Palette::Blue.toRGB565();
+    const uint16_t blended = Reference(blue, Palette::White.toRGB565(), 128, BlendMode::Alpha);
+    uint32_t textPixels = 0;
+    for (int32_t y = 0; y < 40; ++y)
+    {
+        for (int32_t x = 0; x < 80; ++x)
+        {
+            const uint16_t pixel = ScreenPixel(x, y);
+            if (pixel != blue)
+            {
+                AssertNear(blended, pixel);
+                ++textPixels;
+            }
+        }
+    }
+    TEST_ASSERT_TRUE(textPixels > 20);
+}
+
+void test_banded_matches_full()
+{
+    Host::CheckBandedMatchesFull(SceneAllPrimitives);
+}
+
+int main()
+{
+    System::Init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_kernels_match_reference_within_one_step);
+    RUN_TEST(test_alpha_rect_blends_with_background);
+    RUN_TEST(test_additive_saturates_and_multiply_darkens);
+    RUN_TEST(test_shapes_blend_each_pixel_once);
+    RUN_TEST(test_text_is_blended_with_coverage);
+    RUN_TEST(test_banded_matches_full);
+    return UNITY_END();
+}
@@ -0,0 +1,224 @@
+#include <unity.h>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "M5Siv3D.h"
+
+// Color と RGB565 の変換 (1 色ずつ・配列でまとめて・Color565)
+namespace
+{
+    // 表を使う前の計算方法
+    Color expandReference(uint16_t rgb565)
+    {
+        uint8_t r = (rgb565 >> 8) & 0xF8;
+        uint8_t g = (rgb565 >> 3) & 0xFC;
+        uint8_t b = (rgb565 << 3) & 0xF8;
+        return Color(uint8_t(r | (r >> 5)), uint8_t(g | (g >> 6)), uint8_t(b | (b >> 5)));
+    }
+
+    // 固定小数点にする前の計算方法 (h は 0-360)
+    Color fromHSVReference(float h, float s, float v)
+    {
+        const float c = v * s;
+        const float x = c * (1 - std::fabs(std::fmod(h / 60.0f, 2.0f) - 1));
+        const float m = v - c;
+        float r, g, b;
+        if (h < 60) { r = c; g = x; b = 0; }
+        else if (h < 120) { r = x; g = c; b = 0; }
+        else if (h < 180) { r = 0; g = c; b = x; }
+        else if (h < 240) { r = 0; g = x; b = c; }
+        else if (h < 300) { r = x; g = 0; b = c; }
+        else { r = c; g = 0; b = x; }
+        return Color(uint8_t((r + m) * 255), uint8_t((g + m) * 255), uint8_t((b + m) * 255));
+    }
+
+    void assertNear(const Color &expected, const Color &actual, int tolerance)
+    {
+        char message[64];
+        snprintf(message, sizeof(message), "expected (%d,%d,%d), actual (%d,%d,%d)",
+                 expected.r, expected.g, expected.b, actual.r, actual.g, actual.b);
+        TEST_ASSERT_TRUE_MESSAGE(std::abs(expected.r - actual.r) <= tolerance &&
+                                     std::abs(expected.g - actual.g) <= tolerance &&
+                                     std::abs(expected.b - actual.b) <= tolerance,
+                                 message);
+    }
+
+    std::vector<Color> makeColors(size_t count)
+    {
+        std::vector<Color> colors;
+        for (size_t i = 0; i < count; ++i)
+        {
+            colors.push_back(Color(uint8_t(i * 37), uint8_t(i * 91 + 5), uint8_t(255 - i * 13)));
+        }
+        return colors;
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_rgb565_round_trips_for_every_value()
+{
+    for (uint32_t value = 0; value <= 0xFFFF; ++value)
+    {
+        const Color color{uint16_t(value)};
+        const Color reference = expandReference(uint16_t(value));
+        TEST_ASSERT_EQUAL_UINT8(reference.r, color.r);
+        TEST_ASSERT_EQUAL_UINT8(reference.g, color.g);
+        TEST_ASSERT_EQUAL_UINT8(reference.b, color.b);
+        TEST_ASSERT_EQUAL_UINT16(value, color.toRGB565());
+    }
+}
+
+void test_batch_conversion_matches_single_conversion()
+{
+    // 端数の処理を確かめるため、4 の倍数でない長さも試す
+    for (size_t count = 0; count < 11; ++count)
+    {
+        const std::vector<Color> colors = makeColors(count);
+        std::vector<uint16_t> packed(count + 1, 0xBEEF);
+        std::vector<uint16_t> swapped(count + 1, 0xBEEF);
+        Color::ToRGB565(colors.data(), packed.data(), count);
+        Color::ToRGB565Swapped(colors.data(), swapped.data(), count);
+
+        std::vector<Color> decoded(count + 1, Color(1, 2, 3));
+        Color::FromRGB565(packed.data(), decoded.data(), count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            TEST_ASSERT_EQUAL_UINT16(colors[i].toRGB565(), packed[i]);
+            TEST_ASSERT_EQUAL_UINT16(Color::SwapBytes(colors[i].toRGB565()), swapped[i]);
+            TEST_ASSERT_EQUAL_UINT16(packed[i], decoded[i].toRGB565());
+        }
+
+        // 範囲外には書き込まない
+        TEST_ASSERT_EQUAL_UINT16(0xBEEF, packed[count]);
+        TEST_ASSERT_EQUAL_UINT16(0xBEEF, swapped[count]);
+        TEST_ASSERT_EQUAL_UINT8(1, decoded[count].r);
+    }
+}
+
+void test_color565_draws_like_color()
+{
+    System::SetPresentMode(PresentMode::Full);
+    System::SetBackgroundColor(Palette::Black);
+
+    const Color565 orange = Palette::Orange;
+    TEST_ASSERT_EQUAL_UINT16(Palette::Orange.toRGB565(), orange.toRGB565());
+    TEST_ASSERT_TRUE(orange.toColor().toRGB565() == orange.value);
+
+    Rect(10, 10, 20, 20).draw(Palette::Orange);
+    Rect(40, 10, 20, 20).draw(orange);
+    Circle(100, 20, 8).draw(Color565(0x07E0));
+    System::Update();
+    M5.Display.waitDMA();
+
+    TEST_ASSERT_EQUAL_UINT16(M5.Display.readPixel(15, 15), M5.Display.readPixel(45, 15));
+    TEST_ASSERT_EQUAL_UINT16(orange.value, M5.Display.readPixel(45, 15));
+    TEST_ASSERT_EQUAL_UINT16(0x07E0, M5.Display.readPixel(100, 20));
+}
+
+void test_palette_is_constant()
+{
+    // コンパイル時に RGB565 まで求まる
+    static_assert(Palette::Red.toRGB565() == 0xF800, "Palette::Red");
+    static_assert(Palette::White.toRGB565() == 0xFFFF, "Palette::White");
+    static_assert(Color565(Palette::Orange).value == Color(255, 165, 0).toRGB565(), "Palette::Orange");
+    constexpr Color565 spark = Palette::Orange;
+    constexpr ColorA shadow(Palette::Black, 128);
+    static_assert(shadow.rgb().toRGB565() == 0 && shadow.a == 128, "ColorA");
+
+    TEST_ASSERT_EQUAL_UINT16(Color(255, 165, 0).toRGB565(), spark.value);
+    TEST_ASSERT_EQUAL_UINT8(165, Palette::Orange.g);
+}
+
+void test_hsv_matches_float_reference()
+{
+    for (int32_t tenths = 0; tenths < 3600; ++tenths)
+    {
+        const float h = tenths / 10.0f;
+        for (float s = 0.0f; s <= 1.0f; s += 0.25f)
+        {
+            for (float v = 0.0f; v <= 1.0f; v += 0.2f)
+            {
+                assertNear(fromHSVReference(h, s, v), Color::FromHSV(h, s, v), 1);
+            }
+        }
+    }
+
+    // 範囲外の色相は折り返す
+    assertNear(Color::FromHSV(30.0f, 1.0f, 1.0f), Color::FromHSV(390.0f, 1.0f, 1.0f), 1);
+    assertNear(Color::FromHSV(330.0f, 1.0f, 1.0f), Color::FromHSV(-30.0f, 1.0f, 1.0f), 1);
+}
+
+void test_hsv_primaries_are_exact()
+{
+    // 彩度と明度が最大の色は、パレットの色とちょうど一致する
+    const Color expected[] = {Palette::Red, Palette::Yellow, Palette::Lime, Palette::Cyan, Palette::Blue, Palette::Magenta};
+    for (int32_t i = 0; i < 6; ++i)
+    {
+        const Color color = Color::FromHSV(i * 60.0f, 1.0f, 1.0f);
+        TEST_ASSERT_EQUAL_UINT8(expected[i].r, color.r);
+        TEST_ASSERT_EQUAL_UINT8(expected[i].g, color.g);
+        TEST_ASSERT_EQUAL_UINT8(expected[i].b, color.b);
+        const Color fixed = Color::FromHSVFixed(uint32_t(i) * Color::HueSteps / 6, 255, 255);
+        TEST_ASSERT_EQUAL_UINT8(expected[i].r, fixed.r);
+        TEST_ASSERT_EQUAL_UINT8(expected[i].g, fixed.g);
+        TEST_ASSERT_EQUAL_UINT8(expected[i].b, fixed.b);
+    }
+    const Color white = Color::FromHSV(0.0f, 0.0f, 1.0f);
+    TEST_ASSERT_EQUAL_UINT8(255, white.r);
+    TEST_ASSERT_EQUAL_UINT8(255, white.g);
+    TEST_ASSERT_EQUAL_UINT8(255, white.b);
+}
+
+void test_fixed_hsv_round_trips()
+{
+    const std::vector<Color> colors = makeColors(200);
+    for (const Color &color : colors)
+    {
+        float h, s, v;
+        color.toHSV(h, s, v);
+        assertNear(color, Color::FromHSV(h, s, v), 1);
+
+        uint16_t hue;
+        uint8_t saturation, value;
+        color.toHSVFixed(hue, saturation, value);
+        TEST_ASSERT_TRUE(hue < Color::HueSteps);
+        TEST_ASSERT_FLOAT_WITHIN(0.5f, h, hue * 360.0f / Color::HueSteps);
+        TEST_ASSERT_FLOAT_WITHIN(0.5f, s * 255.0f, saturation);
+        TEST_ASSERT_EQUAL_UINT8(std::max({color.r, color.g, color.b}), value);
+        assertNear(color, Color::FromHSVFixed(hue, saturation, value), 2);
+    }
+}
+
+void test_hue_wheel_matches_hsv()
+{
+    const HueWheel &wheel = HueWheel::Default();
+    const HueWheel pastel(128, 200);
+    for (int32_t degree = 0; degree < HueWheel::Size; ++degree)
+    {
+        assertNear(Color::FromHSV(float(degree), 1.0f, 1.0f), wheel[degree].toColor(), 8);
+        TEST_ASSERT_EQUAL_UINT16(Color::FromHSVFixed(uint32_t(degree) * Color::HueSteps / 360, 128, 200).toRGB565(),
+                                 pastel[degree].value);
+    }
+    TEST_ASSERT_EQUAL_UINT16(wheel[10].value, wheel[370].value);
+    TEST_ASSERT_EQUAL_UINT16(wheel[350].value, wheel[-10].value);
+    TEST_ASSERT_EQUAL_UINT16(wheel[10].value, wheel.at(10.7f).value);
+}
+
+int main()
+{
+    System::Init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_rgb565_round_trips_for_every_value);
+    RUN_TEST(test_batch_conversion_matches_single_conversion);
+    RUN_TEST(test_color565_draws_like_color);
+    RUN_TEST(test_palette_is_constant);
+    RUN_TEST(test_hsv_matches_float_reference);
+    RUN_TEST(test_hsv_primaries_are_exact);
+    RUN_TEST(test_fixed_hsv_round_trips);
+    RUN_TEST(test_hue_wheel_matches_hsv);
+    return UNITY_END();
+}
@@ -0,0 +1,98 @@
+#include <unity.h>
+#include <vector>
+#include "M5Siv3D.h"
+
+// PresentMode::FrameDiff (変化したタイルだけの転送)
+// 幅が DiffTileSize の倍数でない画面 (M5StickC の 135x240) で確かめる
+namespace
+{
+    uint16_t screenPixel(int32_t x, int32_t y)
+    {
+        M5.Display.waitDMA();
+        return M5.Display.readPixel(x, y);
+    }
+
+    std::vector<uint16_t> captureScreen()
+    {
+        M5.Display.waitDMA();
+        std::vector<uint16_t> pixels;
+        for (int32_t y = 0; y < M5.Display.height(); ++y)
+        {
+            for (int32_t x = 0; x < M5.Display.width(); ++x)
+            {
+                pixels.push_back(uint16_t(M5.Display.readPixel(x, y)));
+            }
+        }
+        return pixels;
+    }
+}
+
+void setUp()
+{
+    System::SetPresentMode(PresentMode::FrameDiff);
+    System::SetBackgroundColor(Palette::Black);
+
+    // 切り替え直後は全面を転送するので、前のテストの描画と一緒に消しておく
+    System::Update();
+    System::Update();
+}
+
+void tearDown()
+{
+    System::SetPresentMode(PresentMode::Full);
+}
+
+void test_right_edge_tile_is_pushed()
+{
+    Rect(130, 10, 4, 4).draw(Palette::Red);
+    System::Update();
+
+    TEST_ASSERT_EQUAL_UINT32(1, System::PushedTiles());
+    TEST_ASSERT_EQUAL_UINT16(Palette::Red.toRGB565(), screenPixel(131, 11));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Red.toRGB565(), screenPixel(133, 13));
+
+    // 消えたときも転送する
+    System::Update();
+    TEST_ASSERT_EQUAL_UINT32(1, System::PushedTiles());
+    TEST_ASSERT_EQUAL_UINT16(Palette::Black.toRGB565(), screenPixel(131, 11));
+}
+
+void test_run_reaching_right_edge_is_pushed()
+{
+    // 行の途中から右端まで続く変化タイル
+    Rect(40, 100, 95, 20).draw(Palette::Green);
+    System::Update();
+
+    TEST_ASSERT_EQUAL_UINT16(Palette::Green.toRGB565(), screenPixel(40, 100));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Green.toRGB565(), screenPixel(134, 119));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Black.toRGB565(), screenPixel(39, 100));
+}
+
+void test_frame_diff_matches_full()
+{
+    Rect(0, 0, 135, 3).draw(Palette::Blue);
+    Circle(120, 200, 30).draw(Palette::Yellow);
+    Rect(100, 50, 40, 40).draw(Palette::White);
+    System::Update();
+    const std::vector<uint16_t> diff = captureScreen();
+
+    System::SetPresentMode(PresentMode::Full);
+    Rect(0, 0, 135, 3).draw(Palette::Blue);
+    Circle(120, 200, 30).draw(Palette::Yellow);
+    Rect(100, 50, 40, 40).draw(Palette::White);
+    System::Update();
+
+    TEST_ASSERT_TRUE(diff == captureScreen());
+}
+
+int main()
+{
+    M5.Display.setSize(135, 240);
+    System::Init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_right_edge_tile_is_pushed);
+    RUN_TEST(test_run_reaching_right_edge_is_pushed);
+    RUN_TEST(test_frame_diff_matches_full);
+    return UNITY_END();
+}
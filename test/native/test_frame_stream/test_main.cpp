@@ -0,0 +1,294 @@
+#include <unity.h>
+#include <vector>
+#include "M5Siv3D.h"
+
+// スクリーンショットとフレームのストリーミング (FrameStreamEncoder)
+// 書き出したパケットを復号し、画面に表示された内容と一致することを確かめる
+namespace
+{
+    Host::Clock &virtualClock()
+    {
+        return Host::Clock::getInstance();
+    }
+
+    void finishFrame()
+    {
+        virtualClock().advanceMicros(1000);
+        System::Update();
+    }
+
+    // tools/frame_stream_decode.py と同じ手順の復号
+    class FrameDecoder
+    {
+    public:
+        int32_t width = 0;
+        int32_t height = 0;
+        std::vector<uint16_t> pixels;
+        uint8_t lastType = 0;
+        uint32_t lastTiles = 0;
+
+        // data の pos から 1 パケットを復号する
+        bool decode(const std::vector<uint8_t> &data, size_t &pos)
+        {
+            m_data = &data;
+            m_pos = pos;
+            const size_t start = pos;
+            if (!has(16) || memcmp(&data[pos], "M5FS", 4) != 0 || data[pos + 4] != FrameStreamEncoder::FormatVersion)
+            {
+                return false;
+            }
+            lastType = data[pos + 5];
+            const int32_t w = u16at(pos + 6);
+            const int32_t h = u16at(pos + 8);
+            const int32_t tileSize = data[pos + 10];
+            m_pos += 16;
+
+            if (lastType == 0)
+            {
+                width = w;
+                height = h;
+                pixels.assign(size_t(w) * h, 0);
+                if (!decodePixels(pixels.data(), size_t(w) * h))
+                {
+                    return false;
+                }
+                lastTiles = 0;
+            }
+            else
+            {
+                if (w != width || h != height)
+                {
+                    return false;
+                }
+                const int32_t tilesX = (w + tileSize - 1) / tileSize;
+                std::vector<uint16_t> tile(size_t(tileSize) * tileSize);
+                lastTiles = 0;
+                for (;;)
+                {
+                    if (!has(2))
+                    {
+                        return false;
+                    }
+                    const uint16_t index = u16at(m_pos);
+                    m_pos += 2;
+                    if (index == FrameStreamEncoder::EndOfTiles)
+                    {
+                        break;
+                    }
+                    const int32_t x = (index % tilesX) * tileSize;
+                    const int32_t y = (index / tilesX) * tileSize;
+                    const int32_t tw = std::min(tileSize, w - x);
+                    const int32_t th = std::min(tileSize, h - y);
+                    if (!decodePixels(tile.data(), size_t(tw) * th))
+                    {
+                        return false;
+                    }
+                    for (int32_t row = 0; row < th; ++row)
+                    {
+                        memcpy(&pixels[size_t(y + row) * w + x], &tile[size_t(row) * tw], tw * sizeof(uint16_t));
+                    }
+                    ++lastTiles;
+                }
+            }
+
+            if (!has(2))
+            {
+                return false;
+            }
+            uint32_t sum1 = 0, sum2 = 0;
+            for (size_t i = start; i < m_pos; ++i)
+            {
+                sum1 = (sum1 + data[i]) % 255;
+                sum2 = (sum2 + sum1) % 255;
+            }
+            const bool valid = u16at(m_pos) == uint16_t((sum2 << 8) | sum1);
+            pos = m_pos + 2;
+            return valid;
+        }
+
+    private:
+        const std::vector<uint8_t> *m_data = nullptr;
+        size_t m_pos = 0;
+
+        bool has(size_t bytes) const { return m_pos + bytes <= m_data->size(); }
+        uint16_t u16at(size_t pos) const { return uint16_t((*m_data)[pos] | ((*m_data)[pos + 1] << 8)); }
+
+        bool decodePixels(uint16_t *out, size_t count)
+        {
+            size_t index = 0;
+            while (index < count)
+            {
+                if (!has(1))
+                {
+                    return false;
+                }
+                const uint8_t head = (*m_data)[m_pos++];
+                const size_t length = (head & 0x80) ? (head & 0x7F) + 2 : head + 1;
+                if (index + length > count || !has((head & 0x80) ? 2 : length * 2))
+                {
+                    return false;
+                }
+                for (size_t i = 0; i < length; ++i)
+                {
+                    out[index + i] = u16at(m_pos + ((head & 0x80) ? 0 : i * 2));
+                }
+                m_pos += (head & 0x80) ? 2 : length * 2;
+                index += length;
+            }
+            return true;
+        }
+    };
+
+    void drawScene(int32_t offset = 0)
+    {
+        Rect(10 + offset, 20, 60, 40).draw(Palette::Red);
+        Circle(200, 120, 30).draw(Palette::Blue);
+        Triangle(100, 200, 160, 200, 130, 150).draw(Palette::Yellow);
+        Line(0, 239, 319, 0).draw(Palette::White);
+    }
+
+    // 復号した画像が画面と一致する画素数
+    uint32_t countMismatches(const FrameDecoder &decoder)
+    {
+        M5.Display.waitDMA();
+        uint32_t mismatches = 0;
+        for (int32_t y = 0; y < decoder.height; ++y)
+        {
+            for (int32_t x = 0; x < decoder.width; ++x)
+            {
+                mismatches += decoder.pixels[size_t(y) * decoder.width + x] != M5.Display.readPixel(x, y);
+            }
+        }
+        return mismatches;
+    }
+}
+
+void setUp()
+{
+    virtualClock().setVirtual(true);
+    M5.Display.setDmaNanosPerPixel(0);
+    System::SetPresentMode(PresentMode::Full);
+    System::SetTargetFPS(60.0f);
+    System::SetBackgroundColor(Palette::Black);
+    finishFrame();
+    finishFrame();
+}
+
+void tearDown()
+{
+    System::StopFrameStreaming();
+}
+
+void test_screenshot_matches_screen()
+{
+    drawScene();
+    Host::MemoryStream stream;
+    TEST_ASSERT_TRUE(System::Screenshot(stream));
+    finishFrame();
+
+    FrameDecoder decoder;
+    size_t pos = 0;
+    TEST_ASSERT_TRUE(decoder.decode(stream.data(), pos));
+    TEST_ASSERT_EQUAL_UINT32(stream.data().size(), pos);
+    TEST_ASSERT_EQUAL_INT32(System::Width(), decoder.width);
+    TEST_ASSERT_EQUAL_INT32(System::Height(), decoder.height);
+    TEST_ASSERT_EQUAL_UINT32(0, countMismatches(decoder));
+
+    // 単純な画面なら生の RGB565 (150KB) の 1/10 未満になる
+    const size_t raw = size_t(System::Width()) * System::Height() * 2;
+    TEST_ASSERT_TRUE(stream.data().size() * 10 < raw);
+}
+
+void test_banded_screenshot_matches_full()
+{
+    drawScene();
+    Host::MemoryStream full;
+    TEST_ASSERT_TRUE(System::Screenshot(full));
+    finishFrame();
+
+    System::SetPresentMode(PresentMode::Banded);
+    finishFrame();
+    drawScene();
+    Host::MemoryStream banded;
+    TEST_ASSERT_TRUE(System::Screenshot(banded));
+    finishFrame();
+
+    FrameDecoder a, b;
+    size_t pa = 0, pb = 0;
+    TEST_ASSERT_TRUE(a.decode(full.data(), pa));
+    TEST_ASSERT_TRUE(b.decode(banded.data(), pb));
+    TEST_ASSERT_TRUE(a.pixels == b.pixels);
+}
+
+void test_streaming_sends_changed_tiles()
+{
+    Host::MemoryStream stream;
+    System::StartFrameStreaming(stream, 1, 0);
+
+    FrameDecoder decoder;
+    size_t pos = 0;
+
+    // 最初はキーフレーム
+    drawScene();
+    finishFrame();
+    TEST_ASSERT_TRUE(decoder.decode(stream.data(), pos));
+    TEST_ASSERT_EQUAL_UINT8(0, decoder.lastType);
+    TEST_ASSERT_EQUAL_UINT32(0, countMismatches(decoder));
+
+    // 変化がなければ何も送らない
+    drawScene();
+    finishFrame();
+    TEST_ASSERT_EQUAL_UINT32(0, System::StreamedBytes());
+    TEST_ASSERT_EQUAL_UINT32(pos, stream.data().size());
+
+    // 変化したタイルだけを送る (矩形が x: 10..69 → 26..85 に動くと、両端の 10..25 と 70..85 を含む 4 列 × y: 20..59 の 3 行)
+    drawScene(16);
+    finishFrame();
+    TEST_ASSERT_TRUE(System::StreamedBytes() > 0);
+    TEST_ASSERT_TRUE(decoder.decode(stream.data(), pos));
+    TEST_ASSERT_EQUAL_UINT8(1, decoder.lastType);
+    TEST_ASSERT_EQUAL_UINT32(4 * 3, decoder.lastTiles);
+    TEST_ASSERT_EQUAL_UINT32(pos, stream.data().size());
+    TEST_ASSERT_EQUAL_UINT32(0, countMismatches(decoder));
+
+    // 描画をやめると、消えた分を送る
+    finishFrame();
+    TEST_ASSERT_TRUE(decoder.decode(stream.data(), pos));
+    TEST_ASSERT_EQUAL_UINT32(0, countMismatches(decoder));
+}
+
+void test_stream_interval_and_key_frames()
+{
+    // 2 フレームごとに送り、送るフレームの 2 回に 1 回をキーフレームにする
+    Host::MemoryStream stream;
+    System::StartFrameStreaming(stream, 2, 2);
+
+    FrameDecoder decoder;
+    size_t pos = 0;
+    std::vector<uint8_t> types;
+    for (int i = 0; i < 8; ++i)
+    {
+        drawScene(i * 4);
+        finishFrame();
+        while (pos < stream.data().size())
+        {
+            TEST_ASSERT_TRUE(decoder.decode(stream.data(), pos));
+            types.push_back(decoder.lastType);
+        }
+    }
+    const uint8_t expected[] = {0, 1, 0, 1};
+    TEST_ASSERT_EQUAL_UINT32(4, types.size());
+    TEST_ASSERT_EQUAL_MEMORY(expected, types.data(), sizeof(expected));
+}
+
+int main()
+{
+    System::Init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_screenshot_matches_screen);
+    RUN_TEST(test_banded_screenshot_matches_full);
+    RUN_TEST(test_streaming_sends_changed_tiles);
+    RUN_TEST(test_stream_interval_and_key_frames);
+    return UNITY_END();
+}
@@ -0,0 +1,379 @@
+#include <unity.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "M5Siv3D.h"
+
+// 基準画像 (golden) との画素比較テスト
+//
+// 決まった場面をホスト用の実装で描画し、golden/ に保存した画面全体の RGB565 画像と比べる。
+// 描画処理を最適化したときに、結果が変わっていないことを確かめるために使う。
+//
+// 描画結果を意図して変えたときは、環境変数 M5SIV3D_UPDATE_GOLDEN=1 を付けて実行すると基準画像を更新する。
+//   M5SIV3D_UPDATE_GOLDEN=1 pio test -e native -f native/test_golden_images
+// 一致しなかった場面は golden/<場面>.actual.ppm と golden/<場面>.diff.ppm に書き出す。
+//
+// 基準画像の形式 (値はリトルエンディアン)
+//   "M5GI" u8:version u8:0 u16:width u16:height
+//   { u16:count u16:rgb565 } の繰り返し (左上から行順のランレングス)
+namespace
+{
+    struct Image565
+    {
+        int32_t width = 0;
+        int32_t height = 0;
+        std::vector<uint16_t> pixels;
+    };
+
+    // 比較結果
+    struct DiffResult
+    {
+        uint32_t differentPixels = 0; // 許容差を超えた画素数
+        uint32_t maxDelta = 0;        // 8bit に換算したチャンネルの差の最大値
+        std::vector<bool> mask;
+    };
+
+    std::string GoldenDirectory()
+    {
+        if (const char *dir = std::getenv("M5SIV3D_GOLDEN_DIR"))
+        {
+            return dir;
+        }
+        std::string file = __FILE__;
+        return file.substr(0, file.find_last_of("/\\") + 1) + "golden";
+    }
+
+    bool UpdateRequested()
+    {
+        const char *value = std::getenv("M5SIV3D_UPDATE_GOLDEN");
+        return value && value[0] && value[0] != '0';
+    }
+
+    void putU16(std::vector<uint8_t> &out, uint16_t value)
+    {
+        out.push_back(uint8_t(value));
+        out.push_back(uint8_t(value >> 8));
+    }
+
+    uint16_t getU16(const std::vector<uint8_t> &in, size_t offset)
+    {
+        return uint16_t(in[offset] | (in[offset + 1] << 8));
+    }
+
+    bool SaveGolden(const std::string &path, const Image565 &image)
+    {
+        std::vector<uint8_t> data = {'M', '5', 'G', 'I', 1, 0};
+        putU16(data, uint16_t(image.width));
+        putU16(data, uint16_t(image.height));
+        for (size_t i = 0; i < image.pixels.size();)
+        {
+            size_t run = 1;
+            while (i + run < image.pixels.size() && image.pixels[i + run] == image.pixels[i] && run < 0xFFFF)
+            {
+                ++run;
+            }
+            putU16(data, uint16_t(run));
+            putU16(data, image.pixels[i]);
+            i += run;
+        }
+
+        FILE *file = std::fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            return false;
+        }
+        const bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+        std::fclose(file);
+        return written;
+    }
+
+    bool LoadGolden(const std::string &path, Image565 &image)
+    {
+        FILE *file = std::fopen(path.c_str(), "rb");
+        if (!file)
+        {
+            return false;
+        }
+        std::vector<uint8_t> data;
+        uint8_t buffer[4096];
+        size_t read;
+        while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            data.insert(data.end(), buffer, buffer + read);
+        }
+        std::fclose(file);
+
+        if (data.size() < 10 || data[0] != 'M' || data[1] != '5' || data[2] != 'G' || data[3] != 'I' || data[4] != 1)
+        {
+            return false;
+        }
+        image.width = getU16(data, 6);
+        image.height = getU16(data, 8);
+        image.pixels.clear();
+        for (size_t offset = 10; offset + 4 <= data.size(); offset += 4)
+        {
+            image.pixels.insert(image.pixels.end(), getU16(data, offset), getU16(data, offset + 2));
+        }
+        return image.pixels.size() == size_t(image.width) * size_t(image.height);
+    }
+
+    // 確認用に PPM (P6) で書き出す
+    void SavePpm(const std::string &path, const Image565 &image)
+    {
+        FILE *file = std::fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            return;
+        }
+        std::fprintf(file, "P6\n%d %d\n255\n", int(image.width), int(image.height));
+        for (uint16_t p : image.pixels)
+        {
+            const uint8_t rgb[3] = {uint8_t((p >> 11) * 255 / 31), uint8_t(((p >> 5) & 0x3F) * 255 / 63), uint8_t((p & 0x1F) * 255 / 31)};
+            std::fwrite(rgb, 1, 3, file);
+        }
+        std::fclose(file);
+    }
+
+    // 2 画素のチャンネルごとの差の最大値 (8bit に換算)
+    uint32_t ChannelDelta(uint16_t a, uint16_t b)
+    {
+        const int32_t dr = std::abs(int32_t(a >> 11) - int32_t(b >> 11)) * 255 / 31;
+        const int32_t dg = std::abs(int32_t((a >> 5) & 0x3F) - int32_t((b >> 5) & 0x3F)) * 255 / 63;
+        const int32_t db = std::abs(int32_t(a & 0x1F) - int32_t(b & 0x1F)) * 255 / 31;
+        return uint32_t(std::max(dr, std::max(dg, db)));
+    }
+
+    // tolerance 以下の色の差は一致とみなす
+    DiffResult Compare(const Image565 &expected, const Image565 &actual, uint32_t tolerance)
+    {
+        DiffResult result;
+        result.mask.assign(actual.pixels.size(), false);
+        for (size_t i = 0; i < actual.pixels.size(); ++i)
+        {
+            const uint32_t delta = ChannelDelta(expected.pixels[i], actual.pixels[i]);
+            result.maxDelta = std::max(result.maxDelta, delta);
+            if (delta > tolerance)
+            {
+                result.mask[i] = true;
+                ++result.differentPixels;
+            }
+        }
+        return result;
+    }
+
+    // 画面全体を読み出す
+    Image565 CaptureScreen()
+    {
+        M5.Display.waitDMA();
+        Image565 image;
+        image.width = M5.Display.width();
+        image.height = M5.Display.height();
+        image.pixels.resize(size_t(image.width) * size_t(image.height));
+        for (int32_t y = 0; y < image.height; ++y)
+        {
+            for (int32_t x = 0; x < image.width; ++x)
+            {
+                image.pixels[size_t(y) * image.width + x] = M5.Display.readPixel(x, y);
+            }
+        }
+        return image;
+    }
+
+    // 場面を描画して基準画像と比べる
+    // tolerance: 一致とみなす色の差 (8bit 換算)、allowedPixels: 許容差を超えてもよい画素数
+    void CheckScene(const char *name, void (*scene)(), uint32_t tolerance = 0, uint32_t allowedPixels = 0)
+    {
+        // 前の場面の描画を消してから描く
+        System::Update();
+        scene();
+        System::Update();
+        const Image565 actual = CaptureScreen();
+
+        const std::string base = GoldenDirectory() + "/" + name;
+        if (UpdateRequested())
+        {
+            TEST_ASSERT_TRUE_MESSAGE(SaveGolden(base + ".m5gi", actual), "failed to write golden image");
+            std::printf("%s: golden image updated\n", name);
+            return;
+        }
+
+        Image565 expected;
+        if (!LoadGolden(base + ".m5gi", expected))
+        {
+            std::printf("%s: missing golden image %s.m5gi (run with M5SIV3D_UPDATE_GOLDEN=1)\n", name, base.c_str());
+            TEST_FAIL_MESSAGE("missing golden image");
+        }
+        TEST_ASSERT_EQUAL_INT32(expected.width, actual.width);
+        TEST_ASSERT_EQUAL_INT32(expected.height, actual.height);
+
+        const DiffResult diff = Compare(expected, actual, tolerance);
+        std::printf("%s: %u pixels differ (max delta %u)\n", name, unsigned(diff.differentPixels), unsigned(diff.maxDelta));
+        if (diff.differentPixels > allowedPixels)
+        {
+            // 差分を赤で示した画像
+            Image565 marked = actual;
+            for (size_t i = 0; i < marked.pixels.size(); ++i)
+            {
+                marked.pixels[i] = diff.mask[i] ? 0xF800 : uint16_t((marked.pixels[i] >> 2) & 0x39E7);
+            }
+            SavePpm(base + ".actual.ppm", actual);
+            SavePpm(base + ".diff.ppm", marked);
+        }
+        TEST_ASSERT_TRUE_MESSAGE(diff.differentPixels <= allowedPixels, "rendering differs from golden image");
+    }
+
+    //////////////////////////////////////////////////
+    // 場面
+    //////////////////////////////////////////////////
+
+    void SceneCircles()
+    {
+        Circle(50, 50, 30).draw(Palette::Red);
+        Circle(130, 50, 30).drawFrame(Palette::Green);
+        Circle(210, 50, 30).fillArc(15, 30, 240, Palette::Yellow);
+        Circle(290, 50, 25).drawArc(10, 200, 20, Palette::Cyan);
+        Circle(Math::Vec2i(60, 160), 45).draw(Palette::Blue);
+        Circle(Math::Vec2i(60, 160), 45).drawFrame(Palette::White);
+        Circle(200, 170, 1).draw(Palette::White);
+        Circle(240, 170, 0).drawFrame(Palette::White);
+    }
+
+    void SceneRects()
+    {
+        Rect(10, 10, 80, 50).draw(Palette::Red);
+        Rect(100, 10, 80, 50).drawFrame(Palette::Green);
+        Rect(190, 10, 80, 50).drawRound(12, Palette::Yellow);
+        Rect(10, 80, 80, 50).drawRoundFrame(12, Palette::Cyan);
+        Rect(Math::Vec2i(100, 80), Math::Vec2i(1, 50)).draw(Palette::White);
+        Rect(110, 80, 60, 1).draw(Palette::White);
+        Rect(-20, 200, 60, 60).draw(Palette::Magenta); // 画面外にはみ出す
+        Rect(300, 150, 40, 40).drawFrame(Palette::Orange);
+    }
+
+    void SceneTrianglesAndLines()
+    {
+        Triangle(20, 100, 80, 100, 50, 20).draw(Palette::Red);
+        Triangle(100, 100, 160, 100, 130, 20).drawFrame(Palette::Green);
+        Triangle(Math::Vec2i(180, 20), Math::Vec2i(300, 40), Math::Vec2i(200, 110)).draw(Palette::Yellow);
+        Line(10, 130, 310, 230).draw(Palette::White);
+        Line(10, 230, 310, 130).draw(Palette::Cyan);
+        Line(160, 120, 160, 239).draw(Palette::Magenta);
+        Line(0, 180, 319, 180).draw(Palette::Orange);
+    }
+
+    void SceneBeziers()
+    {
+        Bezier::create3Point(20, 200, 80, 20, 150, 200).draw(Palette::Yellow);
+        Bezier::create4Point(170, 200, 190, 20, 280, 220, 300, 40).draw(Palette::Cyan);
+        Bezier::Bezier3(10, 120, 160, 230, 310, 120).draw(Palette::White);
+    }
+
+    void SceneFontAlignments()
+    {
+        const Font::HorizontalAlign hAligns[] = {Font::HorizontalAlign::Left, Font::HorizontalAlign::Center, Font::HorizontalAlign::Right};
+        const Font::VerticalAlign vAligns[] = {Font::VerticalAlign::Top, Font::VerticalAlign::Center, Font::VerticalAlign::Bottom, Font::VerticalAlign::Baseline};
+        Font font(fonts::Font0);
+        font.setSize(2);
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int col = 0; col < 3; ++col)
+            {
+                const int32_t x = 55 + col * 105;
+                const int32_t y = 30 + row * 58;
+                Line(x - 6, y, x + 6, y).draw(Palette::Red);
+                Line(x, y - 6, x, y + 6).draw(Palette::Red);
+                font.setHorizontalAlign(hAligns[col]).setVerticalAlign(vAligns[row]);
+                font.draw("Ag1", x, y, Palette::White);
+            }
+        }
+    }
+
+    void DrawWidgets(bool enabled)
+    {
+        static double value = 0.3;
+        static double labelled = 0.75;
+        static bool checked = true;
+        static bool unchecked = false;
+        static size_t index = 1;
+        static const std::vector<String> options = {"One", "Two", "Three"};
+
+        SimpleGUI::Button("Button", Math::Vec2i(10, 10), 120, enabled);
+        SimpleGUI::Slider(value, Math::Vec2i(150, 10), 0.0, 1.0, 150, enabled);
+        SimpleGUI::Slider("Vol", labelled, Math::Vec2i(10, 45), 0.0, 1.0, 80, 180, enabled);
+        SimpleGUI::CheckBox(checked, "On", Math::Vec2i(10, 80), 120, enabled);
+        SimpleGUI::CheckBox(unchecked, "Off", Math::Vec2i(150, 80), 120, enabled);
+        SimpleGUI::RadioButtons(index, options, Math::Vec2i(10, 115), 150, enabled);
+    }
+
+    void SceneGuiEnabled()
+    {
+        DrawWidgets(true);
+    }
+
+    void SceneGuiDisabled()
+    {
+        DrawWidgets(false);
+    }
+}
+
+void setUp()
+{
+    System::SetBackgroundColor(Palette::Black);
+}
+
+void tearDown()
+{
+    System::SetBackgroundColor(Palette::Black);
+}
+
+void test_circles() { CheckScene("circles", SceneCircles); }
+void test_rects() { CheckScene("rects", SceneRects); }
+void test_triangles_and_lines() { CheckScene("triangles_lines", SceneTrianglesAndLines); }
+void test_beziers() { CheckScene("beziers", SceneBeziers); }
+void test_font_alignments() { CheckScene("font_alignments", SceneFontAlignments); }
+void test_gui_enabled()
+{
+    System::SetBackgroundColor(Palette::Dimgray);
+    CheckScene("gui_enabled", SceneGuiEnabled);
+}
+
+void test_gui_disabled()
+{
+    System::SetBackgroundColor(Palette::Dimgray);
+    CheckScene("gui_disabled", SceneGuiDisabled);
+}
+
+// 比較処理そのものの確認
+void test_tolerance_ignores_small_color_differences()
+{
+    Image565 a;
+    a.width = 2;
+    a.height = 1;
+    a.pixels = {Palette::Gray.toRGB565(), Palette::Red.toRGB565()};
+    Image565 b = a;
+    b.pixels[0] = uint16_t(b.pixels[0] + 1); // 青が 1 段階 (約 8) 違う
+
+    TEST_ASSERT_EQUAL_UINT32(1, Compare(a, b, 0).differentPixels);
+    TEST_ASSERT_EQUAL_UINT32(0, Compare(a, b, 8).differentPixels);
+    TEST_ASSERT_EQUAL_UINT32(8, Compare(a, b, 8).maxDelta);
+    b.pixels[1] = Palette::Blue.toRGB565();
+    TEST_ASSERT_EQUAL_UINT32(1, Compare(a, b, 8).differentPixels);
+}
+
+int main()
+{
+    Host::Clock::getInstance().setVirtual(true);
+    System::Init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_tolerance_ignores_small_color_differences);
+    RUN_TEST(test_circles);
+    RUN_TEST(test_rects);
+    RUN_TEST(test_triangles_and_lines);
+    RUN_TEST(test_beziers);
+    RUN_TEST(test_font_alignments);
+    RUN_TEST(test_gui_enabled);
+    RUN_TEST(test_gui_disabled);
+    return UNITY_END();
+}
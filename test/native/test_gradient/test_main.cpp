@@ -0,0 +1,164 @@
+#include <unity.h>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "M5Siv3D.h"
+#include "M5Siv3D/Host/TestSupport.h"
+
+// グラデーションの塗り (Linear / Radial)
+namespace
+{
+    uint16_t ScreenPixel(int32_t x, int32_t y)
+    {
+        M5.Display.waitDMA();
+        return uint16_t(M5.Display.readPixel(x, y));
+    }
+
+    // 浮動小数点で計算した t の位置の色
+    uint16_t Reference(const Color &from, const Color &to, float t)
+    {
+        t = std::min(1.0f, std::max(0.0f, t));
+        return Color(uint8_t(from.r + (to.r - from.r) * t + 0.5f), uint8_t(from.g + (to.g - from.g) * t + 0.5f),
+                     uint8_t(from.b + (to.b - from.b) * t + 0.5f))
+            .toRGB565();
+    }
+
+    // RGB565 の成分ごとの差が tolerance 以下
+    void AssertNear(uint16_t expected, uint16_t actual, int32_t tolerance, int32_t x, int32_t y)
+    {
+        const int32_t dr = std::abs(int32_t(expected >> 11) - int32_t(actual >> 11));
+        const int32_t dg = std::abs(int32_t((expected >> 5) & 0x3F) - int32_t((actual >> 5) & 0x3F));
+        const int32_t db = std::abs(int32_t(expected & 0x1F) - int32_t(actual & 0x1F));
+        char message[80];
+        snprintf(message, sizeof(message), "(%d, %d): expected %04X, actual %04X", int(x), int(y), expected, actual);
+        TEST_ASSERT_TRUE_MESSAGE(dr <= tolerance && dg <= tolerance && db <= tolerance, message);
+    }
+
+    void SceneGradients()
+    {
+        Rect(10, 10, 300, 40).draw(Gradient::Horizontal(Palette::Green, Palette::Red));
+        Rect(10, 60, 100, 170).draw(Gradient::Linear(Palette::Yellow, Palette::Blue, 30.0f));
+        Circle(200, 140, 70).draw(Gradient::Radial(Palette::White, Palette::Magenta));
+        Triangle(120, 230, 310, 230, 250, 80).draw(Gradient::Vertical(Palette::Cyan, Palette::Black));
+    }
+}
+
+void setUp()
+{
+    System::SetPresentMode(PresentMode::Full);
+    System::SetBackgroundColor(Palette::Black);
+}
+
+void tearDown()
+{
+    System::SetPresentMode(PresentMode::Full);
+    System::SetBackgroundColor(Palette::Black);
+}
+
+void test_horizontal_and_vertical_match_reference()
+{
+    const Color left(255, 0, 40), right(0, 200, 255);
+    System::Update();
+    Rect(10, 10, 200, 20).draw(Gradient::Horizontal(left, right));
+    Rect(10, 40, 30, 150).draw(Gradient::Vertical(left, right));
+    System::Update();
+
+    for (int32_t x = 10; x < 210; ++x)
+    {
+        AssertNear(Reference(left, right, (x - 10) / 199.0f), ScreenPixel(x, 10), 1, x, 10);
+        TEST_ASSERT_EQUAL_UINT16(ScreenPixel(x, 10), ScreenPixel(x, 29));
+    }
+    for (int32_t y = 40; y < 190; ++y)
+    {
+        AssertNear(Reference(left, right, (y - 40) / 149.0f), ScreenPixel(10, y), 1, 10, y);
+        TEST_ASSERT_EQUAL_UINT16(ScreenPixel(10, y), ScreenPixel(39, y));
+    }
+
+    // 両端は指定した色
+    TEST_ASSERT_EQUAL_UINT16(left.toRGB565(), ScreenPixel(10, 10));
+    TEST_ASSERT_EQUAL_UINT16(right.toRGB565(), ScreenPixel(209, 10));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(210, 10));
+}
+
+void test_angled_gradient_runs_corner_to_corner()
+{
+    System::Update();
+    Rect(20, 20, 101, 101).draw(Gradient::Linear(Palette::Black, Palette::White, 45.0f));
+    System::Update();
+
+    TEST_ASSERT_EQUAL_UINT16(0x0000, ScreenPixel(20, 20));
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, ScreenPixel(120, 120));
+    // 向きに垂直な線の上は同じ色
+    AssertNear(ScreenPixel(120, 20), ScreenPixel(20, 120), 1, 20, 120);
+    AssertNear(ScreenPixel(110, 30), ScreenPixel(30, 110), 1, 30, 110);
+    AssertNear(Reference(Palette::Black, Palette::White, 0.5f), ScreenPixel(70, 70), 1, 70, 70);
+}
+
+void test_radial_gradient_is_symmetric()
+{
+    System::Update();
+    Circle(160, 120, 60).draw(Gradient::Radial(Palette::White, Palette::Blue));
+    System::Update();
+
+    TEST_ASSERT_EQUAL_UINT16(Palette::White.toRGB565(), ScreenPixel(160, 120));
+    for (int32_t d = 0; d <= 60; d += 5)
+    {
+        const uint16_t right = ScreenPixel(160 + d, 120);
+        TEST_ASSERT_EQUAL_UINT16(right, ScreenPixel(160 - d, 120));
+        TEST_ASSERT_EQUAL_UINT16(right, ScreenPixel(160, 120 + d));
+        TEST_ASSERT_EQUAL_UINT16(right, ScreenPixel(160, 120 - d));
+        AssertNear(Reference(Palette::White, Palette::Blue, d / 60.5f), right, 1, 160 + d, 120);
+    }
+
+    // 斜めの位置も中心からの距離で決まる
+    for (int32_t y = 60; y <= 180; y += 7)
+    {
+        for (int32_t x = 100; x <= 220; x += 7)
+        {
+            const float distance = std::sqrt(float((x - 160) * (x - 160) + (y - 120) * (y - 120)));
+            if (distance < 60.0f)
+            {
+                AssertNear(Reference(Palette::White, Palette::Blue, distance / 60.5f), ScreenPixel(x, y), 1, x, y);
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(160 + 61, 120));
+}
+
+void test_gradient_shapes_cover_same_pixels_as_fills()
+{
+    // 単色のグラデーションは塗りつぶしと同じになる
+    const Gradient solid = Gradient::Horizontal(Palette::Orange, Palette::Orange);
+
+    System::Update();
+    Rect(10, 10, 60, 40).draw(solid);
+    Triangle(100, 100, 300, 150, 180, 20).draw(solid);
+    System::Update();
+    const std::vector<uint16_t> gradient = Host::CaptureScreen();
+
+    System::Update();
+    Rect(10, 10, 60, 40).draw(Palette::Orange);
+    Triangle(100, 100, 300, 150, 180, 20).draw(Palette::Orange);
+    System::Update();
+    const std::vector<uint16_t> filled = Host::CaptureScreen();
+
+    TEST_ASSERT_TRUE(gradient == filled);
+}
+
+void test_banded_matches_full()
+{
+    Host::CheckBandedMatchesFull(SceneGradients);
+}
+
+int main()
+{
+    System::Init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_horizontal_and_vertical_match_reference);
+    RUN_TEST(test_angled_gradient_runs_corner_to_corner);
+    RUN_TEST(test_radial_gradient_is_symmetric);
+    RUN_TEST(test_gradient_shapes_cover_same_pixels_as_fills);
+    RUN_TEST(test_banded_matches_full);
+    return UNITY_END();
+}
@@ -0,0 +1,284 @@
+#include <unity.h>
+#include "M5Siv3D.h"
+
+// ホスト用の実装 (M5SIV3D_HOST) で System の描画から転送までを通して確かめる
+// 時刻は仮想時間で進めるので、待機や DMA 転送の時間は実時間に依存しない
+namespace
+{
+    Host::Clock &virtualClock()
+    {
+        return Host::Clock::getInstance();
+    }
+
+    // 描画に drawMicros かかったことにしてフレームを終える
+    void finishFrame(uint64_t drawMicros = 1000)
+    {
+        virtualClock().advanceMicros(drawMicros);
+        System::Update();
+    }
+
+    uint16_t screenPixel(int32_t x, int32_t y)
+    {
+        M5.Display.waitDMA();
+        return M5.Display.readPixel(x, y);
+    }
+}
+
+void setUp()
+{
+    virtualClock().setVirtual(true);
+    M5.Display.setDmaNanosPerPixel(0);
+    System::SetPresentMode(PresentMode::Full);
+    System::SetAsyncPresent(true);
+    System::SetDamageDetection(false);
+    System::SetTargetFPS(60.0f);
+    System::SetBackgroundColor(Palette::Black);
+
+    // 前のテストの描画を消しておく
+    finishFrame();
+    finishFrame();
+    M5.Display.waitDMA();
+    M5.Display.resetStats();
+}
+
+void tearDown() {}
+
+void test_shapes_reach_the_screen()
+{
+    Rect(10, 20, 30, 40).draw(Palette::Red);
+    Circle(200, 120, 10).draw(Palette::Blue);
+    finishFrame();
+
+    TEST_ASSERT_EQUAL_UINT16(Palette::Red.toRGB565(), screenPixel(10, 20));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Red.toRGB565(), screenPixel(39, 59));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Black.toRGB565(), screenPixel(40, 60));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Blue.toRGB565(), screenPixel(200, 120));
+
+    // 描画しなかったフレームでは消える
+    finishFrame();
+    TEST_ASSERT_EQUAL_UINT16(Palette::Black.toRGB565(), screenPixel(10, 20));
+}
+
+void test_full_present_pushes_whole_screen()
+{
+    Rect(0, 0, 8, 8).draw(Palette::White);
+    finishFrame();
+
+    const uint32_t screen = uint32_t(System::Width()) * uint32_t(System::Height());
+    TEST_ASSERT_EQUAL_UINT32(screen, System::PushedPixels());
+    TEST_ASSERT_EQUAL_UINT64(screen, M5.Display.stats().pushedPixels);
+}
+
+void test_dirty_rect_pushes_only_drawn_pixels()
+{
+    System::SetPresentMode(PresentMode::DirtyRect);
+    finishFrame(); // 切り替え直後は全面を転送する
+    finishFrame();
+
+    Rect(10, 10, 20, 20).draw(Palette::Green);
+    finishFrame();
+    M5.Display.resetStats();
+
+    // 同じ位置に描き続ける間は、その範囲だけを転送する
+    for (int i = 0; i < 5; ++i)
+    {
+        Rect(10, 10, 20, 20).draw(Palette::Green);
+        finishFrame();
+        TEST_ASSERT_EQUAL_UINT32(400, System::PushedPixels());
+    }
+    TEST_ASSERT_EQUAL_UINT64(5 * 400, M5.Display.stats().pushedPixels);
+    TEST_ASSERT_EQUAL_UINT16(Palette::Green.toRGB565(), screenPixel(29, 29));
+
+    // 描画をやめたフレームでは、消えた範囲を 1 度だけ転送する
+    finishFrame();
+    TEST_ASSERT_EQUAL_UINT32(400, System::PushedPixels());
+    TEST_ASSERT_EQUAL_UINT16(Palette::Black.toRGB565(), screenPixel(29, 29));
+    finishFrame();
+    TEST_ASSERT_EQUAL_UINT32(0, System::PushedPixels());
+}
+
+void test_dirty_rect_pushes_rect_with_negative_size()
+{
+    System::SetPresentMode(PresentMode::DirtyRect);
+    finishFrame();
+    finishFrame();
+
+    // 負の幅・高さは fillRect と同じく (x, y) から反対側に広がる
+    Rect(50, 50, -10, 10).draw(Palette::Red);
+    Rect(100, 50, 10, -10).drawFrame(Palette::Green);
+    finishFrame();
+
+    TEST_ASSERT_EQUAL_UINT16(Palette::Red.toRGB565(), screenPixel(41, 50));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Red.toRGB565(), screenPixel(50, 59));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Black.toRGB565(), screenPixel(51, 55));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Green.toRGB565(), screenPixel(100, 41));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Green.toRGB565(), screenPixel(109, 50));
+    TEST_ASSERT_EQUAL_UINT32(200, System::PushedPixels());
+}
+
+void test_print_uses_text_color_and_bounds_printed_lines()
+{
+    System::SetPresentMode(PresentMode::DirtyRect);
+    finishFrame();
+    finishFrame();
+
+    auto &canvas = System::getInstance().getCanvas();
+    canvas.setFont(&fonts::Font0);
+    canvas.setTextSize(1);
+    canvas.setTextColor(Palette::Yellow.toRGB565());
+
+    // 1 行だけなら 8 ドットの高さだけを転送する
+    Print << "Hi";
+    drawPrint();
+    finishFrame();
+    TEST_ASSERT_EQUAL_UINT32(320 * 8, System::PushedPixels());
+    bool found = false;
+    for (int32_t y = 0; y < 8; ++y)
+    {
+        for (int32_t x = 0; x < 12; ++x)
+        {
+            const uint16_t pixel = screenPixel(x, y);
+            if (pixel != Palette::Black.toRGB565())
+            {
+                TEST_ASSERT_EQUAL_UINT16(Palette::Yellow.toRGB565(), pixel);
+                found = true;
+            }
+        }
+    }
+    TEST_ASSERT_TRUE(found);
+    ClearPrint();
+    finishFrame();
+
+    // 右端で折り返した行も含める (6 ドットの文字 60 個は 2 行になる)
+    Print << std::string(60, 'A');
+    drawPrint();
+    finishFrame();
+    TEST_ASSERT_EQUAL_UINT32(320 * 16, System::PushedPixels());
+    ClearPrint();
+    canvas.setTextColor(Palette::White.toRGB565());
+}
+
+void test_layer_is_not_composited_before_first_paint()
+{
+    System::SetBackgroundColor(Palette::Blue);
+    finishFrame(); // 背景色は次のフレームの消去から使われる
+
+    // アサーションで抜けるとレイヤーが破棄されないので、結果を取り出してから確かめる
+    uint16_t backPixel, frontPixel, backPainted, backFill, frontPainted;
+    {
+        Layer back(10, 10, 20, 20, -1);
+        Layer front(40, 10, 20, 20, 1);
+
+        // まだ描いていないレイヤーは合成しない (背景がそのまま見える)
+        finishFrame();
+        backPixel = screenPixel(15, 15);
+        frontPixel = screenPixel(45, 15);
+
+        // 背面のレイヤーは beginDraw で合成するので、paint() の結果は次のフレームから見える
+        back.paint([] { Rect(0, 0, 4, 4).draw(Palette::Red); });
+        front.paint([] { Rect(0, 0, 4, 4).draw(Palette::Red); });
+        finishFrame();
+        finishFrame();
+        backPainted = screenPixel(10, 10);
+        backFill = screenPixel(15, 15);
+        frontPainted = screenPixel(40, 10);
+    }
+
+    TEST_ASSERT_EQUAL_UINT16(Palette::Blue.toRGB565(), backPixel);
+    TEST_ASSERT_EQUAL_UINT16(Palette::Blue.toRGB565(), frontPixel);
+    TEST_ASSERT_EQUAL_UINT16(Palette::Red.toRGB565(), backPainted);
+    TEST_ASSERT_EQUAL_UINT16(Palette::Black.toRGB565(), backFill);
+    TEST_ASSERT_EQUAL_UINT16(Palette::Red.toRGB565(), frontPainted);
+}
+
+void test_double_buffered_transfer_overlaps_drawing()
+{
+    // 320x240 の転送に約 7.7ms かかる画面
+    M5.Display.setDmaNanosPerPixel(100);
+    System::SetTargetFPS(0.0f);
+    System::SetPresentMode(PresentMode::DoubleBuffered);
+    finishFrame();
+    M5.Display.waitDMA();
+    M5.Display.resetStats();
+
+    // 描画が転送より長ければ、転送の完了を待つことはない
+    for (int i = 0; i < 10; ++i)
+    {
+        Rect(0, 0, 16, 16).draw(i % 2 ? Palette::Red : Palette::Blue);
+        finishFrame(10000);
+        TEST_ASSERT_TRUE(System::getInstance().getProfiler().latest()[FramePhase::Present] < 1000);
+    }
+    TEST_ASSERT_EQUAL_UINT32(10, M5.Display.stats().dmaTransfers);
+    TEST_ASSERT_EQUAL_UINT64(0, M5.Display.stats().dmaWaitMicros);
+
+    // 転送が終わると最後のフレームが表示されている
+    TEST_ASSERT_EQUAL_UINT16(Palette::Red.toRGB565(), screenPixel(0, 0));
+
+    // 描画が転送より短いと、次の転送の前に残りの時間だけ待つ
+    M5.Display.resetStats();
+    for (int i = 0; i < 10; ++i)
+    {
+        finishFrame(5000);
+    }
+    const uint64_t waited = M5.Display.stats().dmaWaitMicros;
+    TEST_ASSERT_TRUE(waited >= 9 * 2000 && waited <= 10 * 3000);
+}
+
+void test_double_buffered_releases_bus_on_wait_present()
+{
+    // 既定では、転送中はバスを開いたままフレームを終える
+    M5.Display.setDmaNanosPerPixel(100);
+    System::SetPresentMode(PresentMode::DoubleBuffered);
+    Rect(0, 0, 16, 16).draw(Palette::Blue);
+    finishFrame();
+    TEST_ASSERT_NOT_NULL(M5.Display.dmaSource());
+    TEST_ASSERT_EQUAL_INT32(1, M5.Display.writeDepth());
+
+    // SD カードを使う前に WaitPresent() で転送を終えてバスを解放する
+    System::WaitPresent();
+    TEST_ASSERT_NULL(M5.Display.dmaSource());
+    TEST_ASSERT_EQUAL_INT32(0, M5.Display.writeDepth());
+    TEST_ASSERT_EQUAL_UINT16(Palette::Blue.toRGB565(), screenPixel(0, 0));
+
+    // 並行させない場合は、毎フレームの終わりにバスを解放する
+    System::SetAsyncPresent(false);
+    for (int i = 0; i < 3; ++i)
+    {
+        Rect(0, 0, 16, 16).draw(Palette::Red);
+        finishFrame();
+        TEST_ASSERT_NULL(M5.Display.dmaSource());
+        TEST_ASSERT_EQUAL_INT32(0, M5.Display.writeDepth());
+    }
+    TEST_ASSERT_EQUAL_UINT16(Palette::Red.toRGB565(), screenPixel(0, 0));
+}
+
+void test_banded_releases_bus_after_each_frame()
+{
+    M5.Display.setDmaNanosPerPixel(100);
+    System::SetPresentMode(PresentMode::Banded);
+    for (int i = 0; i < 3; ++i)
+    {
+        Rect(0, 200, 16, 16).draw(Palette::Green);
+        finishFrame();
+        TEST_ASSERT_NULL(M5.Display.dmaSource());
+        TEST_ASSERT_EQUAL_INT32(0, M5.Display.writeDepth());
+    }
+    TEST_ASSERT_EQUAL_UINT16(Palette::Green.toRGB565(), screenPixel(0, 200));
+}
+
+int main()
+{
+    System::Init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_shapes_reach_the_screen);
+    RUN_TEST(test_full_present_pushes_whole_screen);
+    RUN_TEST(test_dirty_rect_pushes_only_drawn_pixels);
+    RUN_TEST(test_dirty_rect_pushes_rect_with_negative_size);
+    RUN_TEST(test_print_uses_text_color_and_bounds_printed_lines);
+    RUN_TEST(test_layer_is_not_composited_before_first_paint);
+    RUN_TEST(test_double_buffered_transfer_overlaps_drawing);
+    RUN_TEST(test_double_buffered_releases_bus_on_wait_present);
+    RUN_TEST(test_banded_releases_bus_after_each_frame);
+    return UNITY_END();
+}
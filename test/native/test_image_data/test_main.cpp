@@ -0,0 +1,159 @@
+#include <unity.h>
+#include <vector>
+#include "M5Siv3D.h"
+#include "M5Siv3D/Host/TestSupport.h"
+
+// フラッシュの変換済み画像 (ImageData) の描画
+namespace
+{
+    // 4x3 の同じ画像を 3 つの形式で持つ (tools/image_to_rgb565.py の出力と同じ並び)
+    //   赤 赤 青 青
+    //   赤 緑 緑 青
+    //   白 白 白 白
+    constexpr uint16_t Red = 0x00F8;   // 0xF800 (バイトを入れ替えた値)
+    constexpr uint16_t Green = 0xE007; // 0x07E0
+    constexpr uint16_t Blue = 0x1F00;  // 0x001F
+    constexpr uint16_t White = 0xFFFF;
+
+    M5SIV3D_INLINE_CONSTEXPR uint16_t TestPixels[] = {
+        Red, Red, Blue, Blue,
+        Red, Green, Green, Blue,
+        White, White, White, White,
+    };
+    M5SIV3D_INLINE_CONSTEXPR ImageData TestRGB565 = ImageData::RGB565(4, 3, TestPixels);
+
+    M5SIV3D_INLINE_CONSTEXPR uint16_t TestPalette[] = {Red, Green, Blue, White};
+    M5SIV3D_INLINE_CONSTEXPR uint8_t TestIndices[] = {
+        0, 0, 2, 2,
+        0, 1, 1, 2,
+        3, 3, 3, 3,
+    };
+    M5SIV3D_INLINE_CONSTEXPR ImageData TestIndexed = ImageData::Indexed8(4, 3, TestIndices, TestPalette);
+
+    M5SIV3D_INLINE_CONSTEXPR uint16_t TestRuns[] = {
+        2, Red, 2, Blue,
+        1, Red, 2, Green, 1, Blue,
+        4, White,
+    };
+    M5SIV3D_INLINE_CONSTEXPR uint32_t TestRows[] = {0, 4, 10};
+    M5SIV3D_INLINE_CONSTEXPR ImageData TestRLE = ImageData::RLE(4, 3, TestRuns, TestRows);
+
+    uint16_t Expected(int32_t x, int32_t y)
+    {
+        return Blend::Swap(TestPixels[y * 4 + x]);
+    }
+
+    void AssertImageAt(int32_t left, int32_t top)
+    {
+        M5.Display.waitDMA();
+        for (int32_t y = 0; y < 3; ++y)
+        {
+            for (int32_t x = 0; x < 4; ++x)
+            {
+                TEST_ASSERT_EQUAL_UINT16(Expected(x, y), uint16_t(M5.Display.readPixel(left + x, top + y)));
+            }
+        }
+        TEST_ASSERT_EQUAL_UINT16(0, uint16_t(M5.Display.readPixel(left + 4, top)));
+        TEST_ASSERT_EQUAL_UINT16(0, uint16_t(M5.Display.readPixel(left, top + 3)));
+    }
+
+    void SceneImages()
+    {
+        const Image images[] = {Image(TestRGB565), Image(TestIndexed), Image(TestRLE)};
+        for (int32_t i = 0; i < 3; ++i)
+        {
+            images[i].draw(10 + i * 50, 10);
+            images[i].draw(10 + i * 50, 100, 10.0f);
+            // 画面の端で切れる位置
+            images[i].draw(-2 + i * 160, 238);
+        }
+    }
+}
+
+void setUp()
+{
+    System::SetPresentMode(PresentMode::Full);
+    System::SetBackgroundColor(Palette::Black);
+}
+
+void tearDown()
+{
+    System::SetPresentMode(PresentMode::Full);
+    System::SetBackgroundColor(Palette::Black);
+}
+
+void test_all_formats_draw_the_same_pixels()
+{
+    const Image rgb565(TestRGB565), indexed(TestIndexed), rle(TestRLE);
+    TEST_ASSERT_FALSE(rgb565.isEmpty());
+    TEST_ASSERT_EQUAL_INT32(4, rle.width());
+    TEST_ASSERT_EQUAL_INT32(3, indexed.height());
+
+    System::Update();
+    rgb565.draw(10, 10);
+    indexed.draw(30, 10);
+    rle.draw(50, 10);
+    System::Update();
+
+    AssertImageAt(10, 10);
+    AssertImageAt(30, 10);
+    AssertImageAt(50, 10);
+}
+
+void test_scaled_draw_uses_nearest_pixel()
+{
+    const Image images[] = {Image(TestRGB565), Image(TestIndexed), Image(TestRLE)};
+    for (const Image &image : images)
+    {
+        System::Update();
+        image.draw(20, 20, 3.0f, 2.0f);
+        System::Update();
+
+        M5.Display.waitDMA();
+        for (int32_t y = 0; y < 6; ++y)
+        {
+            for (int32_t x = 0; x < 12; ++x)
+            {
+                TEST_ASSERT_EQUAL_UINT16(Expected(x / 3, y / 2), uint16_t(M5.Display.readPixel(20 + x, 20 + y)));
+            }
+        }
+        TEST_ASSERT_EQUAL_UINT16(0, uint16_t(M5.Display.readPixel(32, 20)));
+        TEST_ASSERT_EQUAL_UINT16(0, uint16_t(M5.Display.readPixel(20, 26)));
+    }
+}
+
+void test_rgb565_is_pushed_without_a_sprite()
+{
+    // 画素の配列をそのまま参照する (キャンバスを確保しない)
+    System::Update();
+    const Image image(TestRGB565);
+    image.draw(0, 0);
+    System::Update();
+    AssertImageAt(0, 0);
+
+    // 読み込み直すとフラッシュの画像の参照はやめる
+    Image loaded(TestRLE);
+    TEST_ASSERT_TRUE(loaded.create(8, 8, Palette::Red));
+    System::Update();
+    loaded.draw(0, 0);
+    System::Update();
+    M5.Display.waitDMA();
+    TEST_ASSERT_EQUAL_UINT16(Palette::Red.toRGB565(), uint16_t(M5.Display.readPixel(7, 7)));
+}
+
+void test_banded_matches_full()
+{
+    Host::CheckBandedMatchesFull(SceneImages);
+}
+
+int main()
+{
+    System::Init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_all_formats_draw_the_same_pixels);
+    RUN_TEST(test_scaled_draw_uses_nearest_pixel);
+    RUN_TEST(test_rgb565_is_pushed_without_a_sprite);
+    RUN_TEST(test_banded_matches_full);
+    return UNITY_END();
+}
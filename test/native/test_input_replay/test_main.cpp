@@ -0,0 +1,257 @@
+#include <unity.h>
+#include <vector>
+#include "M5Siv3D.h"
+
+// 入力の記録とリプレイ (InputLog / InputManager)
+// 記録したセッションを別のフレーム時間で再生し、アプリから見える入力と DeltaTime が一致することを確かめる
+namespace
+{
+    Host::Clock &virtualClock()
+    {
+        return Host::Clock::getInstance();
+    }
+
+    // アプリが 1 フレームで観測する入力
+    struct Observation
+    {
+        bool buttonDown;
+        bool buttonPressed;
+        bool buttonReleased;
+        bool buttonHeld; // 100ms 以上押されている
+        Math::Vec2i touchPos;
+        bool touchPressed;
+        bool touchDown;
+        bool touchUp;
+        float accelX;
+        float gyroZ;
+        float deltaTime;
+    };
+
+    Observation observe()
+    {
+        Observation o;
+        o.buttonDown = Input::ButtonA.down();
+        o.buttonPressed = Input::ButtonA.pressed();
+        o.buttonReleased = Input::ButtonA.released();
+        o.buttonHeld = Input::ButtonA.pressedDuration(100);
+        o.touchPos = Input::Touch.pos();
+        o.touchPressed = Input::Touch.pressed();
+        o.touchDown = Input::Touch.down();
+        o.touchUp = Input::Touch.up();
+        o.accelX = Input::IMU.getAccel().x;
+        o.gyroZ = Input::IMU.getGyro().z;
+        o.deltaTime = System::DeltaTime();
+        return o;
+    }
+
+    // frame 番目のフレームの実際の入力
+    void injectInput(int frame)
+    {
+        M5.BtnA.setRawState(frame >= 3 && frame < 12);
+        const bool touching = frame >= 5 && frame < 9;
+        M5.Touch.setRawState(int16_t(10 + frame * 4), int16_t(200 - frame * 2), touching);
+
+        m5::IMU_Class::imu_data_t data;
+        data.accel.x = (frame % 4) * 0.25f - 0.5f;
+        data.accel.z = 1.0f;
+        data.gyro.z = frame * 12.5f;
+        M5.Imu.setRawData(data);
+    }
+
+    constexpr int Frames = 16;
+
+    // フレームごとに違う時間をかけたセッション
+    uint64_t recordedFrameMicros(int frame)
+    {
+        return 16000 + uint64_t(frame % 3) * 7000;
+    }
+
+    void assertSame(const Observation &expected, const Observation &actual, int frame)
+    {
+        char message[32];
+        snprintf(message, sizeof(message), "frame %d", frame);
+        TEST_ASSERT_EQUAL_MESSAGE(expected.buttonDown, actual.buttonDown, message);
+        TEST_ASSERT_EQUAL_MESSAGE(expected.buttonPressed, actual.buttonPressed, message);
+        TEST_ASSERT_EQUAL_MESSAGE(expected.buttonReleased, actual.buttonReleased, message);
+        TEST_ASSERT_EQUAL_MESSAGE(expected.buttonHeld, actual.buttonHeld, message);
+        TEST_ASSERT_EQUAL_INT32_MESSAGE(expected.touchPos.x, actual.touchPos.x, message);
+        TEST_ASSERT_EQUAL_INT32_MESSAGE(expected.touchPos.y, actual.touchPos.y, message);
+        TEST_ASSERT_EQUAL_MESSAGE(expected.touchPressed, actual.touchPressed, message);
+        TEST_ASSERT_EQUAL_MESSAGE(expected.touchDown, actual.touchDown, message);
+        TEST_ASSERT_EQUAL_MESSAGE(expected.touchUp, actual.touchUp, message);
+        TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.001f, expected.accelX, actual.accelX, message);
+        TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.1f, expected.gyroZ, actual.gyroZ, message);
+        TEST_ASSERT_EQUAL_FLOAT_MESSAGE(expected.deltaTime, actual.deltaTime, message);
+    }
+
+    void resetInput()
+    {
+        M5.BtnA.setRawState(false);
+        M5.Touch.setRawState(-1, -1, false);
+        M5.Imu.setRawData(m5::IMU_Class::imu_data_t());
+        virtualClock().advanceMicros(16000);
+        System::Update();
+        virtualClock().advanceMicros(16000);
+        System::Update();
+    }
+}
+
+void setUp()
+{
+    virtualClock().setVirtual(true);
+    System::SetTargetFPS(0.0f);
+    System::SetFixedTimestep(false);
+    resetInput();
+}
+
+void tearDown()
+{
+    Input::InputManager::StopRecording();
+    Input::InputManager::StopReplay();
+}
+
+void test_log_round_trips_through_a_stream()
+{
+    Input::InputLog log;
+    Input::InputFrame frame = {};
+    frame.deltaMicros = 70000000;
+    frame.touchX = -1;
+    frame.touchY = 239;
+    frame.buttons = Input::InputFrame::TouchPressed | Input::InputFrame::ButtonCPressed;
+    frame.accel[0] = -32768;
+    frame.accel[2] = 1000;
+    frame.gyro[1] = 32767;
+    log.append(frame);
+    log.append(Input::InputFrame());
+    TEST_ASSERT_EQUAL_UINT32(2 * Input::InputLog::RecordSize, log.bytes());
+
+    Host::MemoryStream stream;
+    log.write(stream);
+    TEST_ASSERT_EQUAL_UINT32(Input::InputLog::HeaderSize + log.bytes(), stream.data().size());
+
+    Input::InputLog loaded;
+    TEST_ASSERT_TRUE(loaded.read(stream));
+    TEST_ASSERT_EQUAL_UINT32(2, loaded.size());
+    const Input::InputFrame first = loaded[0];
+    TEST_ASSERT_EQUAL_UINT32(70000000, first.deltaMicros);
+    TEST_ASSERT_EQUAL_INT16(-1, first.touchX);
+    TEST_ASSERT_EQUAL_INT16(239, first.touchY);
+    TEST_ASSERT_TRUE(first.isPressed(Input::InputFrame::TouchPressed));
+    TEST_ASSERT_FALSE(first.isPressed(Input::InputFrame::ButtonAPressed));
+    TEST_ASSERT_TRUE(first.isPressed(Input::InputFrame::ButtonCPressed));
+    TEST_ASSERT_EQUAL_INT16(-32768, first.accel[0]);
+    TEST_ASSERT_EQUAL_INT16(1000, first.accel[2]);
+    TEST_ASSERT_EQUAL_INT16(32767, first.gyro[1]);
+
+    // 途中で切れた記録は読み込まない
+    Host::MemoryStream truncated;
+    log.write(truncated);
+    std::vector<uint8_t> bytes = truncated.data();
+    bytes.pop_back();
+    Input::InputLog broken;
+    TEST_ASSERT_FALSE(broken.read(bytes.data(), bytes.size()));
+    TEST_ASSERT_TRUE(broken.read(truncated.data().data(), truncated.data().size()));
+}
+
+void test_log_rejects_corrupt_frame_count()
+{
+    Input::InputLog log;
+    log.append(Input::InputFrame());
+    log.append(Input::InputFrame());
+    Host::MemoryStream source;
+    log.write(source);
+
+    // フレーム数だけが壊れた記録 (実際のデータは 2 フレーム分しかない)
+    std::vector<uint8_t> bytes = source.data();
+    bytes[8] = bytes[9] = bytes[10] = bytes[11] = 0xFF;
+    Host::MemoryStream corrupt;
+    corrupt.write(bytes.data(), bytes.size());
+
+    // 読み込みに失敗しても、前の記録はそのまま残る
+    Input::InputLog loaded;
+    loaded.append(Input::InputFrame());
+    TEST_ASSERT_FALSE(loaded.read(corrupt));
+    TEST_ASSERT_FALSE(loaded.read(bytes.data(), bytes.size()));
+    TEST_ASSERT_EQUAL_UINT32(1, loaded.size());
+}
+
+void test_replay_reproduces_recorded_session()
+{
+    // 記録
+    Input::InputLog log;
+    std::vector<Observation> recorded;
+    Input::InputManager::StartRecording(log);
+    for (int frame = 0; frame < Frames; ++frame)
+    {
+        injectInput(frame);
+        virtualClock().advanceMicros(recordedFrameMicros(frame));
+        System::Update();
+        recorded.push_back(observe());
+    }
+    Input::InputManager::StopRecording();
+    TEST_ASSERT_EQUAL_UINT32(Frames, log.size());
+
+    // 書き出して読み直す
+    Host::MemoryStream stream;
+    log.write(stream);
+    Input::InputLog loaded;
+    TEST_ASSERT_TRUE(loaded.read(stream));
+
+    // 実際の入力や経過時間が違っても、記録したとおりに観測される
+    resetInput();
+    M5.Touch.setRawState(300, 5, true);
+    Input::InputManager::StartReplay(loaded);
+    for (int frame = 0; frame < Frames; ++frame)
+    {
+        TEST_ASSERT_TRUE(Input::InputManager::IsReplaying());
+        virtualClock().advanceMicros(5000 + uint64_t(frame) * 1000);
+        System::Update();
+        assertSame(recorded[frame], observe(), frame);
+    }
+
+    // 記録が終わると実際の入力に戻る
+    virtualClock().advanceMicros(16000);
+    System::Update();
+    TEST_ASSERT_FALSE(Input::InputManager::IsReplaying());
+    TEST_ASSERT_TRUE(Input::Touch.pressed());
+    TEST_ASSERT_EQUAL_INT32(300, Input::Touch.pos().x);
+    TEST_ASSERT_EQUAL_FLOAT(0.016f, System::DeltaTime());
+}
+
+void test_replay_holds_button_for_recorded_duration()
+{
+    // 50ms ごとのフレームでボタンを押し続けた記録
+    Input::InputLog log;
+    for (int frame = 0; frame < 4; ++frame)
+    {
+        Input::InputFrame input = {};
+        input.deltaMicros = 50000;
+        input.buttons = Input::InputFrame::ButtonAPressed;
+        log.append(input);
+    }
+
+    // 実時間ではほとんど進まなくても、押している時間は記録から求める
+    Input::InputManager::StartReplay(log);
+    const bool expectedHeld[] = {false, false, true, true};
+    for (int frame = 0; frame < 4; ++frame)
+    {
+        virtualClock().advanceMicros(1000);
+        System::Update();
+        TEST_ASSERT_TRUE(Input::ButtonA.down());
+        TEST_ASSERT_EQUAL(frame == 0, Input::ButtonA.pressed());
+        TEST_ASSERT_EQUAL(expectedHeld[frame], Input::ButtonA.pressedDuration(100));
+        TEST_ASSERT_EQUAL_FLOAT(0.05f, System::DeltaTime());
+    }
+}
+
+int main()
+{
+    System::Init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_log_round_trips_through_a_stream);
+    RUN_TEST(test_log_rejects_corrupt_frame_count);
+    RUN_TEST(test_replay_reproduces_recorded_session);
+    RUN_TEST(test_replay_holds_button_for_recorded_duration);
+    return UNITY_END();
+}
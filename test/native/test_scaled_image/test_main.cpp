@@ -0,0 +1,232 @@
+#include <unity.h>
+#include <vector>
+#include "M5Siv3D.h"
+#include "M5Siv3D/Host/TestSupport.h"
+
+// 拡大縮小した画像の描画 (ImageFilter) と ScaledImageCache
+namespace
+{
+    constexpr uint16_t Black = 0x0000;
+    constexpr uint16_t White = 0xFFFF;
+    constexpr uint16_t Orange = 0x20FD; // 0xFD20 (バイトを入れ替えた値)
+
+    M5SIV3D_INLINE_CONSTEXPR uint16_t EdgePixels[] = {Black, White};
+    M5SIV3D_INLINE_CONSTEXPR ImageData Edge = ImageData::RGB565(2, 1, EdgePixels);
+
+    M5SIV3D_INLINE_CONSTEXPR uint16_t SolidPixels[] = {
+        Orange, Orange, Orange,
+        Orange, Orange, Orange,
+        Orange, Orange, Orange,
+    };
+    M5SIV3D_INLINE_CONSTEXPR ImageData Solid = ImageData::RGB565(3, 3, SolidPixels);
+
+    // 各画素の色が位置で決まる 5x4 の画像
+    std::vector<uint16_t> g_patternPixels;
+    ImageData g_patternData = ImageData::RGB565(0, 0, nullptr);
+    TextureAtlas g_patternAtlas; // 同じ画像をキャンバスに持つ
+    const Image &g_patternCanvas = g_patternAtlas.image();
+
+    uint16_t ScreenPixel(int32_t x, int32_t y)
+    {
+        M5.Display.waitDMA();
+        return uint16_t(M5.Display.readPixel(x, y));
+    }
+
+    void ScenePattern()
+    {
+        const Image pattern(g_patternData);
+        pattern.draw(10, 10, 3.0f, ImageFilter::Bilinear);
+        pattern.draw(100, 10, 2.5f, 4.0f);
+        g_patternCanvas.draw(10, 100, 7.0f, ImageFilter::Bilinear);
+        // 画面の端で切れる位置
+        g_patternCanvas.draw(300, 220, 6.0f, ImageFilter::Bilinear);
+    }
+}
+
+void setUp()
+{
+    System::SetPresentMode(PresentMode::Full);
+    System::SetBackgroundColor(Palette::Black);
+    ScaledImageCache::SetBudget(0);
+}
+
+void tearDown()
+{
+    System::SetPresentMode(PresentMode::Full);
+    System::SetBackgroundColor(Palette::Black);
+    ScaledImageCache::SetBudget(0);
+}
+
+void test_bilinear_keeps_corners_and_blends()
+{
+    System::Update();
+    Image(Edge).draw(10, 10, 4.0f, 1.0f, ImageFilter::Bilinear);
+    System::Update();
+
+    TEST_ASSERT_EQUAL_UINT16(0x0000, ScreenPixel(10, 10));
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, ScreenPixel(17, 10));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(18, 10));
+    // 間は黒から白へ明るくなっていく
+    uint16_t previous = 0;
+    for (int32_t x = 10; x < 18; ++x)
+    {
+        const uint16_t pixel = ScreenPixel(x, 10);
+        TEST_ASSERT_TRUE((pixel >> 11) >= (previous >> 11));
+        previous = pixel;
+    }
+    const uint16_t middle = ScreenPixel(13, 10);
+    TEST_ASSERT_TRUE(middle != 0x0000 && middle != 0xFFFF);
+
+    // 最近傍は半分ずつ
+    System::Update();
+    Image(Edge).draw(10, 10, 4.0f, 1.0f);
+    System::Update();
+    TEST_ASSERT_EQUAL_UINT16(0x0000, ScreenPixel(13, 10));
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, ScreenPixel(14, 10));
+}
+
+void test_bilinear_keeps_uniform_color()
+{
+    System::Update();
+    Image(Solid).draw(20, 20, 2.5f, ImageFilter::Bilinear);
+    System::Update();
+
+    for (int32_t y = 0; y < 8; ++y)
+    {
+        for (int32_t x = 0; x < 8; ++x)
+        {
+            TEST_ASSERT_EQUAL_UINT16(0xFD20, ScreenPixel(20 + x, 20 + y));
+        }
+    }
+}
+
+void test_canvas_and_flash_scale_the_same()
+{
+    const Image flash(g_patternData);
+    const ImageFilter filters[] = {ImageFilter::Nearest, ImageFilter::Bilinear};
+    for (ImageFilter filter : filters)
+    {
+        System::Update();
+        flash.draw(0, 0, 3.5f, 2.0f, filter);
+        System::Update();
+        const std::vector<uint16_t> expected = Host::CaptureScreen();
+
+        System::Update();
+        g_patternCanvas.draw(0, 0, 3.5f, 2.0f, filter);
+        System::Update();
+        TEST_ASSERT_TRUE(expected == Host::CaptureScreen());
+    }
+}
+
+void test_cache_reuses_scaled_image()
+{
+    const Image flash(g_patternData);
+    System::Update();
+    flash.draw(30, 30, 4.0f, ImageFilter::Bilinear);
+    System::Update();
+    const std::vector<uint16_t> direct = Host::CaptureScreen();
+
+    ScaledImageCache::SetBudget(8 * 1024);
+    const ScaledImageCacheStats before = ScaledImageCache::Stats();
+    for (int32_t i = 0; i < 3; ++i)
+    {
+        System::Update();
+        flash.draw(30, 30, 4.0f, ImageFilter::Bilinear);
+        System::Update();
+        TEST_ASSERT_TRUE(direct == Host::CaptureScreen());
+    }
+    const ScaledImageCacheStats &after = ScaledImageCache::Stats();
+    TEST_ASSERT_EQUAL_UINT32(before.misses + 1, after.misses);
+    TEST_ASSERT_EQUAL_UINT32(before.hits + 2, after.hits);
+    TEST_ASSERT_EQUAL_UINT32(1, ScaledImageCache::Count());
+    TEST_ASSERT_EQUAL_UINT32(20 * 16 * 2, ScaledImageCache::UsedBytes());
+
+    // 大きさやフィルタが変われば別の項目
+    System::Update();
+    flash.draw(30, 30, 4.0f);
+    System::Update();
+    TEST_ASSERT_EQUAL_UINT32(2, ScaledImageCache::Count());
+}
+
+void test_cache_evicts_least_recently_used()
+{
+    // 160 + 108 バイトの 2 つは入るが、120 バイトの 3 つ目を入れるには 1 つ解放する
+    ScaledImageCache::SetBudget(300);
+    const Image flash(g_patternData);
+    const Image solid(Solid);
+    const Image edge(Edge);
+
+    System::Update();
+    flash.draw(0, 0, 2.0f);
+    solid.draw(20, 0, 3.0f, 2.0f);
+    System::Update();
+    System::Update();
+    flash.draw(0, 0, 2.0f);
+    System::Update();
+
+    const uint32_t evictions = ScaledImageCache::Stats().evictions;
+    System::Update();
+    edge.draw(40, 0, 5.0f, 6.0f);
+    System::Update();
+    TEST_ASSERT_EQUAL_UINT32(evictions + 1, ScaledImageCache::Stats().evictions);
+    TEST_ASSERT_EQUAL_UINT32(160 + 120, ScaledImageCache::UsedBytes());
+
+    // 最後に使ったほうは残っている
+    const uint32_t hits = ScaledImageCache::Stats().hits;
+    System::Update();
+    flash.draw(0, 0, 2.0f);
+    System::Update();
+    TEST_ASSERT_EQUAL_UINT32(hits + 1, ScaledImageCache::Stats().hits);
+}
+
+void test_cache_keeps_entries_used_this_frame()
+{
+    // 1 つだけ入る上限で、同じフレームに 2 つ描く
+    ScaledImageCache::SetBudget(200);
+    const Image flash(g_patternData);
+    const Image solid(Solid);
+    const uint32_t evictions = ScaledImageCache::Stats().evictions;
+
+    System::Update();
+    flash.draw(0, 0, 2.0f);
+    solid.draw(20, 0, 3.0f, 2.0f);
+    System::Update();
+    TEST_ASSERT_EQUAL_UINT32(1, ScaledImageCache::Count());
+    TEST_ASSERT_EQUAL_UINT32(evictions, ScaledImageCache::Stats().evictions);
+
+    // 入らなかったほうは直接描画している
+    TEST_ASSERT_EQUAL_UINT16(0xFD20, ScreenPixel(20, 0));
+    TEST_ASSERT_EQUAL_UINT16(0xFD20, ScreenPixel(28, 5));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(29, 5));
+}
+
+void test_banded_matches_full()
+{
+    ScaledImageCache::SetBudget(16 * 1024);
+    Host::CheckBandedMatchesFull(ScenePattern);
+}
+
+int main()
+{
+    System::Init();
+    for (int32_t y = 0; y < 4; ++y)
+    {
+        for (int32_t x = 0; x < 5; ++x)
+        {
+            g_patternPixels.push_back(Color::SwapBytes(Color(uint8_t(x * 60), uint8_t(y * 80), 200).toRGB565()));
+        }
+    }
+    g_patternData = ImageData::RGB565(5, 4, g_patternPixels.data());
+    g_patternAtlas.add(g_patternData);
+    g_patternAtlas.build(5);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_bilinear_keeps_corners_and_blends);
+    RUN_TEST(test_bilinear_keeps_uniform_color);
+    RUN_TEST(test_canvas_and_flash_scale_the_same);
+    RUN_TEST(test_cache_reuses_scaled_image);
+    RUN_TEST(test_cache_evicts_least_recently_used);
+    RUN_TEST(test_cache_keeps_entries_used_this_frame);
+    RUN_TEST(test_banded_matches_full);
+    return UNITY_END();
+}
@@ -0,0 +1,224 @@
+#include <unity.h>
+#include <stdint.h>
+#include <vector>
+#include "M5Siv3D/SwapChain.h"
+
+// 転送に時間のかかるディスプレイの代役
+// 転送は完了した時点のバッファの内容で画面に反映されるので、
+// 転送中のバッファに描画するとその内容が画面に混ざる (実機の DMA と同じ)
+namespace
+{
+    uint64_t g_now = 0;
+
+    struct StandInDisplay
+    {
+        uint64_t transferMicros = 12000;
+        bool inFlight = false;
+        uint64_t completeAt = 0;
+        const uint16_t *source = nullptr;
+        size_t pixels = 0;
+        int writeDepth = 0;
+        uint64_t waitedMicros = 0;
+        std::vector<std::vector<uint16_t>> shown;
+
+        void startWrite() { ++writeDepth; }
+        void endWrite() { --writeDepth; }
+
+        void pushImageDMA(int32_t, int32_t, int32_t w, int32_t h, const uint16_t *data)
+        {
+            waitDMA();
+            inFlight = true;
+            source = data;
+            pixels = size_t(w) * size_t(h);
+            completeAt = g_now + transferMicros;
+        }
+
+        void waitDMA()
+        {
+            if (!inFlight)
+            {
+                return;
+            }
+            if (g_now < completeAt)
+            {
+                waitedMicros += completeAt - g_now;
+                g_now = completeAt;
+            }
+            shown.emplace_back(source, source + pixels);
+            inFlight = false;
+        }
+    };
+
+    struct StandInCanvas
+    {
+        explicit StandInCanvas(StandInDisplay *) {}
+
+        void setColorDepth(int) {}
+
+        void *createSprite(int32_t w, int32_t h)
+        {
+            m_width = w;
+            m_height = h;
+            m_pixels.assign(size_t(w) * size_t(h), 0);
+            return m_pixels.data();
+        }
+
+        void deleteSprite()
+        {
+            m_pixels.clear();
+            m_width = m_height = 0;
+        }
+
+        void *getBuffer() { return m_pixels.empty() ? nullptr : m_pixels.data(); }
+        int32_t width() const { return m_width; }
+        int32_t height() const { return m_height; }
+
+        void fill(uint16_t value)
+        {
+            for (auto &p : m_pixels)
+            {
+                p = value;
+            }
+        }
+
+        std::vector<uint16_t> m_pixels;
+        int32_t m_width = 0;
+        int32_t m_height = 0;
+    };
+
+    using StandInSwapChain = SwapChain<StandInCanvas, StandInDisplay, uint16_t>;
+
+    // 1 フレーム分の描画 (描画時間を模擬する)
+    void drawFrame(StandInSwapChain &chain, uint16_t value, uint64_t drawMicros)
+    {
+        chain.back().fill(value);
+        g_now += drawMicros;
+    }
+}
+
+void setUp()
+{
+    g_now = 0;
+}
+
+void tearDown() {}
+
+void test_back_buffer_alternates()
+{
+    StandInDisplay display;
+    StandInSwapChain chain(&display);
+    TEST_ASSERT_TRUE(chain.create(8, 4));
+    TEST_ASSERT_EQUAL(0, display.writeDepth);
+
+    void *first = chain.back().getBuffer();
+    chain.present();
+    void *second = chain.back().getBuffer();
+    chain.present();
+
+    TEST_ASSERT_TRUE(first != second);
+    TEST_ASSERT_EQUAL_PTR(first, chain.back().getBuffer());
+    TEST_ASSERT_EQUAL_UINT32(2, chain.getPresentCount());
+
+    chain.release();
+    TEST_ASSERT_EQUAL(0, display.writeDepth);
+}
+
+void test_back_buffer_is_never_in_flight()
+{
+    StandInDisplay display;
+    StandInSwapChain chain(&display);
+    TEST_ASSERT_TRUE(chain.create(8, 4));
+
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        drawFrame(chain, uint16_t(frame), 3000);
+        chain.present();
+        TEST_ASSERT_TRUE(display.inFlight);
+        TEST_ASSERT_TRUE(chain.back().getBuffer() != display.source);
+    }
+}
+
+void test_transaction_is_open_only_while_transferring()
+{
+    // 転送していない間は、バスを共有する SD カードなどが使えるようにトランザクションを閉じておく
+    StandInDisplay display;
+    StandInSwapChain chain(&display);
+    TEST_ASSERT_TRUE(chain.create(8, 4));
+    TEST_ASSERT_FALSE(chain.isWriting());
+
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        drawFrame(chain, uint16_t(frame), 3000);
+        chain.present();
+        TEST_ASSERT_EQUAL(1, display.writeDepth);
+    }
+
+    chain.fence();
+    TEST_ASSERT_FALSE(display.inFlight);
+    TEST_ASSERT_EQUAL(0, display.writeDepth);
+    TEST_ASSERT_FALSE(chain.isWriting());
+
+    // 転送中に解放しても閉じる
+    chain.present();
+    chain.release();
+    TEST_ASSERT_EQUAL(0, display.writeDepth);
+}
+
+void test_frames_arrive_intact_while_next_frame_is_drawn()
+{
+    StandInDisplay display;
+    StandInSwapChain chain(&display);
+    TEST_ASSERT_TRUE(chain.create(8, 4));
+
+    const int frames = 6;
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        drawFrame(chain, uint16_t(100 + frame), 5000);
+        chain.present();
+    }
+    chain.fence();
+
+    TEST_ASSERT_EQUAL(frames, int(display.shown.size()));
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        for (uint16_t p : display.shown[frame])
+        {
+            TEST_ASSERT_EQUAL_UINT16(100 + frame, p);
+        }
+    }
+}
+
+void test_transfer_overlaps_drawing()
+{
+    StandInDisplay display;
+    display.transferMicros = 12000;
+    StandInSwapChain chain(&display);
+    TEST_ASSERT_TRUE(chain.create(8, 4));
+
+    const int frames = 20;
+    const uint64_t drawMicros = 10000;
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        drawFrame(chain, uint16_t(frame), drawMicros);
+        chain.present();
+    }
+    chain.fence();
+
+    // 逐次処理なら (描画 + 転送) × フレーム数かかるところ、
+    // 重ねて処理すれば 1 フレームあたり max(描画, 転送) に近づく
+    const uint64_t serial = frames * (drawMicros + display.transferMicros);
+    const uint64_t overlapped = frames * display.transferMicros + drawMicros;
+    TEST_ASSERT_TRUE(g_now < serial);
+    TEST_ASSERT_EQUAL_UINT64(overlapped, g_now);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_back_buffer_alternates);
+    RUN_TEST(test_back_buffer_is_never_in_flight);
+    RUN_TEST(test_transaction_is_open_only_while_transferring);
+    RUN_TEST(test_frames_arrive_intact_while_next_frame_is_drawn);
+    RUN_TEST(test_transfer_overlaps_drawing);
+    return UNITY_END();
+}
@@ -0,0 +1,201 @@
+#include <unity.h>
+#include <vector>
+#include "M5Siv3D.h"
+#include "M5Siv3D/Host/TestSupport.h"
+
+// 画像の一部の描画 (Image::drawRegion) と TextureAtlas
+namespace
+{
+    // 単色の画像 (幅 w、高さ h、色 color) を作る
+    struct SolidImage
+    {
+        std::vector<uint16_t> pixels;
+        ImageData data;
+
+        SolidImage(int32_t w, int32_t h, const Color &color)
+            : pixels(size_t(w * h), Color::SwapBytes(color.toRGB565())), data(ImageData::RGB565(w, h, pixels.data())) {}
+    };
+
+    // 各画素の色が位置で決まる 8x6 の画像
+    uint16_t PatternPixel(int32_t x, int32_t y)
+    {
+        return Color(uint8_t(x * 30), uint8_t(y * 40), 100).toRGB565();
+    }
+
+    uint16_t ScreenPixel(int32_t x, int32_t y)
+    {
+        M5.Display.waitDMA();
+        return uint16_t(M5.Display.readPixel(x, y));
+    }
+
+    // 模様の画像 (1 枚だけ詰めたアトラスの画像はキャンバスを持つ Image)
+    std::vector<uint16_t> g_patternPixels;
+    TextureAtlas g_patternAtlas;
+    const Image &g_pattern = g_patternAtlas.image();
+
+    void ScenePattern()
+    {
+        g_pattern.drawRegion(10, 10, 2, 1, 4, 3);
+        g_pattern.drawRegion(200, 100, ImageRegion(0, 0, 8, 6));
+        // 画像と画面の両方の外に出る領域
+        g_pattern.drawRegion(-1, 236, ImageRegion(-2, 3, 6, 10));
+    }
+}
+
+void setUp()
+{
+    System::SetPresentMode(PresentMode::Full);
+    System::SetBackgroundColor(Palette::Black);
+}
+
+void tearDown()
+{
+    System::SetPresentMode(PresentMode::Full);
+    System::SetBackgroundColor(Palette::Black);
+}
+
+void test_draw_region_copies_sub_rectangle()
+{
+    System::Update();
+    g_pattern.drawRegion(10, 10, 2, 1, 4, 3);
+    System::Update();
+
+    for (int32_t y = 0; y < 3; ++y)
+    {
+        for (int32_t x = 0; x < 4; ++x)
+        {
+            TEST_ASSERT_EQUAL_UINT16(PatternPixel(2 + x, 1 + y), ScreenPixel(10 + x, 10 + y));
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(14, 10));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(10, 13));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(9, 10));
+}
+
+void test_region_outside_image_is_clamped()
+{
+    System::Update();
+    // 画像の左上の外から始まる領域は、画像の中の部分だけを本来の位置に描く
+    g_pattern.drawRegion(50, 50, ImageRegion(-2, -1, 5, 4));
+    System::Update();
+
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(51, 50));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(50, 51));
+    TEST_ASSERT_EQUAL_UINT16(PatternPixel(0, 0), ScreenPixel(52, 51));
+    TEST_ASSERT_EQUAL_UINT16(PatternPixel(2, 2), ScreenPixel(54, 53));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(55, 53));
+}
+
+void test_pack_places_regions_without_overlap()
+{
+    std::vector<ImageRegion> regions;
+    const int32_t sizes[][2] = {{30, 10}, {50, 40}, {20, 20}, {64, 5}, {10, 30}, {40, 40}, {8, 8}, {25, 12}};
+    for (const auto &size : sizes)
+    {
+        regions.push_back(ImageRegion(0, 0, size[0], size[1]));
+    }
+    const int32_t height = TextureAtlas::Pack(regions, 64);
+    TEST_ASSERT_TRUE(height > 0);
+
+    int32_t area = 0;
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+        const ImageRegion &a = regions[i];
+        TEST_ASSERT_TRUE(a.x >= 0 && a.y >= 0 && a.x + a.w <= 64 && a.y + a.h <= height);
+        area += a.w * a.h;
+        for (size_t j = i + 1; j < regions.size(); ++j)
+        {
+            const ImageRegion &b = regions[j];
+            TEST_ASSERT_FALSE(a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h);
+        }
+    }
+    // 棚詰めの無駄は全体の半分未満
+    TEST_ASSERT_TRUE(area * 2 > 64 * height);
+
+    std::vector<ImageRegion> tooWide(1, ImageRegion(0, 0, 65, 1));
+    TEST_ASSERT_EQUAL_INT32(-1, TextureAtlas::Pack(tooWide, 64));
+}
+
+void test_atlas_draws_each_image()
+{
+    const SolidImage red(12, 20, Palette::Red), green(30, 8, Palette::Green), blue(16, 16, Palette::Blue);
+    TextureAtlas atlas;
+    const size_t r = atlas.add(red.data);
+    const size_t g = atlas.add(green.data);
+    const size_t b = atlas.add(blue.data);
+    TEST_ASSERT_TRUE(atlas.build(32));
+    TEST_ASSERT_EQUAL_UINT32(3, atlas.size());
+    TEST_ASSERT_TRUE(atlas.image().width() <= 32);
+    TEST_ASSERT_EQUAL_INT32(30, atlas[g].width());
+    TEST_ASSERT_TRUE(atlas[5].isEmpty());
+
+    System::Update();
+    atlas[r].draw(10, 10);
+    atlas[g].draw(40, 10);
+    atlas[b].draw(100, 10);
+    System::Update();
+
+    TEST_ASSERT_EQUAL_UINT16(Palette::Red.toRGB565(), ScreenPixel(10, 10));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Red.toRGB565(), ScreenPixel(21, 29));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(22, 10));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(10, 30));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Green.toRGB565(), ScreenPixel(69, 17));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(40, 18));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Blue.toRGB565(), ScreenPixel(115, 25));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(116, 25));
+
+    // 2 回目の build() はしない
+    TEST_ASSERT_FALSE(atlas.build());
+}
+
+void test_prebuilt_atlas_uses_region_table()
+{
+    // tools/image_to_rgb565.py --atlas の出力と同じ形 (左半分が赤、右半分が青)
+    static uint16_t pixels[8 * 4];
+    for (int32_t i = 0; i < 8 * 4; ++i)
+    {
+        pixels[i] = Color::SwapBytes((i % 8 < 4) ? Palette::Red.toRGB565() : Palette::Blue.toRGB565());
+    }
+    static const ImageData sheet = ImageData::RGB565(8, 4, pixels);
+    static const ImageRegion regions[] = {ImageRegion(0, 0, 4, 4), ImageRegion(4, 0, 4, 4)};
+    const TextureAtlas atlas(sheet, regions, 2);
+
+    System::Update();
+    atlas[1].draw(0, 0);
+    atlas[0].draw(10, 0);
+    System::Update();
+
+    TEST_ASSERT_EQUAL_UINT16(Palette::Blue.toRGB565(), ScreenPixel(0, 0));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Blue.toRGB565(), ScreenPixel(3, 3));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(4, 0));
+    TEST_ASSERT_EQUAL_UINT16(Palette::Red.toRGB565(), ScreenPixel(13, 3));
+}
+
+void test_banded_matches_full()
+{
+    Host::CheckBandedMatchesFull(ScenePattern);
+}
+
+int main()
+{
+    System::Init();
+    for (int32_t y = 0; y < 6; ++y)
+    {
+        for (int32_t x = 0; x < 8; ++x)
+        {
+            g_patternPixels.push_back(Color::SwapBytes(PatternPixel(x, y)));
+        }
+    }
+    const ImageData pattern = ImageData::RGB565(8, 6, g_patternPixels.data());
+    g_patternAtlas.add(pattern);
+    g_patternAtlas.build(8);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_draw_region_copies_sub_rectangle);
+    RUN_TEST(test_region_outside_image_is_clamped);
+    RUN_TEST(test_pack_places_regions_without_overlap);
+    RUN_TEST(test_atlas_draws_each_image);
+    RUN_TEST(test_prebuilt_atlas_uses_region_table);
+    RUN_TEST(test_banded_matches_full);
+    return UNITY_END();
+}
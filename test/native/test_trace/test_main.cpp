@@ -0,0 +1,207 @@
+#define M5SIV3D_ENABLE_PROFILING
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "M5Siv3D.h"
+
+// 区間計測のリングバッファ (TraceBuffer) とバイナリのダンプ形式
+namespace
+{
+    Host::Clock &virtualClock()
+    {
+        return Host::Clock::getInstance();
+    }
+
+    // ダンプを読み戻した内容
+    struct ParsedEvent
+    {
+        uint16_t nameIndex;
+        uint8_t core;
+        uint32_t beginMicros;
+        uint32_t durationMicros;
+    };
+
+    struct ParsedDump
+    {
+        uint8_t version;
+        std::vector<std::string> names;
+        std::vector<ParsedEvent> events;
+        size_t bytes;
+    };
+
+    class Reader
+    {
+    public:
+        explicit Reader(const std::vector<uint8_t> &data) : m_data(data) {}
+
+        uint8_t u8()
+        {
+            TEST_ASSERT_TRUE(m_pos < m_data.size());
+            return m_data[m_pos++];
+        }
+
+        uint16_t u16()
+        {
+            const uint16_t low = u8();
+            return uint16_t(low | (u8() << 8));
+        }
+
+        uint32_t u32()
+        {
+            const uint32_t low = u16();
+            return low | (uint32_t(u16()) << 16);
+        }
+
+        size_t position() const { return m_pos; }
+
+    private:
+        const std::vector<uint8_t> &m_data;
+        size_t m_pos = 0;
+    };
+
+    ParsedDump Dump()
+    {
+        Host::MemoryStream stream;
+        TraceBuffer::Dump(stream);
+
+        Reader reader(stream.data());
+        ParsedDump dump;
+        TEST_ASSERT_EQUAL_UINT8('M', reader.u8());
+        TEST_ASSERT_EQUAL_UINT8('5', reader.u8());
+        TEST_ASSERT_EQUAL_UINT8('T', reader.u8());
+        TEST_ASSERT_EQUAL_UINT8('R', reader.u8());
+        dump.version = reader.u8();
+        TEST_ASSERT_EQUAL_UINT8(0, reader.u8());
+        const uint16_t nameCount = reader.u16();
+        for (uint16_t i = 0; i < nameCount; ++i)
+        {
+            std::string name;
+            const uint8_t length = reader.u8();
+            for (uint8_t c = 0; c < length; ++c)
+            {
+                name += char(reader.u8());
+            }
+            dump.names.push_back(name);
+        }
+        const uint32_t eventCount = reader.u32();
+        for (uint32_t i = 0; i < eventCount; ++i)
+        {
+            ParsedEvent event;
+            event.nameIndex = reader.u16();
+            event.core = reader.u8();
+            TEST_ASSERT_EQUAL_UINT8(0, reader.u8());
+            event.beginMicros = reader.u32();
+            event.durationMicros = reader.u32();
+            dump.events.push_back(event);
+        }
+        dump.bytes = reader.position();
+        TEST_ASSERT_EQUAL_UINT32(stream.data().size(), dump.bytes);
+        return dump;
+    }
+
+    const char *const OuterName = "outer";
+    const char *const InnerName = "inner";
+
+    // outer の中に inner を入れ子にした 1 組 (inner が先に終わるので先に記録される)
+    void RecordNested(uint32_t innerMicros)
+    {
+        M5SIV3D_PROFILE_SCOPE(OuterName);
+        virtualClock().advanceMicros(10);
+        {
+            M5SIV3D_PROFILE_SCOPE(InnerName);
+            virtualClock().advanceMicros(innerMicros);
+        }
+        virtualClock().advanceMicros(3);
+    }
+}
+
+void setUp()
+{
+    virtualClock().setVirtual(true);
+    TraceBuffer::SetEnabled(true);
+    TraceBuffer::getInstance().clear();
+}
+
+void tearDown() {}
+
+void test_nested_scopes_are_dumped_in_end_order()
+{
+    const uint32_t start = micros();
+    RecordNested(5);
+    TEST_ASSERT_EQUAL_UINT32(2, TraceBuffer::getInstance().size());
+
+    const ParsedDump dump = Dump();
+    TEST_ASSERT_EQUAL_UINT8(TraceBuffer::FormatVersion, dump.version);
+    TEST_ASSERT_EQUAL_UINT32(2, dump.names.size());
+    TEST_ASSERT_EQUAL_STRING(InnerName, dump.names[0].c_str());
+    TEST_ASSERT_EQUAL_STRING(OuterName, dump.names[1].c_str());
+
+    TEST_ASSERT_EQUAL_UINT32(2, dump.events.size());
+    TEST_ASSERT_EQUAL_UINT16(0, dump.events[0].nameIndex);
+    TEST_ASSERT_EQUAL_UINT8(0, dump.events[0].core);
+    TEST_ASSERT_EQUAL_UINT32(start + 10, dump.events[0].beginMicros);
+    TEST_ASSERT_EQUAL_UINT32(5, dump.events[0].durationMicros);
+    TEST_ASSERT_EQUAL_UINT16(1, dump.events[1].nameIndex);
+    TEST_ASSERT_EQUAL_UINT32(start, dump.events[1].beginMicros);
+    TEST_ASSERT_EQUAL_UINT32(18, dump.events[1].durationMicros);
+}
+
+void test_wraparound_keeps_newest_events_in_order()
+{
+    // 容量を 10 件 (5 組) 超えるまで記録する
+    const uint32_t pairs = TraceBuffer::Capacity / 2 + 5;
+    const uint32_t start = micros();
+    for (uint32_t i = 0; i < pairs; ++i)
+    {
+        RecordNested(i);
+    }
+    TEST_ASSERT_EQUAL_UINT32(TraceBuffer::Capacity, TraceBuffer::getInstance().size());
+
+    const ParsedDump dump = Dump();
+    TEST_ASSERT_EQUAL_UINT32(2, dump.names.size());
+    TEST_ASSERT_EQUAL_UINT32(TraceBuffer::Capacity, dump.events.size());
+
+    // 古い 5 組は上書きされ、残りは記録した順に並ぶ
+    uint32_t begin = start;
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        begin += 10 + i + 3;
+    }
+    for (uint32_t i = 5; i < pairs; ++i)
+    {
+        const ParsedEvent &inner = dump.events[(i - 5) * 2];
+        const ParsedEvent &outer = dump.events[(i - 5) * 2 + 1];
+        TEST_ASSERT_EQUAL_STRING(InnerName, dump.names[inner.nameIndex].c_str());
+        TEST_ASSERT_EQUAL_UINT32(begin + 10, inner.beginMicros);
+        TEST_ASSERT_EQUAL_UINT32(i, inner.durationMicros);
+        TEST_ASSERT_EQUAL_STRING(OuterName, dump.names[outer.nameIndex].c_str());
+        TEST_ASSERT_EQUAL_UINT32(begin, outer.beginMicros);
+        TEST_ASSERT_EQUAL_UINT32(10 + i + 3, outer.durationMicros);
+        begin += 10 + i + 3;
+    }
+}
+
+void test_disabled_buffer_records_nothing()
+{
+    TraceBuffer::SetEnabled(false);
+    RecordNested(1);
+    TraceBuffer::SetEnabled(true);
+    TEST_ASSERT_EQUAL_UINT32(0, TraceBuffer::getInstance().size());
+
+    // 空のダンプも形式どおり
+    const ParsedDump dump = Dump();
+    TEST_ASSERT_EQUAL_UINT32(0, dump.names.size());
+    TEST_ASSERT_EQUAL_UINT32(0, dump.events.size());
+    TEST_ASSERT_EQUAL_UINT32(8 + 4, dump.bytes);
+}
+
+int main()
+{
+    System::Init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_nested_scopes_are_dumped_in_end_order);
+    RUN_TEST(test_wraparound_keeps_newest_events_in_order);
+    RUN_TEST(test_disabled_buffer_records_nothing);
+    return UNITY_END();
+}
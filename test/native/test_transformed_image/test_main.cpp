@@ -0,0 +1,186 @@
+#include <unity.h>
+#include <vector>
+#include "M5Siv3D.h"
+#include "M5Siv3D/Host/TestSupport.h"
+
+// 回転・変換した画像の描画 (Image::draw(Mat3x2) / drawRotated / drawRotatedAt)
+namespace
+{
+    constexpr uint16_t Red = 0x00F8; // 0xF800 (バイトを入れ替えた値)
+
+    // 10x2 の針
+    M5SIV3D_INLINE_CONSTEXPR uint16_t NeedlePixels[] = {
+        Red, Red, Red, Red, Red, Red, Red, Red, Red, Red,
+        Red, Red, Red, Red, Red, Red, Red, Red, Red, Red,
+    };
+    M5SIV3D_INLINE_CONSTEXPR ImageData Needle = ImageData::RGB565(10, 2, NeedlePixels);
+
+    // 各画素の色が位置で決まる 6x4 の画像を 3 つの形式とキャンバスで持つ
+    constexpr int32_t PatternWidth = 6;
+    constexpr int32_t PatternHeight = 4;
+    std::vector<uint16_t> g_patternPixels;
+    std::vector<uint8_t> g_patternIndices;
+    std::vector<uint16_t> g_patternPalette;
+    std::vector<uint16_t> g_patternRuns;
+    std::vector<uint32_t> g_patternRows;
+    ImageData g_patternRGB565 = ImageData::RGB565(0, 0, nullptr);
+    ImageData g_patternIndexed = ImageData::RGB565(0, 0, nullptr);
+    ImageData g_patternRLE = ImageData::RGB565(0, 0, nullptr);
+    TextureAtlas g_patternAtlas;
+    const Image &g_patternCanvas = g_patternAtlas.image();
+
+    uint16_t PatternPixel(int32_t x, int32_t y)
+    {
+        return Color(uint8_t(x * 40), uint8_t(y * 60), 120).toRGB565();
+    }
+
+    uint16_t ScreenPixel(int32_t x, int32_t y)
+    {
+        M5.Display.waitDMA();
+        return uint16_t(M5.Display.readPixel(x, y));
+    }
+
+    void ScenePattern()
+    {
+        const Image pattern(g_patternRGB565);
+        pattern.drawRotated(40, 40, 0.5f);
+        pattern.drawRotatedAt(160, 120, 3.0f, 2.0f, -1.2f, 8.0f, ImageFilter::Bilinear);
+        g_patternCanvas.draw(Math::Mat3x2(4.0f, 1.0f, 2.0f, 5.0f, 200.0f, 20.0f), ImageFilter::Bilinear);
+        // 画面の端で切れる位置
+        g_patternCanvas.drawRotatedAt(318, 238, 3.0f, 2.0f, 2.0f, 6.0f);
+    }
+}
+
+void setUp()
+{
+    System::SetPresentMode(PresentMode::Full);
+    System::SetBackgroundColor(Palette::Black);
+}
+
+void tearDown()
+{
+    System::SetPresentMode(PresentMode::Full);
+    System::SetBackgroundColor(Palette::Black);
+}
+
+void test_rotate_quarter_turn()
+{
+    // 時計回りに 90 度回すと、画像の (u, v) は (高さ - 1 - v, u) に移る
+    const Image pattern(g_patternRGB565);
+    System::Update();
+    pattern.draw(Math::Mat3x2::Rotate(Math::HalfPi) * Math::Mat3x2::Translate(20.0f + PatternHeight, 20.0f));
+    System::Update();
+
+    for (int32_t y = 0; y < PatternWidth; ++y)
+    {
+        for (int32_t x = 0; x < PatternHeight; ++x)
+        {
+            TEST_ASSERT_EQUAL_UINT16(PatternPixel(y, PatternHeight - 1 - x), ScreenPixel(20 + x, 20 + y));
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(19, 20));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(20 + PatternHeight, 20));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(20, 20 + PatternWidth));
+}
+
+void test_translation_and_scale_match_plain_draw()
+{
+    const Image pattern(g_patternRGB565);
+    System::Update();
+    pattern.draw(30, 10);
+    pattern.draw(60, 10, 3.0f, 2.0f);
+    System::Update();
+    const std::vector<uint16_t> expected = Host::CaptureScreen();
+
+    System::Update();
+    pattern.draw(Math::Mat3x2::Translate(30.0f, 10.0f));
+    pattern.draw(Math::Mat3x2::Scale(3.0f, 2.0f) * Math::Mat3x2::Translate(60.0f, 10.0f));
+    System::Update();
+    TEST_ASSERT_TRUE(expected == Host::CaptureScreen());
+}
+
+void test_pivot_is_placed_at_position()
+{
+    // 左端の中央を (100, 100) に置いて、下向きに回す
+    System::Update();
+    Image(Needle).drawRotatedAt(100.0f, 100.0f, 0.0f, 1.0f, Math::HalfPi);
+    System::Update();
+
+    TEST_ASSERT_EQUAL_UINT16(0xF800, ScreenPixel(99, 100));
+    TEST_ASSERT_EQUAL_UINT16(0xF800, ScreenPixel(100, 109));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(98, 105));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(101, 105));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(100, 99));
+    TEST_ASSERT_EQUAL_UINT16(0, ScreenPixel(100, 110));
+}
+
+void test_formats_and_canvas_rotate_the_same()
+{
+    const Image images[] = {Image(g_patternRGB565), Image(g_patternIndexed), Image(g_patternRLE)};
+    const ImageFilter filters[] = {ImageFilter::Nearest, ImageFilter::Bilinear};
+    for (ImageFilter filter : filters)
+    {
+        System::Update();
+        g_patternCanvas.drawRotatedAt(80.0f, 80.0f, 3.0f, 2.0f, 0.7f, 9.0f, filter);
+        System::Update();
+        const std::vector<uint16_t> expected = Host::CaptureScreen();
+        TEST_ASSERT_TRUE(ScreenPixel(80, 80) != 0);
+
+        for (const Image &image : images)
+        {
+            System::Update();
+            image.drawRotatedAt(80.0f, 80.0f, 3.0f, 2.0f, 0.7f, 9.0f, filter);
+            System::Update();
+            TEST_ASSERT_TRUE(expected == Host::CaptureScreen());
+        }
+    }
+}
+
+void test_singular_transform_draws_nothing()
+{
+    System::Update();
+    const Image pattern(g_patternRGB565);
+    pattern.draw(Math::Mat3x2::Scale(0.0f, 4.0f) * Math::Mat3x2::Translate(50.0f, 50.0f));
+    System::Update();
+
+    const std::vector<uint16_t> screen = Host::CaptureScreen();
+    TEST_ASSERT_TRUE(screen == std::vector<uint16_t>(screen.size(), 0));
+}
+
+void test_banded_matches_full()
+{
+    Host::CheckBandedMatchesFull(ScenePattern);
+}
+
+int main()
+{
+    System::Init();
+    // 同じ画像を RGB565・パレット (各画素が別の色)・RLE (1 画素ずつの組) で作る
+    for (int32_t y = 0; y < PatternHeight; ++y)
+    {
+        g_patternRows.push_back(uint32_t(g_patternRuns.size()));
+        for (int32_t x = 0; x < PatternWidth; ++x)
+        {
+            const uint16_t pixel = Color::SwapBytes(PatternPixel(x, y));
+            g_patternPixels.push_back(pixel);
+            g_patternIndices.push_back(uint8_t(g_patternPalette.size()));
+            g_patternPalette.push_back(pixel);
+            g_patternRuns.push_back(1);
+            g_patternRuns.push_back(pixel);
+        }
+    }
+    g_patternRGB565 = ImageData::RGB565(PatternWidth, PatternHeight, g_patternPixels.data());
+    g_patternIndexed = ImageData::Indexed8(PatternWidth, PatternHeight, g_patternIndices.data(), g_patternPalette.data());
+    g_patternRLE = ImageData::RLE(PatternWidth, PatternHeight, g_patternRuns.data(), g_patternRows.data());
+    g_patternAtlas.add(g_patternRGB565);
+    g_patternAtlas.build(PatternWidth);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_rotate_quarter_turn);
+    RUN_TEST(test_translation_and_scale_match_plain_draw);
+    RUN_TEST(test_pivot_is_placed_at_position);
+    RUN_TEST(test_formats_and_canvas_rotate_the_same);
+    RUN_TEST(test_singular_transform_draws_nothing);
+    RUN_TEST(test_banded_matches_full);
+    return UNITY_END();
+}
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Compare two M5Siv3D render benchmark results.
+
+Each input is either a JSON file or a captured test log that contains the
+"M5SIV3D_BENCH {...}" line printed by test/benchmark/test_render_benchmark:
+
+    pio test -e native-benchmark -v > current.log
+    python3 tools/bench_compare.py baseline.json current.log
+
+Use --extract to save the JSON from a log as the next baseline:
+
+    python3 tools/bench_compare.py --extract current.log > baseline.json
+
+Exits with status 1 when a case got slower than --threshold percent
+(calls per second), so it can gate CI.
+"""
+
+import argparse
+import json
+import sys
+
+TAG = "M5SIV3D_BENCH "
+
+
+def load(path):
+    with open(path, "r", errors="replace") as f:
+        text = f.read()
+
+    # a log may contain several runs; use the last one
+    for line in reversed(text.splitlines()):
+        index = line.find(TAG)
+        if index >= 0:
+            return json.loads(line[index + len(TAG):])
+    return json.loads(text)
+
+
+def compare(baseline, current, threshold):
+    base = {r["name"]: r for r in baseline["results"]}
+    regressions = []
+    rows = []
+    for result in current["results"]:
+        name = result["name"]
+        if name not in base:
+            rows.append((name, None, result["calls_per_sec"], None))
+            continue
+        before = base[name]["calls_per_sec"]
+        after = result["calls_per_sec"]
+        change = (after - before) / before * 100.0 if before else 0.0
+        rows.append((name, before, after, change))
+        if change < -threshold:
+            regressions.append(name)
+    return rows, regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("inputs", nargs="+", help="baseline and current result (JSON or log)")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="allowed slowdown in percent (default: 5)")
+    parser.add_argument("--extract", action="store_true",
+                        help="print the JSON result of a single input and exit")
+    args = parser.parse_args()
+
+    if args.extract:
+        if len(args.inputs) != 1:
+            parser.error("--extract takes exactly one input")
+        json.dump(load(args.inputs[0]), sys.stdout, indent=2)
+        sys.stdout.write("\n")
+        return 0
+
+    if len(args.inputs) != 2:
+        parser.error("expected a baseline and a current result")
+    baseline = load(args.inputs[0])
+    current = load(args.inputs[1])
+    if baseline.get("platform") != current.get("platform"):
+        print("warning: comparing %s against %s" % (baseline.get("platform"), current.get("platform")),
+              file=sys.stderr)
+
+    rows, regressions = compare(baseline, current, args.threshold)
+    width = max(len(row[0]) for row in rows)
+    print("%-*s %14s %14s %8s" % (width, "case", "baseline/s", "current/s", "change"))
+    for name, before, after, change in rows:
+        if before is None:
+            print("%-*s %14s %14.1f %8s" % (width, name, "-", after, "new"))
+        else:
+            mark = "  <-- slower" if name in regressions else ""
+            print("%-*s %14.1f %14.1f %+7.1f%%%s" % (width, name, before, after, change, mark))
+
+    if regressions:
+        print("%d case(s) slower than %.1f%%" % (len(regressions), args.threshold), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,260 @@
+#!/usr/bin/env python3
+"""Decode M5Siv3D screenshots and frame streams into PNG images.
+
+System::Screenshot() and System::StartFrameStreaming() write run-length
+compressed RGB565 frames ("M5FS" packets). Capture the serial output to a
+file and convert it:
+
+    pio device monitor --raw -b 115200 > capture.bin
+    python3 tools/frame_stream_decode.py capture.bin -o frames/
+
+or watch a device live; the latest frame is rewritten as it arrives
+(requires pyserial):
+
+    python3 tools/frame_stream_decode.py --port /dev/ttyUSB0 --latest screen.png
+
+Text printed around the packets is ignored. Delta frames only carry the
+16x16 tiles that changed, so decoding starts at the first key frame; a
+packet with a bad checksum is dropped and decoding resumes at the next key
+frame.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = b"M5FS"
+SUPPORTED_VERSION = 1
+HEADER_SIZE = 16
+KEY_FRAME = 0
+DELTA_FRAME = 1
+END_OF_TILES = 0xFFFF
+
+
+class FrameFormatError(Exception):
+    pass
+
+
+class ChecksumError(FrameFormatError):
+    pass
+
+
+class NeedMoreData(Exception):
+    pass
+
+
+class Reader:
+    def __init__(self, data, pos):
+        self.data = data
+        self.pos = pos
+
+    def take(self, size):
+        if self.pos + size > len(self.data):
+            raise NeedMoreData()
+        chunk = self.data[self.pos:self.pos + size]
+        self.pos += size
+        return chunk
+
+    def u8(self):
+        return self.take(1)[0]
+
+    def u16(self):
+        return struct.unpack("<H", self.take(2))[0]
+
+    def pixels(self, count, out, index):
+        """Decode count run-length compressed pixels into out[index:]."""
+        end = index + count
+        while index < end:
+            head = self.u8()
+            if head & 0x80:
+                length = (head & 0x7F) + 2
+                value = self.u16()
+                if index + length > end:
+                    raise FrameFormatError("run overflows the image")
+                out[index:index + length] = [value] * length
+            else:
+                length = head + 1
+                if index + length > end:
+                    raise FrameFormatError("literal overflows the image")
+                out[index:index + length] = struct.unpack("<%dH" % length, self.take(length * 2))
+            index += length
+
+
+def fletcher16(data):
+    sum1 = sum2 = 0
+    for byte in data:
+        sum1 = (sum1 + byte) % 255
+        sum2 = (sum2 + sum1) % 255
+    return (sum2 << 8) | sum1
+
+
+class Decoder:
+    """Keeps the last decoded frame so delta frames can be applied to it."""
+
+    def __init__(self):
+        self.width = 0
+        self.height = 0
+        self.pixels = None
+
+    def parse(self, data, offset):
+        """Parse one packet at offset. Returns (frame_index, type, end_offset)."""
+        reader = Reader(data, offset)
+        header = reader.take(HEADER_SIZE)
+        magic, version, frame_type, width, height, tile_size, _, frame_index = struct.unpack("<4sBBHHBBI", header)
+        if magic != MAGIC:
+            raise FrameFormatError("missing magic at offset %d" % offset)
+        if version != SUPPORTED_VERSION:
+            raise FrameFormatError("unsupported frame version %d" % version)
+        if frame_type not in (KEY_FRAME, DELTA_FRAME) or width == 0 or height == 0 or tile_size == 0:
+            raise FrameFormatError("invalid header at offset %d" % offset)
+
+        if frame_type == KEY_FRAME:
+            pixels = [0] * (width * height)
+            reader.pixels(width * height, pixels, 0)
+        else:
+            if self.pixels is None or (width, height) != (self.width, self.height):
+                raise FrameFormatError("delta frame %d without a key frame" % frame_index)
+            pixels = list(self.pixels)
+            tiles_x = (width + tile_size - 1) // tile_size
+            tile_count = tiles_x * ((height + tile_size - 1) // tile_size)
+            tile = [0] * (tile_size * tile_size)
+            while True:
+                tile_index = reader.u16()
+                if tile_index == END_OF_TILES:
+                    break
+                if tile_index >= tile_count:
+                    raise FrameFormatError("tile %d out of range" % tile_index)
+                x = (tile_index % tiles_x) * tile_size
+                y = (tile_index // tiles_x) * tile_size
+                tw = min(tile_size, width - x)
+                th = min(tile_size, height - y)
+                reader.pixels(tw * th, tile, 0)
+                for row in range(th):
+                    start = (y + row) * width + x
+                    pixels[start:start + tw] = tile[row * tw:row * tw + tw]
+
+        body_end = reader.pos
+        (checksum,) = struct.unpack("<H", reader.take(2))
+        if checksum != fletcher16(data[offset:body_end]):
+            raise ChecksumError("checksum mismatch in frame %d" % frame_index)
+
+        self.width, self.height, self.pixels = width, height, pixels
+        return frame_index, frame_type, reader.pos
+
+    def rgb(self):
+        """The current frame as 8-bit RGB rows."""
+        rows = []
+        for y in range(self.height):
+            row = bytearray(self.width * 3)
+            for x, value in enumerate(self.pixels[y * self.width:(y + 1) * self.width]):
+                r = (value >> 11) & 0x1F
+                g = (value >> 5) & 0x3F
+                b = value & 0x1F
+                row[x * 3] = (r << 3) | (r >> 2)
+                row[x * 3 + 1] = (g << 2) | (g >> 4)
+                row[x * 3 + 2] = (b << 3) | (b >> 2)
+            rows.append(bytes(row))
+        return rows
+
+
+def write_png(path, width, height, rows):
+    def chunk(kind, body):
+        data = kind + body
+        return struct.pack(">I", len(body)) + data + struct.pack(">I", zlib.crc32(data) & 0xFFFFFFFF)
+
+    raw = b"".join(b"\x00" + row for row in rows)
+    png = b"\x89PNG\r\n\x1a\n"
+    png += chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 8, 2, 0, 0, 0))
+    png += chunk(b"IDAT", zlib.compress(raw, 6))
+    png += chunk(b"IEND", b"")
+
+    # replace atomically so a viewer never sees a half-written image
+    temp = path + ".tmp"
+    with open(temp, "wb") as f:
+        f.write(png)
+    os.replace(temp, path)
+
+
+def decode(data, decoder, on_frame, log=sys.stderr):
+    """Decode every complete packet in data. Returns the number of bytes consumed."""
+    pos = 0
+    while True:
+        start = data.find(MAGIC, pos)
+        if start < 0:
+            # keep a possibly split magic for the next read
+            return max(pos, len(data) - (len(MAGIC) - 1))
+        try:
+            frame_index, frame_type, end = decoder.parse(data, start)
+        except NeedMoreData:
+            return start
+        except FrameFormatError as e:
+            print("skipping packet: %s" % e, file=log)
+            if isinstance(e, ChecksumError):
+                # later deltas would be applied to the wrong image
+                decoder.pixels = None
+            pos = start + 1
+            continue
+        on_frame(decoder, frame_index, frame_type)
+        pos = end
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", nargs="?", help="captured serial output ('-' for stdin)")
+    parser.add_argument("--port", help="read from a serial port instead (requires pyserial)")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baud rate (default: 115200)")
+    parser.add_argument("-o", "--output-dir", help="write every frame as frame_NNNNNN.png")
+    parser.add_argument("--latest", help="keep rewriting this PNG with the newest frame")
+    args = parser.parse_args()
+
+    if (args.input is None) == (args.port is None):
+        parser.error("give either a capture file or --port")
+    if not args.output_dir and not args.latest:
+        args.latest = "screenshot.png"
+    if args.output_dir:
+        os.makedirs(args.output_dir, exist_ok=True)
+
+    stats = {"frames": 0, "key": 0}
+
+    def on_frame(decoder, frame_index, frame_type):
+        stats["frames"] += 1
+        stats["key"] += frame_type == KEY_FRAME
+        rows = decoder.rgb()
+        if args.output_dir:
+            write_png(os.path.join(args.output_dir, "frame_%06d.png" % frame_index), decoder.width, decoder.height, rows)
+        if args.latest:
+            write_png(args.latest, decoder.width, decoder.height, rows)
+        if args.port:
+            print("frame %d (%s)" % (frame_index, "key" if frame_type == KEY_FRAME else "delta"), file=sys.stderr)
+
+    decoder = Decoder()
+    if args.port:
+        try:
+            import serial
+        except ImportError:
+            print("--port requires pyserial (pip install pyserial)", file=sys.stderr)
+            return 1
+        buffer = b""
+        with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+            try:
+                while True:
+                    buffer += port.read(4096)
+                    buffer = buffer[decode(buffer, decoder, on_frame):]
+            except KeyboardInterrupt:
+                pass
+    else:
+        if args.input == "-":
+            data = sys.stdin.buffer.read()
+        else:
+            with open(args.input, "rb") as f:
+                data = f.read()
+        decode(data, decoder, on_frame)
+
+    print("decoded %d frame(s), %d key frame(s)" % (stats["frames"], stats["key"]), file=sys.stderr)
+    return 0 if stats["frames"] else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
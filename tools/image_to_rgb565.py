@@ -0,0 +1,310 @@
+#!/usr/bin/env python3
+"""Convert PNG images into flash-resident M5Siv3D ImageData headers.
+
+The generated header holds constexpr arrays of pre-converted RGB565 pixels
+(in the canvas byte order), so `Image(icon)` draws straight from flash with
+no PNG decoding and no sprite in RAM:
+
+    python3 tools/image_to_rgb565.py icon.png -o src/icon.h
+
+    #include "icon.h"
+    const Image image(icon);
+
+--format picks the layout: rgb565 (2 bytes per pixel, pushed without any
+copy), indexed (1 byte per pixel plus a palette of up to 256 colours), rle
+(runs of one colour, never crossing a row) or auto (the smallest one that
+fits, the default). Transparent pixels are composited over --background.
+
+--atlas packs several images into one sheet (tallest first, onto shelves
+no wider than --max-width, the same packing as TextureAtlas::Pack) and
+also emits an ImageRegion per image plus a region table:
+
+    python3 tools/image_to_rgb565.py --atlas -n icons coin.png heart.png -o src/icons.h
+
+    const TextureAtlas atlas(icons, icons_regions, icons_count);
+    atlas[0].draw(10, 10);              // or: Image(icons).drawRegion(10, 10, icons_coin)
+
+Only the standard library is used; PNGs must be non-interlaced.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+PNG_SIGNATURE = b"\x89PNG\r\n\x1a\n"
+
+
+class PngError(Exception):
+    pass
+
+
+def read_png(data):
+    """Return (width, height, rows) with rows of (r, g, b, a) tuples."""
+    if not data.startswith(PNG_SIGNATURE):
+        raise PngError("not a PNG file")
+    pos = len(PNG_SIGNATURE)
+    width = height = None
+    palette = []
+    alphas = b""
+    idat = b""
+    while pos + 8 <= len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IHDR":
+            width, height, depth, color_type, _, _, interlace = struct.unpack(">IIBBBBB", body)
+            if interlace:
+                raise PngError("interlaced PNGs are not supported")
+        elif kind == b"PLTE":
+            palette = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+        elif kind == b"tRNS":
+            alphas = body
+        elif kind == b"IDAT":
+            idat += body
+        elif kind == b"IEND":
+            break
+    if width is None:
+        raise PngError("missing IHDR chunk")
+
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color_type]
+    bits_per_pixel = channels * depth
+    stride = (width * bits_per_pixel + 7) // 8
+    step = max(1, bits_per_pixel // 8)
+    raw = zlib.decompress(idat)
+
+    rows = []
+    previous = bytearray(stride)
+    for y in range(height):
+        offset = y * (stride + 1)
+        kind = raw[offset]
+        line = bytearray(raw[offset + 1:offset + 1 + stride])
+        for i in range(stride):
+            a = line[i - step] if i >= step else 0
+            b = previous[i]
+            c = previous[i - step] if i >= step else 0
+            if kind == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + (a + b) // 2) & 0xFF
+            elif kind == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                predictor = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                line[i] = (line[i] + predictor) & 0xFF
+        previous = line
+        rows.append(unpack_row(line, width, depth, color_type, channels, palette, alphas))
+    return width, height, rows
+
+
+def unpack_row(line, width, depth, color_type, channels, palette, alphas):
+    if depth < 8:
+        per_byte = 8 // depth
+        mask = (1 << depth) - 1
+        samples = [(line[x // per_byte] >> (8 - depth * (x % per_byte + 1))) & mask for x in range(width)]
+    elif depth == 16:
+        samples = [line[i] for i in range(0, len(line), 2)]
+    else:
+        samples = list(line)
+
+    pixels = []
+    for x in range(width):
+        s = samples[x * channels:(x + 1) * channels]
+        if color_type == 3:
+            index = s[0]
+            r, g, b = palette[index]
+            pixels.append((r, g, b, alphas[index] if index < len(alphas) else 255))
+            continue
+        if depth < 8:
+            s = [v * 255 // ((1 << depth) - 1) for v in s]
+        if color_type == 0:
+            pixels.append((s[0], s[0], s[0], 255))
+        elif color_type == 4:
+            pixels.append((s[0], s[0], s[0], s[1]))
+        elif color_type == 2:
+            pixels.append((s[0], s[1], s[2], 255))
+        else:
+            pixels.append(tuple(s))
+    return pixels
+
+
+def to_rgb565(pixel, background):
+    r, g, b, a = pixel
+    r = (r * a + background[0] * (255 - a) + 127) // 255
+    g = (g * a + background[1] * (255 - a) + 127) // 255
+    b = (b * a + background[2] * (255 - a) + 127) // 255
+    value = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+    # canvas byte order (high and low bytes swapped)
+    return ((value >> 8) | (value << 8)) & 0xFFFF
+
+
+def encode_rle(rows):
+    runs = []
+    offsets = []
+    for row in rows:
+        offsets.append(len(runs))
+        x = 0
+        while x < len(row):
+            end = x + 1
+            while end < len(row) and row[end] == row[x] and end - x < 0xFFFF:
+                end += 1
+            runs += [end - x, row[x]]
+            x = end
+    return runs, offsets
+
+
+def sizes(rows, width, height):
+    """Bytes of flash each format would use (None when it does not fit)."""
+    colors = set(c for row in rows for c in row)
+    runs, _ = encode_rle(rows)
+    return {
+        "rgb565": width * height * 2,
+        "indexed": width * height + len(colors) * 2 if len(colors) <= 256 else None,
+        "rle": len(runs) * 2 + height * 4,
+    }
+
+
+def format_array(ctype, name, values, per_line, digits):
+    lines = []
+    for i in range(0, len(values), per_line):
+        chunk = values[i:i + per_line]
+        if digits:
+            lines.append("    " + ", ".join("0x%0*X" % (digits, v) for v in chunk) + ",")
+        else:
+            lines.append("    " + ", ".join(str(v) for v in chunk) + ",")
+    return "M5SIV3D_INLINE_CONSTEXPR %s %s[] = {\n%s\n};\n" % (ctype, name, "\n".join(lines))
+
+
+def generate(name, source, width, height, rows, fmt):
+    out = ["// Generated by tools/image_to_rgb565.py from %s (%dx%d, %s)" % (source, width, height, fmt),
+           "#pragma once", "", "#include <M5Siv3D.h>", ""]
+    if fmt == "rgb565":
+        pixels = [c for row in rows for c in row]
+        out.append(format_array("uint16_t", name + "_pixels", pixels, 12, 4))
+        out.append("M5SIV3D_INLINE_CONSTEXPR ImageData %s = ImageData::RGB565(%d, %d, %s_pixels);"
+                   % (name, width, height, name))
+    elif fmt == "indexed":
+        palette = sorted(set(c for row in rows for c in row))
+        lookup = {c: i for i, c in enumerate(palette)}
+        indices = [lookup[c] for row in rows for c in row]
+        out.append(format_array("uint16_t", name + "_palette", palette, 12, 4))
+        out.append(format_array("uint8_t", name + "_indices", indices, 24, 2))
+        out.append("M5SIV3D_INLINE_CONSTEXPR ImageData %s = ImageData::Indexed8(%d, %d, %s_indices, %s_palette);"
+                   % (name, width, height, name, name))
+    else:
+        runs, offsets = encode_rle(rows)
+        out.append(format_array("uint16_t", name + "_runs", runs, 12, 4))
+        out.append(format_array("uint32_t", name + "_rows", offsets, 12, 0))
+        out.append("M5SIV3D_INLINE_CONSTEXPR ImageData %s = ImageData::RLE(%d, %d, %s_runs, %s_rows);"
+                   % (name, width, height, name, name))
+    return "\n".join(out) + "\n"
+
+
+def pack(sizes, max_width):
+    """Shelf packing; returns ([(x, y)], height) like TextureAtlas::Pack."""
+    positions = [None] * len(sizes)
+    x = y = shelf_height = 0
+    for index in sorted(range(len(sizes)), key=lambda i: -sizes[i][1]):
+        w, h = sizes[index]
+        if w > max_width:
+            raise ValueError("image %d is %d pixels wide, more than --max-width %d" % (index, w, max_width))
+        if x + w > max_width:
+            y += shelf_height
+            x = shelf_height = 0
+        positions[index] = (x, y)
+        x += w
+        shelf_height = max(shelf_height, h)
+    return positions, y + shelf_height
+
+
+def identifier(path):
+    name = re.sub(r"\W", "_", os.path.splitext(os.path.basename(path))[0])
+    return "_" + name if name[0].isdigit() else name
+
+
+def parse_color(text):
+    text = text.lstrip("#")
+    if not re.fullmatch(r"[0-9a-fA-F]{6}", text):
+        raise argparse.ArgumentTypeError("expected RRGGBB")
+    return tuple(int(text[i:i + 2], 16) for i in (0, 2, 4))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("inputs", nargs="+", help="PNG image(s); several images need --atlas")
+    parser.add_argument("-o", "--output", help="header to write (default: stdout)")
+    parser.add_argument("-n", "--name", help="C++ identifier (default: derived from the file name)")
+    parser.add_argument("-f", "--format", choices=["auto", "rgb565", "indexed", "rle"], default="auto",
+                        help="pixel layout (default: auto, the smallest)")
+    parser.add_argument("--background", type=parse_color, default=(0, 0, 0),
+                        help="colour behind transparent pixels as RRGGBB (default: 000000)")
+    parser.add_argument("--atlas", action="store_true", help="pack all inputs into one sheet with a region table")
+    parser.add_argument("--max-width", type=int, default=256, help="sheet width limit for --atlas (default: 256)")
+    args = parser.parse_args()
+
+    if len(args.inputs) > 1 and not args.atlas:
+        parser.error("several inputs need --atlas")
+
+    images = []
+    for path in args.inputs:
+        with open(path, "rb") as f:
+            try:
+                images.append(read_png(f.read()))
+            except PngError as e:
+                print("%s: %s" % (path, e), file=sys.stderr)
+                return 1
+
+    regions = None
+    if args.atlas:
+        try:
+            positions, height = pack([(w, h) for w, h, _ in images], args.max_width)
+        except ValueError as e:
+            print(e, file=sys.stderr)
+            return 1
+        width = max(x + w for (x, _), (w, _, _) in zip(positions, images))
+        sheet = [[(args.background[0], args.background[1], args.background[2], 255)] * width for _ in range(height)]
+        for (x, y), (w, h, rgba) in zip(positions, images):
+            for row in range(h):
+                sheet[y + row][x:x + w] = rgba[row]
+        regions = [(identifier(path), x, y, w, h) for path, (x, y), (w, h, _) in zip(args.inputs, positions, images)]
+        rgba = sheet
+        source = ", ".join(os.path.basename(path) for path in args.inputs)
+    else:
+        width, height, rgba = images[0]
+        source = os.path.basename(args.inputs[0])
+    rows = [[to_rgb565(p, args.background) for p in row] for row in rgba]
+
+    name = args.name or ("atlas" if args.atlas and len(args.inputs) > 1 else identifier(args.inputs[0]))
+
+    candidates = sizes(rows, width, height)
+    fmt = args.format
+    if fmt == "auto":
+        fmt = min((size, key) for key, size in candidates.items() if size is not None)[1]
+    elif candidates[fmt] is None:
+        print("more than 256 colours, cannot use --format indexed", file=sys.stderr)
+        return 1
+
+    header = generate(name, source, width, height, rows, fmt)
+    if regions:
+        header += "\n"
+        for region_name, x, y, w, h in regions:
+            header += "M5SIV3D_INLINE_CONSTEXPR ImageRegion %s_%s(%d, %d, %d, %d);\n" % (name, region_name, x, y, w, h)
+        header += "M5SIV3D_INLINE_CONSTEXPR ImageRegion %s_regions[] = {\n" % name
+        header += "".join("    %s_%s,\n" % (name, region[0]) for region in regions)
+        header += "};\nM5SIV3D_INLINE_CONSTEXPR size_t %s_count = %d;\n" % (name, len(regions))
+
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(header)
+    else:
+        sys.stdout.write(header)
+    print("%s: %dx%d, %s, %d bytes of flash" % (source, width, height, fmt, candidates[fmt]), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""Convert an M5Siv3D binary trace dump into Chrome trace JSON.
+
+Capture the serial output of TraceBuffer::Dump() to a file, e.g.
+
+    pio device monitor --raw -b 115200 > trace.bin
+    python3 tools/trace_to_chrome.py trace.bin -o trace.json
+
+then open trace.json in chrome://tracing or https://ui.perfetto.dev.
+
+Text printed around the dump is ignored. If the capture contains several
+dumps, all of them are converted (later dumps usually overlap earlier ones,
+so duplicate events are dropped).
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = b"M5TR"
+SUPPORTED_VERSION = 1
+UNKNOWN_NAME = 0xFFFF
+
+
+class TraceFormatError(Exception):
+    pass
+
+
+def parse_dump(data, offset):
+    """Parse one dump starting at offset. Returns (events, end_offset)."""
+    if data[offset:offset + 4] != MAGIC:
+        raise TraceFormatError("missing magic at offset %d" % offset)
+    if offset + 8 > len(data):
+        raise TraceFormatError("truncated header")
+    version, _, name_count = struct.unpack_from("<BBH", data, offset + 4)
+    if version != SUPPORTED_VERSION:
+        raise TraceFormatError("unsupported trace version %d" % version)
+    pos = offset + 8
+
+    names = []
+    for _ in range(name_count):
+        if pos >= len(data):
+            raise TraceFormatError("truncated name table")
+        length = data[pos]
+        pos += 1
+        names.append(data[pos:pos + length].decode("utf-8", errors="replace"))
+        pos += length
+
+    if pos + 4 > len(data):
+        raise TraceFormatError("truncated event count")
+    (event_count,) = struct.unpack_from("<I", data, pos)
+    pos += 4
+    if pos + event_count * 12 > len(data):
+        raise TraceFormatError("truncated event list")
+
+    events = []
+    high = 0
+    previous_end = None
+    for _ in range(event_count):
+        name_index, core, _, begin, duration = struct.unpack_from("<HBBII", data, pos)
+        pos += 12
+
+        # micros() wraps every ~71 minutes; events are recorded in end-time order
+        end = (begin + duration) & 0xFFFFFFFF
+        if previous_end is not None and end + 0x80000000 < previous_end:
+            high += 1 << 32
+        previous_end = end
+        name = names[name_index] if name_index != UNKNOWN_NAME and name_index < len(names) else "?"
+        events.append((name, core, high + end - duration, duration))
+    return events, pos
+
+
+def find_dumps(data):
+    events = []
+    seen = set()
+    offset = data.find(MAGIC)
+    while offset >= 0:
+        try:
+            dump_events, end = parse_dump(data, offset)
+        except TraceFormatError as error:
+            print("skipping dump at offset %d: %s" % (offset, error), file=sys.stderr)
+            offset = data.find(MAGIC, offset + 1)
+            continue
+        for event in dump_events:
+            if event not in seen:
+                seen.add(event)
+                events.append(event)
+        offset = data.find(MAGIC, end)
+    return events
+
+
+def to_chrome_trace(events):
+    return {
+        "displayTimeUnit": "ms",
+        "traceEvents": [
+            {
+                "name": name,
+                "ph": "X",
+                "ts": begin,
+                "dur": duration,
+                "pid": 0,
+                "tid": core,
+            }
+            for name, core, begin, duration in sorted(events, key=lambda e: (e[2], -e[3]))
+        ],
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", help="captured serial output containing TraceBuffer::Dump() data")
+    parser.add_argument("-o", "--output", help="output JSON file (default: stdout)")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+
+    events = find_dumps(data)
+    if not events:
+        print("no trace dump found in %s" % args.input, file=sys.stderr)
+        return 1
+
+    trace = to_chrome_trace(events)
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+        sys.stdout.write("\n")
+    print("%d events" % len(events), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())